@@ -36,10 +36,12 @@ public:
     add(name);
     add(description);
     add(command);
+    add(icon_path);
   }
 
   Gtk::TreeModelColumn<Glib::RefPtr<Gdk::Pixbuf>> icon;
   Gtk::TreeModelColumn<Glib::ustring> name;
   Gtk::TreeModelColumn<Glib::ustring> description;
   Gtk::TreeModelColumn<std::string> command;
+  Gtk::TreeModelColumn<std::string> icon_path; /*!< Icon file of the row, used to set the icon once it's decoded */
 };
@@ -27,4 +27,17 @@ struct ApplicationData
   std::string name;
   std::string description;
   std::string command;
-};
\ No newline at end of file
+};
+
+/**
+ * \struct ApplicationListItem
+ * \brief Row of the application list
+ */
+struct ApplicationListItem
+{
+  std::string name;
+  std::string description;
+  std::string command;
+  std::string icon;       /*!< Icon name or full path to the icon */
+  bool is_icon_full_path; /*!< Icon is a full path (instead of only the icon name) */
+};
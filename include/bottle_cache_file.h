@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_cache_file.h
+ * \brief   Persistent cache of the bottle details read from the bottle registry files
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "bottle_scan_struct.h"
+#include <map>
+#include <string>
+
+struct BottleCacheData
+{
+  std::string fingerprint; /*!< Fingerprint of the bottle files at the moment the bottle was scanned */
+  BottleScanData bottle;   /*!< Cached bottle details (config and app list are not cached) */
+};
+
+/**
+ * \class BottleCacheFile
+ * \brief Bottle cache file helper methods, the cache is stored in the WineGUI user cache directory
+ */
+class BottleCacheFile
+{
+public:
+  // Singleton
+  static BottleCacheFile& get_instance();
+
+  static bool write_cache_file(const std::map<std::string, BottleCacheData>& bottles);
+  static std::map<std::string, BottleCacheData> read_cache_file();
+
+private:
+  BottleCacheFile();
+  ~BottleCacheFile();
+  BottleCacheFile(const BottleCacheFile&) = delete;
+  BottleCacheFile& operator=(const BottleCacheFile&) = delete;
+
+  static std::string get_cache_file_path();
+};
@@ -34,6 +34,7 @@ struct CloneBottleStruct
   Glib::ustring name;
   Glib::ustring folder_name;
   Glib::ustring description;
+  bool is_overlay; /*!< Share the files with the original machine (copy-on-write), instead of a full copy */
 };
 
 /**
@@ -45,6 +46,7 @@ class BottleCloneWindow : public Gtk::Window
 public:
   // Signals
   sigc::signal<void, CloneBottleStruct&> clone_bottle; /*!< clone button clicked signal */
+  sigc::signal<void> cancel_clone;                     /*!< cancel clone (in busy dialog) clicked signal */
 
   explicit BottleCloneWindow(Gtk::Window& parent);
   virtual ~BottleCloneWindow();
@@ -52,9 +54,11 @@ public:
   void show();
   void set_active_bottle(BottleItem* bottle);
   void reset_active_bottle();
+  void set_clone_progress(double fraction);
 
   // Signal handlers
   virtual Glib::ustring on_bottle_cloned();
+  virtual void on_clone_cancelled();
 
 protected:
   // Child widgets
@@ -70,6 +74,7 @@ protected:
   Gtk::Entry folder_name_entry;                    /*!< folder name input field */
   Gtk::ScrolledWindow description_scrolled_window; /*!< description scrolled window */
   Gtk::TextView description_text_view;             /*!< description text view */
+  Gtk::CheckButton share_files_check;              /*!< share files (overlay) checkbox */
   Gtk::Button clone_button;                        /*!< clone button */
   Gtk::Button cancel_button;                       /*!< cancel button */
   // Busy dialog
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_cloner.h
+ * \brief   Native Wine bottle copy using reflinks or copy_file_range()
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <stop_token>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * \class BottleCloner
+ * \brief Copies a Wine bottle directory tree without spawning external processes.
+ *
+ * Regular files are first cloned with a reflink (FICLONE), which shares the data blocks on btrfs/XFS.
+ * When the file system doesn't support reflinks, the file data is copied in-kernel using copy_file_range().
+ * Files are copied by a small pool of worker threads. Symbolic links (like dosdevices/c:) are recreated
+ * with the same (relative) target, instead of copying the target they point to.
+ */
+class BottleCloner
+{
+public:
+  using ProgressCallback = std::function<void(std::uint64_t bytes_copied, std::uint64_t bytes_total)>;
+
+  static bool clone(const std::string& source_path,
+                    const std::string& destination_path,
+                    const ProgressCallback& progress = {},
+                    std::stop_token stop_token = {});
+
+private:
+  /**
+   * \struct FileEntry
+   * \brief Regular file to copy
+   */
+  struct FileEntry
+  {
+    std::string source;      /*!< Full source file path */
+    std::string destination; /*!< Full destination file path */
+    mode_t mode;             /*!< Permission bits of the source file */
+    std::uint64_t size;      /*!< File size in bytes */
+  };
+
+  static void copy_tree(const std::string& source_dir,
+                        const std::string& destination_dir,
+                        std::vector<FileEntry>& files,
+                        std::uint64_t& bytes_total,
+                        std::stop_token stop_token);
+  static void copy_file(const FileEntry& file, std::atomic<std::uint64_t>& bytes_copied, std::stop_token stop_token);
+  static int copy_data(int source_fd, int destination_fd, std::atomic<std::uint64_t>& bytes_copied, std::stop_token stop_token);
+  static void remove_tree(const std::string& path);
+};
@@ -33,6 +33,7 @@ struct BottleConfigData
   bool logging_enabled;
   int debug_log_level;
   std::vector<std::pair<std::string, std::string>> env_vars;
+  std::string runner; /*!< Pinned Wine runner name (empty: use the Wine found in PATH) */
 };
 
 /**
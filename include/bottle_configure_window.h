@@ -60,11 +60,12 @@ protected:
   Gtk::Toolbar third_toolbar;  /*!< 3rd row toolbar */
   Gtk::Toolbar fourth_toolbar; /*!< 4td row toolbar */
 
-  Gtk::Label first_row_label;  /*!< 1st row label */
-  Gtk::Label hint_label;       /*!< Extra hint label info for user */
-  Gtk::Label second_row_label; /*!< 2nd row label */
-  Gtk::Label third_row_label;  /*!< 3rd row label */
-  Gtk::Label fourth_row_label; /*!< 4th row label */
+  Gtk::Label first_row_label;       /*!< 1st row label */
+  Gtk::Label hint_label;            /*!< Extra hint label info for user */
+  Gtk::Label second_row_label;      /*!< 2nd row label */
+  Gtk::Label third_row_label;       /*!< 3rd row label */
+  Gtk::Label fourth_row_label;      /*!< 4th row label */
+  Gtk::Label installed_verbs_label; /*!< All the verbs installed with Winetricks */
 
   // Buttons First row
   Gtk::ToolButton install_d3dx9_button; /*!< d3dx9 install button */
@@ -87,18 +88,32 @@ protected:
   Gtk::ToolButton install_dotnet6_button;     /*!< .NET v6.0 install button */
 
 private:
+  /**
+   * \struct InstalledPackages
+   * \brief Packages that are detected as installed in the bottle
+   */
+  struct InstalledPackages
+  {
+    bool d3dx9;                           /*!< DirectX v9 (OpenGL) */
+    bool dxvk;                            /*!< DirectX v9/v10/v11 (Vulkan) */
+    bool vkd3d;                           /*!< DirectX v12 (Vulkan) */
+    bool liberation_fonts;                /*!< Liberation fonts */
+    bool core_fonts;                      /*!< MS Core fonts */
+    bool visual_cpp_2013;                 /*!< MS Visual C++ 2013 Redistributable */
+    bool visual_cpp_2015;                 /*!< MS Visual C++ 2015 Redistributable */
+    bool visual_cpp_2017;                 /*!< MS Visual C++ 2017 Redistributable */
+    bool visual_cpp_2019;                 /*!< MS Visual C++ 2019 Redistributable */
+    bool visual_cpp_2022;                 /*!< MS Visual C++ 2022 Redistributable */
+    bool dotnet4_0;                       /*!< .NET v4.0 */
+    bool dotnet4_5_2;                     /*!< .NET v4.5.2 */
+    bool dotnet4_7_2;                     /*!< .NET v4.7.2 */
+    bool dotnet4_8;                       /*!< .NET v4.8 */
+    bool dotnet6;                         /*!< .NET v6.0 LTS */
+    std::vector<string> winetricks_verbs; /*!< All the verbs installed with Winetricks (empty if unknown) */
+  };
+
   BottleItem* active_bottle_; /*!< Current active bottle */
 
-  bool is_d3dx9_installed();
-  bool is_dxvk_installed();
-  bool is_vkd3d_installed();
-  bool is_liberation_installed();
-  bool is_core_fonts_installed();
-  bool is_visual_cpp_2013_installed();
-  bool is_visual_cpp_2015_installed();
-  bool is_visual_cpp_2017_installed();
-  bool is_visual_cpp_2019_installed();
-  bool is_visual_cpp_2022_installed();
-  bool is_dotnet_installed(const string& uninstaller_key, const string& uninstaller_name);
-  bool is_dotnet_6_installed();
+  InstalledPackages get_installed_packages();
+  InstalledPackages get_installed_packages_from_registry();
 };
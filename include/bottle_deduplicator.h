@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_deduplicator.h
+ * \brief   Find identical files across Wine bottles and share their data blocks
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <stop_token>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * \struct DuplicateGroup
+ * \brief Files with identical contents (on the same file system)
+ */
+struct DuplicateGroup
+{
+  std::uint64_t size;             /*!< File size in bytes */
+  std::vector<std::string> paths; /*!< Full paths, one per inode (hardlinks are already shared) */
+};
+
+/**
+ * \struct DeduplicationReport
+ * \brief Result of the (dry-run) duplicate scan
+ */
+struct DeduplicationReport
+{
+  std::vector<DuplicateGroup> groups;  /*!< Groups of identical files */
+  std::uint64_t files_scanned = 0;     /*!< Number of files considered */
+  std::uint64_t bytes_scanned = 0;     /*!< Total size of the files considered */
+  std::uint64_t files_duplicate = 0;   /*!< Number of files that could share the data of another file (not yet sharing it) */
+  std::uint64_t bytes_reclaimable = 0; /*!< Disk space that could be freed (data blocks already shared are not counted) */
+};
+
+/**
+ * \struct DeduplicationResult
+ * \brief Result of the actual deduplication
+ */
+struct DeduplicationResult
+{
+  std::uint64_t files_deduplicated = 0;    /*!< Number of files now sharing their data */
+  std::uint64_t bytes_deduplicated = 0;    /*!< Bytes now shared, which were not shared before */
+  bool is_supported = true;                /*!< False if the file system doesn't support sharing data blocks */
+  std::vector<std::string> error_messages; /*!< Files that could not be deduplicated */
+};
+
+/**
+ * \class BottleDeduplicator
+ * \brief Finds identical files across Wine bottles (like system32 DLLs, fonts and redistributables),
+ * and lets them share the same data blocks using the FIDEDUPERANGE ioctl (btrfs/XFS).
+ *
+ * Files are grouped by size first, only the files with an equally sized counterpart are hashed (in parallel).
+ * The kernel compares the contents again before sharing the data, and each file stays a separate copy-on-write file:
+ * Wine can still change the file in one bottle, without affecting the other bottles.
+ */
+class BottleDeduplicator
+{
+public:
+  static DeduplicationReport scan(const std::vector<std::string>& prefix_paths, std::stop_token stop_token = {});
+  static DeduplicationResult deduplicate(const DeduplicationReport& report, std::stop_token stop_token = {});
+
+private:
+  /**
+   * \struct FileEntry
+   * \brief Regular file found in a bottle
+   */
+  struct FileEntry
+  {
+    std::string path;     /*!< Full file path */
+    dev_t device;         /*!< Device of the file system */
+    ino_t inode;          /*!< Inode number */
+    std::uint64_t size;   /*!< File size in bytes */
+    std::string checksum; /*!< Checksum of the contents (only for duplicate candidates) */
+  };
+
+  /**
+   * \struct Extent
+   * \brief Mapping of a file range to the data blocks on disk (see FIEMAP)
+   */
+  struct Extent
+  {
+    std::uint64_t logical;  /*!< Offset in the file */
+    std::uint64_t physical; /*!< Offset on disk */
+    std::uint64_t length;   /*!< Length in bytes */
+  };
+
+  static void collect_files(const std::string& dir_path, dev_t device, std::vector<FileEntry>& files, std::stop_token stop_token);
+  static void compute_checksums(std::vector<FileEntry*>& files, std::stop_token stop_token);
+  static std::string compute_checksum(const std::string& path, std::stop_token stop_token);
+  static int deduplicate_file(int source_fd, int destination_fd, std::uint64_t size, std::uint64_t& bytes_deduplicated);
+  static bool get_extents(int fd, std::uint64_t size, std::vector<Extent>& extents);
+  static bool get_extents(const std::string& path, std::uint64_t size, std::vector<Extent>& extents);
+  static std::uint64_t get_shared_bytes(const std::vector<Extent>& source_extents, const std::vector<Extent>& destination_extents);
+};
@@ -61,6 +61,7 @@ public:
     swap(a.win_, b.win_);
     swap(a.bit_, b.bit_);
     swap(a.wine_version_, b.wine_version_);
+    swap(a.runner_, b.runner_);
     swap(a.is_wine64_bit_, b.is_wine64_bit_);
     swap(a.wine_c_drive_, b.wine_c_drive_);
     swap(a.wine_last_changed_, b.wine_last_changed_);
@@ -103,6 +104,8 @@ public:
    */
   ~BottleItem(){};
 
+  void update_ui();
+
   /*
    *  Getters & setters
    */
@@ -176,6 +179,16 @@ public:
   {
     return wine_version_;
   };
+  /// set Wine runner name (empty: the Wine found in PATH)
+  void runner(const std::string& runner)
+  {
+    runner_ = runner;
+  };
+  /// get Wine runner name
+  const std::string& runner() const
+  {
+    return runner_;
+  };
   /// set is Wine 64-bit executable
   void is_wine64_bit(bool is_wine64_bit)
   {
@@ -294,6 +307,7 @@ private:
   BottleTypes::Windows win_;
   BottleTypes::Bit bit_;
   Glib::ustring wine_version_;
+  std::string runner_;
   bool is_wine64_bit_;
   Glib::ustring wine_location_;
   Glib::ustring wine_c_drive_;
@@ -20,15 +20,21 @@
  */
 #pragma once
 
+#include <functional>
 #include <gtkmm.h>
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
+#include <stop_token>
 #include <string>
 #include <thread>
 
+#include "bottle_deduplicator.h"
+#include "bottle_scan_struct.h"
 #include "bottle_types.h"
 #include "general_config_struct.h"
+#include "task_executor.h"
 
 using std::string;
 
@@ -54,6 +60,7 @@ public:
 
   void prepare();
   void update_config_and_bottles(const Glib::ustring& select_bottle_name, bool is_startup);
+  void refresh_active_bottle();
   void new_bottle(SignalController* caller,
                   const Glib::ustring& name,
                   BottleTypes::Windows windows_version,
@@ -70,9 +77,15 @@ public:
                      BottleTypes::AudioDriver audio,
                      bool is_debug_logging,
                      int debug_log_level);
-  void clone_bottle(SignalController* caller, const Glib::ustring& name, const Glib::ustring& folder_name, const Glib::ustring& description);
+  void clone_bottle(SignalController* caller,
+                    const Glib::ustring& name,
+                    const Glib::ustring& folder_name,
+                    const Glib::ustring& description,
+                    bool is_overlay,
+                    std::stop_token stop_token);
   void delete_bottle();
   void set_active_bottle(BottleItem* bottle);
+  void set_selected_bottles(const std::vector<BottleItem*>& bottles);
   const Glib::ustring& get_error_message() const;
 
   // Signal handlers
@@ -90,44 +103,151 @@ public:
   void install_dot_net(Gtk::Window& parent, const string& version);
   void install_core_fonts(Gtk::Window& parent);
   void install_liberation(Gtk::Window& parent);
+  void deduplicate_bottles();
+  void cancel_batch();
 
 private:
+  /**
+   * \struct BatchJob
+   * \brief Operation on a single bottle, as part of a batch operation
+   */
+  struct BatchJob
+  {
+    Glib::ustring folder_name;               /*!< Folder name of the bottle, used in the results */
+    std::function<int(std::stop_token)> run; /*!< Run the operation, returns the exit code */
+  };
+
+  /**
+   * \struct RefreshedBottle
+   * \brief Result of rescanning a single bottle in the background
+   */
+  struct RefreshedBottle
+  {
+    BottleScanData data;               /*!< Scanned bottle, incl. the fingerprint */
+    bool is_runner_changed = false;    /*!< The runner differs from the runner shown in the GUI */
+    string wine_version;               /*!< Wine version of the new runner (only if the runner changed) */
+    string wine_version_error_message; /*!< Error during reading the Wine version of the new runner */
+  };
+
   // Synchronizes access to data members using mutexes
   mutable std::mutex error_message_mutex_;
-  mutable std::mutex output_loging_mutex_;
   mutable std::mutex error_message_winetricks_mutex_;
+  mutable std::mutex scan_result_mutex_;
+  mutable std::mutex deduplicate_mutex_;
+  mutable std::mutex remove_progress_mutex_;
+  mutable std::mutex batch_mutex_;
+  mutable std::mutex refreshed_bottles_mutex_;
+  mutable std::mutex task_error_messages_mutex_;
   std::unique_ptr<std::thread> thread_install_update_winetricks_; /*!< Thread for installing/updating winetricks binary */
+  std::unique_ptr<std::thread> thread_scan_bottles_;              /*!< Thread for scanning the bottles during start-up */
+  TaskExecutor task_executor_;                                    /*!< Runs the package installs and maintenance tasks in the background */
+  TaskExecutor batch_executor_;                                   /*!< Runs the jobs of the batch operations in the background */
   Glib::Dispatcher update_bottles_dispatcher_;                    /*!< Dispatcher if the bottle list needs to be updated, from thread */
-  Glib::Dispatcher write_log_dispatcher_;                         /*!< Dispatcher if we can write the output logging to disk */
   Glib::Dispatcher error_message_winetricks_dispatcher_; /*!< Dispatcher when there is an error message during winetricks install/update thread */
   Glib::Dispatcher winetricks_finished_dispatcher_;      /*!< Dispatcher when the Winetricks install is completed */
+  Glib::Dispatcher scan_bottles_finished_dispatcher_;    /*!< Dispatcher when the bottle scan thread is completed */
+  Glib::Dispatcher deduplicate_scan_dispatcher_;         /*!< Dispatcher when the duplicate files scan is completed */
+  Glib::Dispatcher deduplicate_finished_dispatcher_;     /*!< Dispatcher when the deduplication is completed */
+  Glib::Dispatcher remove_progress_dispatcher_;          /*!< Dispatcher when the progress of a bottle removal changed */
+  Glib::Dispatcher batch_progress_dispatcher_;           /*!< Dispatcher when a bottle of the batch operation is finished */
+  Glib::Dispatcher batch_finished_dispatcher_;           /*!< Dispatcher when all the bottles of the batch operation are finished */
+  Glib::Dispatcher refresh_bottle_dispatcher_;           /*!< Dispatcher when a changed bottle is rescanned */
+  Glib::Dispatcher task_error_dispatcher_;               /*!< Dispatcher when a background task failed */
+
+  Glib::RefPtr<Gio::FileMonitor> bottle_location_monitor_;            /*!< Watches the bottle location for added/removed bottles */
+  std::map<string, Glib::RefPtr<Gio::FileMonitor>> bottle_monitors_; /*!< Watches the files of each bottle (key: prefix path) */
+  std::map<string, string> bottle_fingerprints_;                     /*!< Fingerprint of each bottle shown in the GUI (key: prefix path) */
+  std::set<string> changed_bottles_;                                 /*!< Prefix paths of the bottles changed on disk, not yet refreshed */
+  sigc::connection bottle_list_changed_timeout_;                     /*!< Delayed refresh of the whole bottle list */
+  sigc::connection bottles_changed_timeout_;                         /*!< Delayed refresh of the changed bottles */
+  string monitored_bottle_location_;
 
   MainWindow& main_window_;
   string bottle_location_;
   std::list<BottleItem> bottles_;
   BottleItem* active_bottle_;
+  std::vector<BottleItem*> selected_bottles_; /*!< All selected bottles in the GUI, the batch operations run on them */
   bool is_display_default_wine_machine_;
   bool is_wine64_bit_;
   bool is_logging_stderr_;
+  std::vector<string> runner_directories_; /*!< Custom directories with Wine runners (from the general config) */
+  int batch_parallelism_;                  /*!< Maximum number of bottles handled at the same time during a batch operation */
   int previous_active_bottle_index_;
   std::size_t previous_bottles_list_size_;
+  std::size_t bottles_update_counter_;      /*!< Incremented each time the bottle list is set, used to detect outdated scan results */
+  std::size_t scan_bottles_update_counter_; /*!< Bottle list update counter at the moment the scan thread was started */
 
   //// error_message is used by both the GUI thread and NewBottle thread (used a 'temp' location)
   Glib::ustring error_message_;
   Glib::ustring error_message_winetricks_;
-  std::string logging_bottle_prefix_;
-  std::string output_logging_;
+  BottleListScanData scan_result_;                 /*!< Result of the bottle scan thread */
+  bool is_deduplicating_;                          /*!< A duplicate files scan or deduplication is running */
+  DeduplicationReport deduplicate_report_;         /*!< Result of the duplicate files scan */
+  DeduplicationResult deduplicate_result_;         /*!< Result of the deduplication */
+  std::map<string, double> remove_progress_;       /*!< Progress of the bottles being removed in the background (key: trash path) */
+  bool is_batch_running_;                          /*!< A batch operation is running */
+  std::stop_source batch_stop_source_;             /*!< Cancels the remaining bottles of the batch operation */
+  Glib::ustring batch_heading_;                    /*!< Heading of the running batch operation */
+  std::function<void()> batch_finished_;           /*!< Called (in the GUI thread) when the batch operation is finished */
+  std::size_t batch_total_;                        /*!< Number of bottles in the batch operation */
+  std::size_t batch_done_;                         /*!< Number of bottles finished */
+  std::vector<Glib::ustring> batch_errors_;        /*!< Bottles that failed during the batch operation (incl. the reason) */
+  std::vector<RefreshedBottle> refreshed_bottles_; /*!< Rescanned bottles, not yet applied to the GUI */
+  std::vector<Glib::ustring> task_error_messages_; /*!< Errors of the failed background tasks, not yet shown */
 
   // Signal handlers
-  virtual void write_log_to_file();
   virtual void on_error_winetricks();
   virtual void cleanup_install_update_winetricks_thread();
+  virtual void on_scan_bottles_finished();
+  virtual void on_deduplicate_scan_finished();
+  virtual void on_deduplicate_finished();
+  virtual void on_remove_progress();
+  virtual void on_batch_progress();
+  virtual void on_batch_finished();
+  virtual void on_refresh_bottle_finished();
+  virtual void on_task_error();
+  virtual void on_bottle_location_changed(const Glib::RefPtr<Gio::File>& file,
+                                          const Glib::RefPtr<Gio::File>& other_file,
+                                          Gio::FileMonitorEvent event_type);
+  virtual void on_bottle_changed(const Glib::RefPtr<Gio::File>& file,
+                                 const Glib::RefPtr<Gio::File>& other_file,
+                                 Gio::FileMonitorEvent event_type,
+                                 const string& prefix_path);
+  virtual bool on_bottle_list_changed_timeout();
+  virtual bool on_bottles_changed_timeout();
+  virtual void on_program_exited(GPid pid, int status);
 
   void install_or_update_winetricks_thread(bool install);
+  void scan_bottles_thread();
+  void cleanup_scan_bottles_thread();
   GeneralConfigData load_and_save_general_config();
+  void set_bottles(BottleListScanData& scan_result, const Glib::ustring& select_bottle_name, bool is_startup);
+  void watch_bottles();
+  void refresh_bottle(BottleItem& bottle);
+  void remove_trash(const string& trash_path);
+  void delete_selected_bottles();
+  void launch_program(const std::function<pid_t()>& spawn);
+  void report_task_error(const Glib::ustring& message);
+  void install_package(Gtk::Window& parent, const Glib::ustring& message, const std::vector<string>& program, bool is_deinstall_mono);
+  std::vector<BatchJob> create_batch_jobs(const std::vector<string>& program, bool is_under_wine, bool is_deinstall_mono);
+  void run_batch(Gtk::Window& parent,
+                 const Glib::ustring& heading,
+                 const Glib::ustring& message,
+                 std::vector<BatchJob> jobs,
+                 std::function<void()> finished = {});
+  bool is_batch_selection() const;
   bool is_bottle_not_null();
-  string get_deinstall_mono_command();
-  string get_wine_version();
-  std::vector<string> get_bottle_paths();
-  std::list<BottleItem> create_wine_bottles(const std::vector<string>& bottle_dirs);
+  bool is_template_not_in_use(const std::vector<BottleItem*>& bottles);
+  string get_wine_executable() const;
+  string get_wine_executable(const BottleItem& bottle) const;
+  std::vector<std::pair<string, string>> get_winetricks_env_vars(const BottleItem& bottle) const;
+  std::vector<string> get_deinstall_mono_command(const BottleItem& bottle);
+  static std::vector<string> get_bottle_paths(const string& bottle_location, bool is_display_default_wine_machine);
+  static BottleListScanData scan_bottles(const string& bottle_location,
+                                         bool is_display_default_wine_machine,
+                                         bool is_wine64_bit,
+                                         const std::vector<string>& runner_directories);
+  static BottleScanData scan_wine_bottle(const string& prefix);
+  static std::vector<BottleScanData> scan_wine_bottles(const std::vector<string>& bottle_dirs);
+  std::list<BottleItem> create_wine_bottles(BottleListScanData& scan_result);
 };
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_remover.h
+ * \brief   Crash-safe background removal of Wine bottles
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * \class BottleRemover
+ * \brief Removes Wine bottles in two steps: the bottle folder is first renamed to a trash name (instant and atomic),
+ * so it is gone from the bottle list at once. Afterwards the trash folder is removed in the background,
+ * by multiple threads unlinking the files of different directories in parallel.
+ *
+ * Trash folders left behind (eg. after a crash) are found again by find_trash(), so the removal can be resumed.
+ */
+class BottleRemover
+{
+public:
+  using ProgressCallback = std::function<void(std::uint64_t entries_removed, std::uint64_t entries_total)>;
+
+  static std::string move_to_trash(const std::string& prefix_path);
+  static bool remove(const std::string& path, const ProgressCallback& progress = {}, std::stop_token stop_token = {});
+  static std::vector<std::string> find_trash(const std::string& dir_path);
+  static bool is_trash(std::string_view name);
+
+private:
+  BottleRemover() = delete;
+
+  static void collect_directories(const std::string& dir_path, dev_t device, std::vector<std::string>& directories, std::uint64_t& entries_total);
+  static std::string remove_files(const std::string& dir_path, std::atomic<std::uint64_t>& entries_removed);
+};
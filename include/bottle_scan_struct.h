@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_scan_struct.h
+ * \brief   Bottle scan result struct (plain data, can be filled outside the GUI thread)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "app_list_struct.h"
+#include "bottle_config_file.h"
+#include "bottle_types.h"
+#include "wine_defaults.h"
+#include <map>
+#include <string>
+#include <vector>
+
+struct BottleScanData
+{
+  std::string prefix;
+  std::string fingerprint; /*!< Fingerprint of the bottle files at the moment of the scan */
+  std::string folder_name;
+  std::string c_drive_location = "- Unknown -";
+  std::string last_time_wine_updated = "- Unknown -";
+  std::string virtual_desktop;
+  BottleTypes::Bit bit = BottleTypes::Bit::win32;
+  BottleTypes::AudioDriver audio_driver = BottleTypes::AudioDriver::pulseaudio;
+  BottleTypes::Windows windows = WineDefaults::WindowsOs;
+  bool status = false;
+  BottleConfigData config;
+  std::map<int, ApplicationData> app_list;
+  std::vector<std::string> error_messages; /*!< Errors during the scan, shown to the user afterwards */
+};
+
+struct BottleListScanData
+{
+  std::string wine_version;
+  std::vector<BottleScanData> bottles;
+  std::vector<std::string> error_messages; /*!< General errors during the scan, shown to the user afterwards */
+  bool is_aborted = false;                 /*!< True when the bottle directories could not be read at all */
+};
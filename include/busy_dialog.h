@@ -31,6 +31,9 @@ using std::string;
 class BusyDialog : public Gtk::Dialog
 {
 public:
+  // Signals
+  sigc::signal<void> cancel; /*!< Cancel button clicked signal (only when cancellable) */
+
   explicit BusyDialog(Gtk::Window& parent);
   virtual ~BusyDialog();
 
@@ -38,6 +41,8 @@ public:
   void close();
 
   void set_message(const Glib::ustring& heading_text, const Glib::ustring& message);
+  void set_progress(double fraction);
+  void set_cancellable(bool cancellable);
 
 protected:
   Gtk::Label heading_label;     /*!< Heading label */
@@ -47,6 +52,8 @@ protected:
 private:
   sigc::connection timer_; /*!< Timer connection */
   Gtk::Window& default_parent_;
+  Gtk::Button* cancel_button_; /*!< Cancel button, hidden unless cancellable */
 
   virtual bool pulsing();
+  void on_response(int response_id) override;
 };
@@ -21,10 +21,13 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 struct GeneralConfigData
 {
   std::string default_folder;
   bool display_default_wine_machine;
   bool enable_logging_stderr;
+  int batch_parallelism;                       /*!< Maximum number of machines handled at the same time during a batch operation */
+  std::vector<std::string> runner_directories; /*!< Custom directories with Wine runners (or a runner itself) */
 };
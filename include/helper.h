@@ -20,19 +20,28 @@
  */
 #pragma once
 
+#include <chrono>
 #include <glibmm/dispatcher.h>
+#include <stop_token>
 #include <string>
+#include <string_view>
+#include <sys/types.h>
 #include <utility>
 #include <vector>
 
+#include "bottle_cloner.h"
 #include "bottle_types.h"
 #include "dll_override_types.h"
+#include "installed_program_struct.h"
 
 using std::endl;
 using std::pair;
 using std::string;
 using std::vector;
 
+// Forward declaration
+class WineRegistryWriter;
+
 /**
  * \class Helper
  * \brief Provide some helper methods for Bottle Manager and CLI
@@ -47,33 +56,57 @@ public:
   static Helper& get_instance();
 
   static vector<string> get_bottles_paths(const string& dir_path, bool display_default_wine_machine);
-  static string run_program(const string& prefix_path,
-                            int debug_log_level,
-                            const string& program,
-                            const string& working_directory = "",
-                            const vector<pair<string, string>>& env_vars = {},
-                            bool give_error = true,
-                            bool stderr_output = true);
-  static string run_program_under_wine(bool wine_64_bit,
-                                       const string& prefix_path,
-                                       int debug_log_level,
-                                       const string& program,
-                                       const string& working_directory = "",
-                                       const vector<pair<string, string>>& env_vars = {},
-                                       bool give_error = true,
-                                       bool stderr_output = true);
-  static void write_to_log_file(const string& logging_bottle_prefix, const string& logging);
+  static int run_program(const string& prefix_path,
+                         int debug_log_level,
+                         const vector<string>& program,
+                         const string& working_directory = "",
+                         const vector<pair<string, string>>& env_vars = {},
+                         bool give_error = true,
+                         bool stderr_output = true,
+                         bool debug_logging = false,
+                         std::stop_token stop_token = {});
+  static int run_program_under_wine(const string& wine_executable,
+                                    const string& prefix_path,
+                                    int debug_log_level,
+                                    const vector<string>& program,
+                                    const string& working_directory = "",
+                                    const vector<pair<string, string>>& env_vars = {},
+                                    bool give_error = true,
+                                    bool stderr_output = true,
+                                    bool debug_logging = false,
+                                    std::stop_token stop_token = {});
+  static pid_t spawn_program(const string& prefix_path,
+                             int debug_log_level,
+                             const vector<string>& program,
+                             const string& working_directory = "",
+                             const vector<pair<string, string>>& env_vars = {},
+                             bool stderr_output = true,
+                             bool debug_logging = false);
+  static pid_t spawn_program_under_wine(const string& wine_executable,
+                                        const string& prefix_path,
+                                        int debug_log_level,
+                                        const vector<string>& program,
+                                        const string& working_directory = "",
+                                        const vector<pair<string, string>>& env_vars = {},
+                                        bool stderr_output = true,
+                                        bool debug_logging = false);
   static string get_log_file_path(const string& logging_bottle_prefix);
-  static void wait_until_wineserver_is_terminated(const string& prefix_path);
+  static void wait_until_wineserver_is_terminated(const string& prefix_path,
+                                                  std::stop_token stop_token = {},
+                                                  std::chrono::milliseconds timeout = std::chrono::seconds(60));
+  static bool is_wineserver_running(const string& prefix_path);
+  static pid_t get_wineserver_pid(const string& prefix_path);
   static int determine_wine_executable();
   static string get_wine_executable_location(bool bit64);
   static string get_winetricks_location();
-  static string get_wine_version(bool wine_64_bit);
+  static string get_wine_version(const string& wine_executable);
   static string open_file_from_uri(const string& uri);
   static void create_wine_bottle(bool wine_64_bit, const string& prefix_path, BottleTypes::Bit bit, const bool disable_gecko_mono);
-  static void remove_wine_bottle(const string& prefix_path);
   static void rename_wine_bottle_folder(const string& current_prefix_path, const string& new_prefix_path);
-  static void copy_wine_bottle_folder(const string& source_prefix_path, const string& destination_prefix_path);
+  static bool copy_wine_bottle_folder(const string& source_prefix_path,
+                                      const string& destination_prefix_path,
+                                      const BottleCloner::ProgressCallback& progress = {},
+                                      std::stop_token stop_token = {});
   static string get_folder_name(const string& prefix_path);
   static BottleTypes::Windows get_windows_version(const string& prefix_path);
   static BottleTypes::Bit get_windows_bitness(const string& prefix_path);
@@ -81,6 +114,7 @@ public:
   static string get_virtual_desktop(const string& prefix_path);
   static string get_last_wine_updated(const string& prefix_path);
   static bool get_bottle_status(const string& prefix_path);
+  static string get_bottle_fingerprint(const string& prefix_path);
   static std::tuple<string, string> get_menu_program_icon_path_and_comment(const string& shortcut_path);
   static string get_desktop_program_icon_path(const string& prefix_path, const string& shortcut_path);
   static string get_program_icon_from_shortcut_file(const string& prefix_path, const string& shortcut_path);
@@ -90,17 +124,21 @@ public:
   static bool file_exists(const string& filer_path);
   static void install_or_update_winetricks();
   static void self_update_winetricks();
-  static void set_windows_version(const string& prefix_path, BottleTypes::Windows windows);
-  static void set_virtual_desktop(const string& prefix_path, string resolution);
-  static void disable_virtual_desktop(const string& prefix_path);
-  static void set_audio_driver(const string& prefix_path, BottleTypes::AudioDriver audio_driver);
+  static void set_windows_version(WineRegistryWriter& registry, BottleTypes::Windows windows);
+  static void set_virtual_desktop(WineRegistryWriter& registry, string resolution);
+  static void disable_virtual_desktop(WineRegistryWriter& registry);
+  static void set_audio_driver(WineRegistryWriter& registry, BottleTypes::AudioDriver audio_driver);
   static vector<string> get_menu_items(const string& prefix_path);
   static vector<pair<string, string>> get_desktop_items(const string& prefix_path);
   static string log_level_to_winedebug_string(int log_level);
-  static string get_wine_guid(bool wine_64_bit, const string& prefix_path, const string& application_name);
+  static string get_wine_guid(const string& prefix_path, const string& application_name);
+  static vector<InstalledProgramData> get_installed_programs(const string& prefix_path);
   static bool get_dll_override(const string& prefix_path, const string& dll_name, DLLOverride::LoadOrder load_order = DLLOverride::LoadOrder::Native);
+  static vector<string> get_dll_overrides(const string& prefix_path, const vector<string>& dll_names);
   static string get_uninstaller(const string& prefix_path, const string& uninstallerKey);
+  static vector<string> get_uninstallers(const string& prefix_path, const vector<string>& uninstaller_keys);
   static string get_font_filename(const string& prefix_path, BottleTypes::Bit bit, const string& fontName);
+  static vector<string> get_font_filenames(const string& prefix_path, BottleTypes::Bit bit, const vector<string>& font_names);
   static string get_image_location(const string& filename);
   static bool is_default_wine_bottle(const string& prefix_path);
   static string encode_text(const string& text);
@@ -112,13 +150,17 @@ private:
   Helper(const Helper&) = delete;
   Helper& operator=(const Helper&) = delete;
 
-  static std::pair<int, string> exec(const string& command);
-  static string exec_error_message(const string& command);
-  static int close_exec_stream(std::FILE* file);
+  static std::pair<int, string> exec(const vector<string>& program,
+                                     const vector<pair<string, string>>& env_vars = {},
+                                     const string& working_directory = "",
+                                     bool stderr_output = true);
+  static vector<pair<string, string>>
+  get_program_env_vars(const string& prefix_path, int debug_log_level, const vector<pair<string, string>>& env_vars);
   static void write_file(const string& filename, const string& contents);
   static string read_file(const string& filename);
   static string get_winetricks_version();
   static string get_reg_value(const string& filename, const string& key_name, const string& value_name);
+  static vector<string> get_reg_values(const string& file_path, const vector<pair<string, string>>& key_value_names);
   static vector<string> get_reg_keys(const string& file_path, const string& key_name);
   static vector<pair<string, string>> get_reg_keys_name_data_pair(const string& file_path, const string& key_name);
   static vector<pair<string, string>>
@@ -133,11 +175,12 @@ private:
                                                               const string& key_name,
                                                               const string& key_value_filter = "",
                                                               const string& key_name_ignore_filter = "");
+  static bool is_reg_value_matching(std::string_view name,
+                                    std::string_view data,
+                                    const string& key_value_filter,
+                                    const string& key_name_ignore_filter);
   static string get_reg_meta_data(const string& filename, const string& meta_value_name);
   static string get_bottle_dir_from_prefix(const string& prefix_path);
   static vector<string> read_file_lines(const string& file_path);
   static vector<string> split(const string& s, const char delimiter);
-  static string unescape_reg_key_data(const string& src);
-  static string string2hex(const string& str, bool capital = false);
-  static string hex2string(const string& hexstr);
 };
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    icon_cache.h
+ * \brief   Process-wide cache of decoded application icons
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <gdkmm/pixbuf.h>
+#include <glibmm/dispatcher.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \class IconCache
+ * \brief Decodes icon files lazily on a background thread and keeps the decoded icons (keyed by file path) during the process lifetime
+ */
+class IconCache
+{
+public:
+  // Signals
+  sigc::signal<void, const std::string&> icon_loaded; /*!< Icon decoding is finished (also on failure), emitted in the GUI thread */
+
+  // Singleton
+  static IconCache& get_instance();
+
+  bool lookup(const std::string& file_path, Glib::RefPtr<Gdk::Pixbuf>& icon);
+  void request(const std::string& file_path);
+  const Glib::RefPtr<Gdk::Pixbuf>& get_placeholder();
+
+private:
+  IconCache();
+  ~IconCache();
+  IconCache(const IconCache&) = delete;
+  IconCache& operator=(const IconCache&) = delete;
+
+  std::mutex mutex_;
+  std::condition_variable queue_condition_;
+  std::deque<std::string> queue_;                          /*!< Icon files waiting to be decoded */
+  std::set<std::string> pending_;                          /*!< Icon files queued or being decoded, avoids duplicate requests */
+  std::map<std::string, Glib::RefPtr<Gdk::Pixbuf>> icons_; /*!< Decoded icons (empty pointer if decoding failed) */
+  std::vector<std::string> loaded_;                        /*!< Decoded icon files, not yet signalled to the GUI thread */
+  bool is_stopped_;
+  std::thread loader_thread_;
+  Glib::Dispatcher loaded_dispatcher_;
+  Glib::RefPtr<Gdk::Pixbuf> placeholder_;
+
+  void loader_loop();
+  void on_loaded();
+};
@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    installed_program_struct.h
+ * \brief   Installed program struct
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+
+/**
+ * \struct InstalledProgramData
+ * \brief Program listed in the Uninstall registry key of a bottle (like 'wine uninstaller --list' shows)
+ */
+struct InstalledProgramData
+{
+  std::string key;             /*!< Name of the Uninstall subkey (eg. {E45D8920-A758-4088-B6C6-31DBB276992E}) */
+  std::string guid;            /*!< GUID without braces, empty if the subkey is not a GUID */
+  std::string display_name;    /*!< Display name */
+  std::string display_version; /*!< Display version (can be empty) */
+  std::string publisher;       /*!< Publisher (can be empty) */
+};
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    log_writer.h
+ * \brief   Append program output to a log file via a bounded ring buffer
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * \class LogWriter
+ * \brief Streams data to the end of a log file. Data is queued in a fixed size ring buffer and written by a background thread.
+ * When the buffer is full, write() blocks until the writer thread caught up, so memory usage stays the same regardless of the amount of data.
+ */
+class LogWriter
+{
+public:
+  explicit LogWriter(const std::string& file_path);
+  ~LogWriter();
+  LogWriter(const LogWriter&) = delete;
+  LogWriter& operator=(const LogWriter&) = delete;
+
+  void write(std::string_view data);
+  void close();
+
+private:
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::vector<char> buffer_; /*!< Ring buffer */
+  std::size_t head_;         /*!< Read position in the ring buffer */
+  std::size_t size_;         /*!< Number of bytes in the ring buffer, not yet written to disk */
+  bool is_closed_;
+  char last_char_; /*!< Last character written, used to end the log with a new line */
+  int fd_;
+  std::thread writer_thread_;
+
+  void writer_loop();
+  void write_to_file(const char* data, std::size_t size);
+};
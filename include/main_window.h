@@ -27,9 +27,11 @@
 #include "busy_dialog.h"
 #include "general_config_struct.h"
 #include "menu.h"
+#include <atomic>
 #include <gtkmm.h>
 #include <iostream>
 #include <list>
+#include <map>
 #include <string>
 #include <thread>
 
@@ -45,13 +47,14 @@ class MainWindow : public Gtk::Window
 {
 public:
   // Signals
-  sigc::signal<void, Glib::ustring&> finished_new_bottle; /*!< Finished signal after the bottle is created, with the new bottle name */
-  sigc::signal<void, BottleItem*> active_bottle;          /*!< Set the active bottle in manager, based on the selected bottle */
-  sigc::signal<void> show_edit_window;                    /*!< show Edit window signal */
-  sigc::signal<void> show_clone_window;                   /*!< show Clone window signal */
-  sigc::signal<void> show_configure_window;               /*!< show Settings window signal */
-  sigc::signal<void> show_add_app_window;                 /*!< show add application window signal */
-  sigc::signal<void> show_remove_app_window;              /*!< show remove application window signal */
+  sigc::signal<void, Glib::ustring&> finished_new_bottle;               /*!< Finished signal after the bottle is created, with the new bottle name */
+  sigc::signal<void, BottleItem*> active_bottle;                        /*!< Set the active bottle in manager, based on the selected bottle */
+  sigc::signal<void, const std::vector<BottleItem*>&> selected_bottles; /*!< All selected bottles, for batch operations */
+  sigc::signal<void> show_edit_window;                                  /*!< show Edit window signal */
+  sigc::signal<void> show_clone_window;                                 /*!< show Clone window signal */
+  sigc::signal<void> show_configure_window;                             /*!< show Settings window signal */
+  sigc::signal<void> show_add_app_window;                               /*!< show add application window signal */
+  sigc::signal<void> show_remove_app_window;                            /*!< show remove application window signal */
   sigc::signal<void, Glib::ustring&, BottleTypes::Windows, BottleTypes::Bit, Glib::ustring&, bool&, BottleTypes::AudioDriver>
       new_bottle;                                       /*!< Create new Wine Bottle Signal */
   sigc::signal<void, string, bool> run_executable;      /*!< Run an EXE or MSI application in Wine with provided filename */
@@ -62,12 +65,15 @@ public:
   sigc::signal<void> open_log_file;                     /*!< Open log file signal */
   sigc::signal<void> kill_running_processes;            /*!< Kill all running processes signal */
   sigc::signal<bool, GdkEventButton*> right_click_menu; /*!< Right-mouse click in list box signal */
+  sigc::signal<void> cancel_busy_task;                  /*!< Cancel button clicked in the busy dialog (only when cancellable) */
 
   explicit MainWindow(Menu& menu);
   virtual ~MainWindow();
 
   void set_wine_bottles(std::list<BottleItem>& bottles);
+  void show_bottle_placeholders();
   void select_row_bottle(BottleItem& bottle);
+  void refresh_bottle(BottleItem& bottle);
   void reset_detailed_info();
   void reset_application_list();
   void set_general_config(const GeneralConfigData& config_data);
@@ -75,8 +81,13 @@ public:
   void show_warning_message(const Glib::ustring& message, bool markup = false);
   void show_error_message(const Glib::ustring& message, bool markup = false);
   bool show_confirm_dialog(const Glib::ustring& message, bool markup = false);
+  void show_busy_dialog(const Glib::ustring& heading_text, const Glib::ustring& message);
+  void show_remove_progress(const Glib::ustring& text, double fraction);
+  void hide_remove_progress();
   void show_busy_install_dialog(const Glib::ustring& message);
   void show_busy_install_dialog(Gtk::Window& parent, const Glib::ustring& message);
+  void show_busy_progress_dialog(Gtk::Window& parent, const Glib::ustring& heading_text, const Glib::ustring& message);
+  void set_busy_dialog_progress(double fraction);
   void close_busy_dialog();
 
   // Signal handlers
@@ -104,8 +115,10 @@ protected:
   Gtk::Box vbox;    /*!< The main vertical box */
   Gtk::Paned paned; /*!< The main paned panel (horizontal) */
   // Left widgets
+  Gtk::Box left_vbox;                          /*!< Left panel vertical box */
   Gtk::ScrolledWindow scrolled_window_listbox; /*!< Scrolled Window container, which contains the listbox */
   Gtk::ListBox listbox;                        /*!< Listbox in the left panel */
+  Gtk::ProgressBar remove_progress_bar;        /*!< Progress of the bottles being removed, below the listbox */
   // Right widgets
   Gtk::ScrolledWindow detail_grid_scrolled_window_detail; /*!< Scrolled Window container for the detail grid */
   Gtk::ScrolledWindow app_list_scrolled_window;           /*!< Scrolled Window container for app list */
@@ -168,28 +181,45 @@ private:
   string unknown_desktop_item_name_;
   BottleNewAssistant new_bottle_assistant_; /*!< New bottle wizard (behind the "new" toolbar button) */
   GeneralConfigData general_config_data_;
-  std::thread* thread_check_version_; /*!< Thread for checking version */
+  std::thread* thread_check_version_;                       /*!< Thread for checking version */
+  BottleItem* active_bottle_item_;                          /*!< Bottle shown in the detailed info panel (the active bottle) */
+  std::map<std::size_t, std::thread> app_list_threads_;     /*!< Threads for collecting the application list items (key: generation) */
+  std::vector<std::size_t> finished_app_list_threads_;      /*!< Generations of the finished application list threads, not yet joined */
+  std::mutex app_list_mutex_;                               /*!< Synchronizes access to the pending application list items */
+  std::atomic<std::size_t> app_list_generation_;            /*!< Incremented on each set_application_list() call, so an outdated thread stops */
+  std::vector<ApplicationListItem> pending_app_list_items_; /*!< Items collected by the thread, not yet added to the application list */
   // Dispatchers for handling signals from the thread towards a GUI thread
   Glib::Dispatcher error_message_check_version_dispatcher_;
   Glib::Dispatcher info_message_check_version_dispatcher_;
   Glib::Dispatcher new_version_available_dispatcher_;
   Glib::Dispatcher check_version_finished_dispatcher_;
+  Glib::Dispatcher app_list_items_dispatcher_;
+  Glib::Dispatcher app_list_finished_dispatcher_;
+  Glib::RefPtr<Gtk::CssProvider> placeholder_css_provider_; /*!< Style of the placeholder rows, shown while loading the bottles */
 
   // Signal handlers
   virtual void on_bottle_row_clicked(Gtk::ListBoxRow* row);
+  virtual void on_bottle_selection_changed();
   virtual void on_app_list_changed();
   virtual void on_application_row_activated(const Gtk::TreeModel::Path& path, Gtk::TreeViewColumn* /* column */);
   virtual void on_new_bottle_apply();
+  virtual void on_icon_loaded(const string& icon_path);
+  virtual void on_application_list_items();
 
   // Private methods
   void set_detailed_info(const BottleItem& bottle);
   void set_application_list(const string& prefix_path, const std::map<int, ApplicationData>& app_List);
+  void load_application_list(std::size_t generation, const string& prefix_path);
+  bool add_to_application_batch(std::size_t generation, std::vector<ApplicationListItem>& batch, ApplicationListItem item);
+  bool flush_application_batch(std::size_t generation, std::vector<ApplicationListItem>& batch);
   void add_application(const string& name, const string& description, const string& command, const string& icon_name, bool is_icon_full_path = false);
+  void cleanup_app_list_threads();
   void cleanup_check_version_thread();
   void check_version_update(bool show_equal_or_error = false);
   void check_version(bool show_equal_or_error);
   void load_stored_window_settings();
   void create_left_panel();
+  Gtk::Box* create_placeholder_block(int width, int height);
   void create_right_panel();
   void set_sensitive_toolbar_buttons(bool sensitive);
   static void cc_list_box_update_header_func(Gtk::ListBoxRow* list_box_row, Gtk::ListBoxRow* before);
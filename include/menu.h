@@ -33,6 +33,7 @@ public:
   sigc::signal<void> preferences;      /*!< preferences button clicked signal */
   sigc::signal<void> quit;             /*!< quite button clicked signal */
   sigc::signal<void> refresh_view;     /*!< refresh button clicked signal */
+  sigc::signal<void> deduplicate;      /*!< deduplicate machines button clicked signal */
   sigc::signal<void> new_bottle;       /*!< new machine button clicked signal */
   sigc::signal<void> edit_bottle;      /*!< edit button clicked signal */
   sigc::signal<void> clone_bottle;     /*!< clone button clicked signal */
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    overlay_bottle.h
+ * \brief   Copy-on-write bottles layered on top of a template bottle (fuse-overlayfs)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * \class OverlayBottle
+ * \brief Copy-on-write bottles: the files of a template bottle are shared read-only (lower layer),
+ * the overlay bottle only stores its own changes (upper layer). Both layers are merged by fuse-overlayfs into
+ * the bottle folder, so Wine and the rest of WineGUI see a regular Wine prefix.
+ *
+ * The layers and the overlay definition (overlay.ini) are stored in ~/.local/share/winegui/overlays/<id>.
+ * The overlays are mounted again by mount_all(), eg. after a reboot.
+ */
+class OverlayBottle
+{
+public:
+  static bool is_available();
+  static void create(const std::string& template_prefix_path, const std::string& prefix_path);
+  static void mount_all();
+  static bool is_overlay(const std::string& prefix_path);
+  static std::vector<std::string> get_derived_bottles(const std::string& template_prefix_path);
+  static bool is_template_in_use(const std::string& template_prefix_path);
+  static void move(const std::string& prefix_path, const std::string& new_prefix_path);
+  static std::string move_to_trash(const std::string& prefix_path);
+  static std::string get_overlays_directory();
+
+private:
+  OverlayBottle() = delete;
+
+  /**
+   * \struct Overlay
+   * \brief Overlay bottle definition
+   */
+  struct Overlay
+  {
+    std::string directory;  /*!< Overlay directory, containing the upper and work directories */
+    std::string lower_path; /*!< Template bottle (read-only lower layer) */
+    std::string mount_path; /*!< Bottle folder, where the layers are merged */
+  };
+
+  static std::vector<Overlay> get_overlays();
+  static bool find_overlay(const std::string& prefix_path, Overlay& overlay);
+  static void write_overlay_file(const Overlay& overlay);
+  static void mount(const Overlay& overlay);
+  static void unmount(const std::string& mount_path);
+  static bool is_mounted(const std::string& mount_path);
+};
@@ -46,11 +46,13 @@ protected:
   Gtk::Label header_preferences_label;                 /*!< header preferences label */
   Gtk::Label default_folder_label;                     /*!< default folder label */
   Gtk::Label display_default_wine_machine_label;       /*!< display default Wine machine label */
+  Gtk::Label batch_parallelism_label;                  /*!< batch parallelism label */
   Gtk::Label logging_label_heading;                    /*!< Logging header label */
   Gtk::Label logging_stderr_label;                     /*!< logging stderr label */
   Gtk::Entry default_folder_entry;                     /*!< default folder input field */
   Gtk::CheckButton display_default_wine_machine_check; /*!< display default Wine machine checkbox */
   Gtk::CheckButton enable_logging_stderr_check;        /*!< debug logging checkbox */
+  Gtk::SpinButton batch_parallelism_spin_button;       /*!< maximum number of machines handled at the same time */
   Gtk::Button select_folder_button;                    /*!< select folder button */
   Gtk::Button save_button;                             /*!< save button */
   Gtk::Button cancel_button;                           /*!< cancel button */
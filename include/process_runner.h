@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    process_runner.h
+ * \brief   Run external programs without a shell (posix_spawn)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <functional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+/**
+ * \class ProcessRunner
+ * \brief Spawn a program directly (argument vector + environment), no /bin/sh in between, so no quoting is needed
+ */
+class ProcessRunner
+{
+public:
+  static std::pair<int, std::string> run(const std::vector<std::string>& argv,
+                                         const std::vector<std::pair<std::string, std::string>>& env_vars = {},
+                                         const std::string& working_directory = "",
+                                         bool stderr_output = true,
+                                         std::stop_token stop_token = {});
+  static int stream(const std::vector<std::string>& argv,
+                    const std::function<void(std::string_view)>& on_output,
+                    const std::vector<std::pair<std::string, std::string>>& env_vars = {},
+                    const std::string& working_directory = "",
+                    bool stderr_output = true,
+                    std::stop_token stop_token = {});
+  static pid_t spawn(const std::vector<std::string>& argv,
+                     const std::vector<std::pair<std::string, std::string>>& env_vars = {},
+                     const std::string& working_directory = "",
+                     const std::string& output_path = "",
+                     bool stderr_output = true);
+
+private:
+  ProcessRunner() = delete;
+
+  static int start_process(const std::vector<std::string>& argv,
+                           const std::vector<std::pair<std::string, std::string>>& env_vars,
+                           const std::string& working_directory,
+                           int output_fd,
+                           bool stderr_output,
+                           pid_t& pid);
+
+  static std::vector<std::string> build_environment(const std::vector<std::pair<std::string, std::string>>& env_vars);
+};
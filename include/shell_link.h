@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    shell_link.h
+ * \brief   Parser for Windows shortcut files (.lnk, MS-SHLLINK format)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * \struct ShellLinkData
+ * \brief Data of a Windows shortcut file, paths are Windows paths (eg. C:\\Program Files\\App\\app.exe)
+ */
+struct ShellLinkData
+{
+  std::string target_path;       /*!< Path of the link target (empty if the shortcut doesn't point to a file system path) */
+  std::string arguments;         /*!< Command line arguments */
+  std::string working_directory; /*!< Working directory */
+  std::string icon_location;     /*!< File containing the icon (empty if the icon of the target is used) */
+  int icon_index = 0;            /*!< Index of the icon within the icon location */
+};
+
+/**
+ * \class ShellLink
+ * \brief Parses the binary Shell Link structures (header, LinkTargetIDList, LinkInfo and StringData) directly on the file data
+ */
+class ShellLink
+{
+public:
+  static ShellLinkData parse(std::string_view data);
+
+private:
+  ShellLink() = delete;
+
+  static std::string get_id_list_path(std::string_view id_list);
+  static std::string get_link_info_path(std::string_view link_info);
+  static void append_path(std::string& path, std::string_view component, bool is_utf16);
+  static std::string read_string_data(std::string_view data, std::size_t& offset, bool is_unicode);
+  static void append_utf16(std::string& output, std::string_view data);
+  static std::uint16_t read_u16(std::string_view data, std::size_t offset);
+  static std::uint32_t read_u32(std::string_view data, std::size_t offset);
+};
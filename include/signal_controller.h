@@ -22,6 +22,8 @@
 
 #include "bottle_types.h"
 #include <gtkmm.h>
+#include <mutex>
+#include <stop_token>
 #include <thread>
 
 // Forward declaration
@@ -69,6 +71,8 @@ public:
   void signal_bottle_created();
   void signal_bottle_updated();
   void signal_bottle_cloned();
+  void signal_clone_cancelled();
+  void signal_clone_progress(double fraction);
   void signal_error_message_during_create();
   void signal_error_message_during_update();
   void signal_error_message_during_clone();
@@ -87,9 +91,12 @@ private:
                              BottleTypes::AudioDriver audio);
   virtual void on_update_bottle(const UpdateBottleStruct& update_bottle_struct);
   virtual void on_clone_bottle(const CloneBottleStruct& clone_bottle_struct);
+  virtual void on_cancel_clone();
   virtual void on_new_bottle_created();
   virtual void on_bottle_updated();
   virtual void on_bottle_cloned();
+  virtual void on_clone_cancelled();
+  virtual void on_clone_progress();
   virtual void on_error_message_created();
   virtual void on_error_message_updated();
   virtual void on_error_message_cloned();
@@ -110,9 +117,15 @@ private:
   Glib::Dispatcher bottle_created_dispatcher_;
   Glib::Dispatcher bottle_updated_dispatcher_;
   Glib::Dispatcher bottle_cloned_dispatcher_;
+  Glib::Dispatcher clone_cancelled_dispatcher_;
   Glib::Dispatcher error_message_created_dispatcher_;
   Glib::Dispatcher error_message_updated_dispatcher_;
   Glib::Dispatcher error_message_cloned_dispatcher_;
+  Glib::Dispatcher clone_progress_dispatcher_;
+  // Clone progress (0.0 - 1.0), set by the manager thread
+  std::mutex clone_progress_mutex_;
+  double clone_progress_;
+  std::stop_source clone_stop_source_; /*!< Cancels the running clone */
   // Thread for Bottle Manager (so it doesn't block the GUI thread)
   std::unique_ptr<std::thread> thread_bottle_manager_;
 };
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    task_executor.h
+ * \brief   Bounded pool of worker threads to run background tasks
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+/**
+ * \class TaskExecutor
+ * \brief Runs tasks on a bounded pool of worker threads. Workers are only started when needed, up to the maximum.
+ * Tasks get a stop token, which is triggered when the executor shuts down. Tasks are expected to handle their own errors,
+ * an uncaught exception is only logged.
+ */
+class TaskExecutor
+{
+public:
+  explicit TaskExecutor(unsigned int max_workers);
+  ~TaskExecutor();
+  TaskExecutor(const TaskExecutor&) = delete;
+  TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+  void submit(std::function<void(std::stop_token)> work);
+  void shutdown();
+  bool is_busy();
+
+private:
+  /**
+   * \struct Task
+   * \brief Submitted work with its own stop source, triggered when the executor shuts down while the task is running
+   */
+  struct Task
+  {
+    std::stop_source stop_source;
+    std::function<void(std::stop_token)> work;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable queue_condition_;
+  std::deque<std::shared_ptr<Task>> queue_;          /*!< Tasks waiting for a worker */
+  std::vector<std::shared_ptr<Task>> running_tasks_; /*!< Tasks currently running, cancelled on shutdown */
+  std::vector<std::thread> workers_;
+  unsigned int max_workers_;
+  unsigned int idle_workers_;
+  bool is_shutdown_;
+
+  void worker_loop();
+};
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_registry.h
+ * \brief   Indexed read-only view of a Wine registry hive file (.reg)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * \class WineRegistry
+ * \brief Memory-maps a Wine registry hive (like system.reg or user.reg) and indexes all keys and values in a single pass.
+ *
+ * The index only holds string_view slices into the mapping, nothing is copied or unescaped while parsing.
+ * Key names are used in the same escaped form as they appear in the hive file, including the opening bracket
+ * (eg. [Software\\\\Wine\\\\Explorer]). A key name without the closing bracket is matched as prefix.
+ * The parsed hives are shared via open(), which only parses the file again after it got changed on disk.
+ */
+class WineRegistry
+{
+public:
+  using Value = std::pair<std::string_view, std::string_view>;      /*!< Raw value name + raw value data */
+  using ValueQuery = std::pair<std::string_view, std::string_view>; /*!< Key name + value name to look up */
+
+  explicit WineRegistry(const std::string& file_path);
+  ~WineRegistry();
+  WineRegistry(const WineRegistry&) = delete;
+  WineRegistry& operator=(const WineRegistry&) = delete;
+
+  static std::shared_ptr<const WineRegistry> open(const std::string& file_path);
+  static std::string unescape(std::string_view src);
+  static std::string unquote(std::string_view data);
+
+  std::string_view get_raw_value(std::string_view key_name, std::string_view value_name) const;
+  std::string get_value(std::string_view key_name, std::string_view value_name) const;
+  std::vector<std::string> get_values(const std::vector<ValueQuery>& queries) const;
+  std::vector<std::string_view> get_key_lines(std::string_view key_name) const;
+  std::vector<std::string_view> get_subkeys(std::string_view key_name) const;
+  const std::vector<Value>& get_values(std::string_view key_name) const;
+  std::string get_meta_data(std::string_view meta_value_name) const;
+
+private:
+  /**
+   * \struct Key
+   * \brief All the data lines of a single registry key
+   */
+  struct Key
+  {
+    std::vector<std::string_view> lines; /*!< Data lines of the key section (excluding meta data lines) */
+    std::vector<Value> values;           /*!< Values in file order */
+  };
+
+  const char* data_;                                            /*!< Start of the memory mapped hive */
+  std::size_t size_;                                            /*!< Size of the mapping in bytes */
+  std::unordered_map<std::string_view, Key> keys_;              /*!< Key name (including brackets) -> key data */
+  std::vector<std::string_view> key_order_;                     /*!< Key names in file order, used for prefix matching */
+  std::unordered_map<std::string_view, std::string_view> meta_; /*!< Global meta data of the hive (eg. arch) */
+
+  void parse();
+  const Key* find_key(std::string_view key_name) const;
+};
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_registry_writer.h
+ * \brief   Batched changes to the Wine registry hives of a bottle (.reg)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \class WineRegistryWriter
+ * \brief Collects registry changes for a bottle and applies them all at once with commit().
+ *
+ * When the wineserver of the bottle is not running, the hive files (user.reg/system.reg) are edited in place,
+ * which only takes a few milliseconds. A running wineserver keeps the registry in memory and overwrites the hive files
+ * when it exits, so in that case all the changes are imported in a single 'wine regedit' call instead.
+ * Key paths are relative to the hive root with single backslashes (eg. Software\\Wine\\Explorer), nothing needs to be escaped.
+ */
+class WineRegistryWriter
+{
+public:
+  /**
+   * \enum Hive
+   * \brief Registry hive of the bottle
+   */
+  enum class Hive
+  {
+    user,  /*!< HKEY_CURRENT_USER (user.reg) */
+    system /*!< HKEY_LOCAL_MACHINE (system.reg) */
+  };
+
+  explicit WineRegistryWriter(const std::string& prefix_path);
+
+  const std::string& get_prefix_path() const;
+  void set_string(Hive hive, const std::string& key_path, const std::string& value_name, const std::string& data);
+  void remove_value(Hive hive, const std::string& key_path, const std::string& value_name);
+  void commit(const std::string& wine_executable = "wine");
+
+private:
+  /**
+   * \enum Type
+   * \brief Type of a registry change
+   */
+  enum class Type
+  {
+    string_value, /*!< Set string value (REG_SZ) */
+    removed       /*!< Remove the value */
+  };
+
+  /**
+   * \struct Change
+   * \brief Single value change
+   */
+  struct Change
+  {
+    Hive hive;
+    std::string key_path;   /*!< Key path, unescaped */
+    std::string value_name; /*!< Value name, unescaped */
+    Type type;
+    std::string data; /*!< String data (unescaped) */
+  };
+
+  std::string prefix_path_;
+  std::vector<Change> changes_; /*!< Changes in the order they were made */
+
+  void write_hive(Hive hive) const;
+  void import_with_regedit(const std::string& wine_executable) const;
+  static std::string get_hive_data(const Change& change);
+  static std::string escape(std::string_view text, std::string_view quote_chars);
+  static std::u16string to_utf16(std::string_view text);
+  static bool starts_with_ignore_case(std::string_view text, std::string_view prefix);
+};
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_runtime.h
+ * \brief   Cached detection of the installed Wine runtime
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * \struct WineRunner
+ * \brief Installed Wine build (like Wine stable, staging or Proton-GE)
+ */
+struct WineRunner
+{
+  std::string name;        /*!< Runner name: "System" for the Wine found in PATH, otherwise the folder name of the runner */
+  std::string wine_path;   /*!< Full path to the wine binary (empty if only wine64 is present) */
+  std::string wine64_path; /*!< Full path to the wine64 binary (empty if not present) */
+  std::string version;     /*!< Wine version, empty if the version could not be determined */
+};
+
+/**
+ * \class WineRuntime
+ * \brief Registry of the installed Wine runners: the Wine found in PATH, the runners in ~/.local/share/winegui/runners
+ * and in custom directories. The version of each binary is only probed again when the binary on disk changed (inode/mtime/size).
+ */
+class WineRuntime
+{
+public:
+  static std::string get_wine_version(bool wine_64_bit);
+  static void discover_runners(const std::vector<std::string>& custom_directories);
+  static std::vector<WineRunner> get_runners();
+  static std::string get_wine_executable(const std::string& runner_name, bool wine_64_bit);
+  static std::string get_wineserver_executable(const std::string& runner_name);
+  static std::string get_runner_version(const std::string& runner_name);
+  static std::string get_runners_directory();
+
+private:
+  WineRuntime() = delete;
+
+  static std::string probe_version(const std::string& binary_path);
+  static bool add_runner(const std::string& runner_directory, std::vector<WineRunner>& runners);
+  static void add_runners(const std::string& directory, std::vector<WineRunner>& runners);
+};
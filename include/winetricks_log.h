@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    winetricks_log.h
+ * \brief   Parsed view of the winetricks.log file of a bottle
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * \class WinetricksLog
+ * \brief Verbs installed with Winetricks, read from the winetricks.log file in the bottle.
+ *
+ * Winetricks appends every verb it successfully ran (including dependencies) to this log file.
+ * Setting verbs (like win10 or vd=1024x768) are skipped, only the installed packages are kept.
+ * The parsed logs are shared via open(), which only reads the file again after it got changed on disk.
+ */
+class WinetricksLog
+{
+public:
+  explicit WinetricksLog(const std::string& file_path);
+
+  static std::shared_ptr<const WinetricksLog> open(const std::string& prefix_path);
+
+  bool has_verb(std::string_view verb) const;
+  bool has_verb_with_version(std::string_view verb) const;
+  const std::vector<std::string>& get_verbs() const;
+
+private:
+  std::vector<std::string> verbs_;                /*!< Installed verbs in install order (without duplicates) */
+  std::set<std::string, std::less<>> verb_index_; /*!< Installed verbs sorted, for fast look-ups */
+
+  static bool is_setting_verb(std::string_view verb);
+};
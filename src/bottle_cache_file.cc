@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_cache_file.cc
+ * \brief   Persistent cache of the bottle details read from the bottle registry files
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_cache_file.h"
+#include <giomm.h>
+#include <glibmm.h>
+#include <iostream>
+
+static const int CacheVersion = 1; /*!< Increase when the cache format changes, older cache files are ignored */
+
+/// Meyers Singleton
+BottleCacheFile::BottleCacheFile() = default;
+/// Destructor
+BottleCacheFile::~BottleCacheFile() = default;
+
+/**
+ * \brief Get singleton instance
+ * \return BottleCacheFile reference (singleton)
+ */
+BottleCacheFile& BottleCacheFile::get_instance()
+{
+  static BottleCacheFile instance;
+  return instance;
+}
+
+/**
+ * \brief Write the bottle cache file to disk (replaces all existing cache entries)
+ * \param bottles Map of bottle prefix path with the cached bottle data
+ * \return true if successfully written, otherwise false
+ */
+bool BottleCacheFile::write_cache_file(const std::map<std::string, BottleCacheData>& bottles)
+{
+  bool success = false;
+  Glib::KeyFile keyfile;
+  std::string cache_file_path = get_cache_file_path();
+  try
+  {
+    // Check if cache folder directory exists
+    std::string cache_location = Glib::path_get_dirname(cache_file_path);
+    if (!Glib::file_test(cache_location, Glib::FileTest::FILE_TEST_IS_DIR))
+    {
+      Glib::RefPtr<Gio::File> directory = Gio::File::create_for_path(cache_location);
+      if (directory)
+        directory->make_directory_with_parents();
+    }
+
+    keyfile.set_integer("Cache", "Version", CacheVersion);
+    int index = 0;
+    for (const auto& [prefix, cache_data] : bottles)
+    {
+      const BottleScanData& bottle = cache_data.bottle;
+      Glib::ustring group = "Bottle" + std::to_string(index++);
+      keyfile.set_string(group, "Prefix", prefix);
+      keyfile.set_string(group, "Fingerprint", cache_data.fingerprint);
+      keyfile.set_string(group, "FolderName", bottle.folder_name);
+      keyfile.set_string(group, "CDriveLocation", bottle.c_drive_location);
+      keyfile.set_string(group, "LastTimeWineUpdated", bottle.last_time_wine_updated);
+      keyfile.set_string(group, "VirtualDesktop", bottle.virtual_desktop);
+      keyfile.set_integer(group, "Bit", static_cast<int>(bottle.bit));
+      keyfile.set_integer(group, "AudioDriver", static_cast<int>(bottle.audio_driver));
+      keyfile.set_integer(group, "Windows", static_cast<int>(bottle.windows));
+      keyfile.set_boolean(group, "Status", bottle.status);
+    }
+    success = keyfile.save_to_file(cache_file_path);
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while writing bottle cache file: " << ex.what() << std::endl;
+  }
+  return success;
+}
+
+/**
+ * \brief Read the bottle cache file from disk
+ * \return Map of bottle prefix path with the cached bottle data, empty map if there is no (valid) cache file
+ */
+std::map<std::string, BottleCacheData> BottleCacheFile::read_cache_file()
+{
+  std::map<std::string, BottleCacheData> bottles;
+  Glib::KeyFile keyfile;
+  std::string cache_file_path = get_cache_file_path();
+
+  // Check if cache file exists
+  if (!Glib::file_test(cache_file_path, Glib::FileTest::FILE_TEST_IS_REGULAR))
+    return bottles;
+
+  try
+  {
+    keyfile.load_from_file(cache_file_path);
+    if (keyfile.get_integer("Cache", "Version") != CacheVersion)
+      return bottles;
+
+    for (const Glib::ustring& group : keyfile.get_groups())
+    {
+      if (group == "Cache")
+        continue;
+      BottleCacheData cache_data;
+      BottleScanData& bottle = cache_data.bottle;
+      bottle.prefix = keyfile.get_string(group, "Prefix");
+      cache_data.fingerprint = keyfile.get_string(group, "Fingerprint");
+      bottle.folder_name = keyfile.get_string(group, "FolderName");
+      bottle.c_drive_location = keyfile.get_string(group, "CDriveLocation");
+      bottle.last_time_wine_updated = keyfile.get_string(group, "LastTimeWineUpdated");
+      bottle.virtual_desktop = keyfile.get_string(group, "VirtualDesktop");
+      bottle.bit = static_cast<BottleTypes::Bit>(keyfile.get_integer(group, "Bit"));
+      bottle.audio_driver = static_cast<BottleTypes::AudioDriver>(keyfile.get_integer(group, "AudioDriver"));
+      bottle.windows = static_cast<BottleTypes::Windows>(keyfile.get_integer(group, "Windows"));
+      bottle.status = keyfile.get_boolean(group, "Status");
+      bottles.insert_or_assign(bottle.prefix, std::move(cache_data));
+    }
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while loading bottle cache file: " << ex.what() << std::endl;
+    // Corrupt cache, just start over with an empty cache
+    bottles.clear();
+  }
+  return bottles;
+}
+
+/**
+ * \brief Get the location of the bottle cache file (~/.cache/winegui/bottles.ini)
+ * \return Cache file path
+ */
+std::string BottleCacheFile::get_cache_file_path()
+{
+  std::vector<std::string> cache_dirs{Glib::get_user_cache_dir(), "winegui"};
+  std::string cache_location = Glib::build_path(G_DIR_SEPARATOR_S, cache_dirs);
+  return Glib::build_filename(cache_location, "bottles.ini");
+}
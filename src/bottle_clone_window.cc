@@ -20,6 +20,7 @@
  */
 #include "bottle_clone_window.h"
 #include "bottle_item.h"
+#include "overlay_bottle.h"
 
 /**
  * \brief Constructor
@@ -69,6 +70,9 @@ BottleCloneWindow::BottleCloneWindow(Gtk::Window& parent)
 
   description_text_view.set_hexpand(true);
   description_label.set_tooltip_text("Optional new description text to your machine");
+  share_files_check.set_label("Share the files with the original machine (copy-on-write)");
+  share_files_check.set_tooltip_text("Only the changes are stored for the new machine, the original machine is used as read-only template. "
+                                     "Requires fuse-overlayfs.");
 
   description_scrolled_window.add(description_text_view);
   description_scrolled_window.set_hexpand(true);
@@ -78,6 +82,7 @@ BottleCloneWindow::BottleCloneWindow(Gtk::Window& parent)
   clone_grid.attach(name_entry, 1, 0);
   clone_grid.attach(folder_name_label, 0, 1);
   clone_grid.attach(folder_name_entry, 1, 1);
+  clone_grid.attach(share_files_check, 0, 2, 2);
   clone_grid.attach(*Gtk::manage(new Gtk::Separator(Gtk::ORIENTATION_HORIZONTAL)), 0, 8, 2);
   clone_grid.attach(description_label, 0, 9, 2);
   clone_grid.attach(description_scrolled_window, 0, 10, 2);
@@ -93,6 +98,7 @@ BottleCloneWindow::BottleCloneWindow(Gtk::Window& parent)
   // Signals
   cancel_button.signal_clicked().connect(sigc::mem_fun(*this, &BottleCloneWindow::on_cancel_button_clicked));
   clone_button.signal_clicked().connect(sigc::mem_fun(*this, &BottleCloneWindow::on_clone_button_clicked));
+  busy_dialog.cancel.connect(cancel_clone.make_slot());
 
   show_all_children();
 }
@@ -122,6 +128,10 @@ void BottleCloneWindow::show()
     folder_name_entry.set_text(active_bottle_->folder_name() + "_copy");
     // Set description
     description_text_view.get_buffer()->set_text(active_bottle_->description());
+    // Sharing files is only possible with fuse-overlayfs, and not on top of a machine sharing files itself
+    bool can_share_files = OverlayBottle::is_available() && !OverlayBottle::is_overlay(active_bottle_->wine_location());
+    share_files_check.set_active(false);
+    share_files_check.set_sensitive(can_share_files);
 
     show_all_children();
   }
@@ -150,6 +160,15 @@ void BottleCloneWindow::reset_active_bottle()
   active_bottle_ = nullptr;
 }
 
+/**
+ * \brief Show the clone progress in the busy dialog
+ * \param[in] fraction Progress of the copy (0.0 - 1.0)
+ */
+void BottleCloneWindow::set_clone_progress(double fraction)
+{
+  busy_dialog.set_progress(fraction);
+}
+
 /**
  * \brief Handler when the bottle is cloned. Return just cloned bottle name
  */
@@ -160,6 +179,15 @@ Glib::ustring BottleCloneWindow::on_bottle_cloned()
   return name_entry.get_text();
 }
 
+/**
+ * \brief Handler when the clone is cancelled (in the busy dialog), the clone window stays open to try again
+ */
+void BottleCloneWindow::on_clone_cancelled()
+{
+  busy_dialog.hide();
+  clone_button.set_sensitive(true);
+}
+
 /**
  * \brief Triggered when cancel button is clicked
  */
@@ -181,11 +209,13 @@ void BottleCloneWindow::on_clone_button_clicked()
   // Show busy dialog
   busy_dialog.set_message("Clone Windows Machine",
                           "Currently cloning the Windows Machine.\nThis can take a while, depending on the size of the machine.");
+  busy_dialog.set_cancellable(true);
   busy_dialog.show();
 
   // Set the new bottle configuration data for the clone
   clone_bottle_struct.name = name_entry.get_text();
   clone_bottle_struct.folder_name = folder_name_entry.get_text();
   clone_bottle_struct.description = description_text_view.get_buffer()->get_text();
+  clone_bottle_struct.is_overlay = share_files_check.get_active();
   clone_bottle.emit(clone_bottle_struct);
 }
@@ -0,0 +1,368 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_cloner.cc
+ * \brief   Native Wine bottle copy using reflinks or copy_file_range()
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_cloner.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <iostream>
+#include <linux/fs.h>
+#include <mutex>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static const unsigned int MaxCopyWorkers = 8;                       /*!< Upper limit of parallel file copies */
+static const std::size_t CopyChunkSize = 8 * 1024 * 1024;           /*!< Bytes per copy_file_range() call, so a cancel is noticed */
+static const std::size_t ReadBufferSize = 1024 * 1024;              /*!< Buffer size of the read()/write() fallback */
+static const std::chrono::milliseconds ProgressInterval{100};       /*!< Interval between progress reports */
+static const mode_t OwnerPermissions = S_IRUSR | S_IWUSR | S_IXUSR; /*!< Required to fill the created directories */
+
+/**
+ * \brief nftw() callback removing a single file, symlink or (empty) directory
+ */
+static int remove_entry(const char* path, const struct stat*, int, struct FTW*)
+{
+  if (remove(path) != 0)
+  {
+    std::cerr << "Error: Could not remove " << path << ": " << strerror(errno) << std::endl;
+  }
+  return 0; // Continue removing the rest
+}
+
+/**
+ * \brief Write the whole buffer, retrying on partial writes
+ * \return True on success, false on failure (errno is set)
+ */
+static bool write_all(int fd, const char* data, std::size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t written = write(fd, data, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+/**
+ * \brief Copy the source directory tree to the destination path, the destination should not exist yet.
+ * \param[in] source_path Source directory (eg. the current Wine prefix)
+ * \param[in] destination_path Destination directory, which will be created
+ * \param[in] progress Optional progress callback, called from the calling thread with the copied and total number of bytes
+ * \param[in] stop_token Request a stop to cancel the copy
+ * \throws runtime_error when the copy failed, the partial copy is removed again (unless the destination already existed)
+ * \return True when the copy is completed, false when it got cancelled (the partial copy is removed)
+ */
+bool BottleCloner::clone(const std::string& source_path,
+                         const std::string& destination_path,
+                         const ProgressCallback& progress,
+                         std::stop_token stop_token)
+{
+  struct stat source_stat;
+  if (stat(source_path.c_str(), &source_stat) != 0 || !S_ISDIR(source_stat.st_mode))
+  {
+    std::cerr << "Error: Could not clone, source is not a directory: " << source_path << std::endl;
+    throw std::runtime_error("Source is not a directory: " + source_path);
+  }
+  if (mkdir(destination_path.c_str(), (source_stat.st_mode & 07777) | OwnerPermissions) != 0)
+  {
+    std::cerr << "Error: Could not create the destination directory " << destination_path << ": " << strerror(errno) << std::endl;
+    throw std::runtime_error("Could not create the destination directory: " + destination_path + " (" + strerror(errno) + ")");
+  }
+
+  // Internal stop source, stops the workers on either a cancel of the caller or the first copy failure
+  std::stop_source stop_source;
+  std::stop_callback on_cancel(stop_token, [&stop_source] { stop_source.request_stop(); });
+
+  std::vector<FileEntry> files;
+  std::uint64_t bytes_total = 0;
+  std::string error_message;
+  try
+  {
+    copy_tree(source_path, destination_path, files, bytes_total, stop_source.get_token());
+  }
+  catch (const std::runtime_error& error)
+  {
+    error_message = error.what();
+    stop_source.request_stop();
+  }
+
+  std::atomic<std::uint64_t> bytes_copied = 0;
+  std::atomic<std::size_t> next_file = 0;
+  std::mutex mutex;
+  std::condition_variable finished_cv;
+  unsigned int running = std::clamp(std::thread::hardware_concurrency(), 1U, MaxCopyWorkers);
+  running = static_cast<unsigned int>(std::min<std::size_t>(running, stop_source.stop_requested() ? 0 : files.size()));
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < running; ++i)
+  {
+    workers.emplace_back(
+        [&]
+        {
+          std::stop_token worker_stop_token = stop_source.get_token();
+          for (std::size_t index = next_file++; index < files.size() && !worker_stop_token.stop_requested(); index = next_file++)
+          {
+            try
+            {
+              copy_file(files[index], bytes_copied, worker_stop_token);
+            }
+            catch (const std::runtime_error& error)
+            {
+              std::lock_guard<std::mutex> lock(mutex);
+              if (error_message.empty())
+                error_message = error.what();
+              stop_source.request_stop();
+            }
+          }
+          std::lock_guard<std::mutex> lock(mutex);
+          --running;
+          finished_cv.notify_all();
+        });
+  }
+
+  // Report the progress from the calling thread, while the workers are copying
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running > 0)
+    {
+      finished_cv.wait_for(lock, ProgressInterval);
+      if (progress && running > 0)
+      {
+        lock.unlock();
+        progress(bytes_copied, bytes_total);
+        lock.lock();
+      }
+    }
+  }
+  for (std::thread& worker : workers)
+    worker.join();
+
+  if (!error_message.empty())
+  {
+    remove_tree(destination_path);
+    throw std::runtime_error(error_message);
+  }
+  if (stop_source.stop_requested())
+  {
+    remove_tree(destination_path);
+    return false;
+  }
+  if (progress)
+    progress(bytes_total, bytes_total);
+  return true;
+}
+
+/**
+ * \brief Recreate the directories and symbolic links of the source directory in the destination directory (recursively),
+ * and collect the regular files that still need to be copied.
+ * \param[in] source_dir Source directory
+ * \param[in] destination_dir Destination directory (should already exist)
+ * \param[out] files Regular files to copy
+ * \param[out] bytes_total Total size of the collected files
+ * \param[in] stop_token Stops the walk when requested
+ * \throws runtime_error when a directory could not be read or created, or a symbolic link could not be created
+ */
+void BottleCloner::copy_tree(const std::string& source_dir,
+                             const std::string& destination_dir,
+                             std::vector<FileEntry>& files,
+                             std::uint64_t& bytes_total,
+                             std::stop_token stop_token)
+{
+  DIR* dir = opendir(source_dir.c_str());
+  if (dir == nullptr)
+  {
+    std::cerr << "Error: Could not open directory " << source_dir << ": " << strerror(errno) << std::endl;
+    throw std::runtime_error("Could not read directory: " + source_dir + " (" + strerror(errno) + ")");
+  }
+
+  std::vector<std::string> sub_dirs;
+  std::string error_message;
+  while (dirent* entry = readdir(dir))
+  {
+    if (stop_token.stop_requested())
+      break;
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+
+    std::string source = source_dir + "/" + entry->d_name;
+    std::string destination = destination_dir + "/" + entry->d_name;
+    struct stat source_stat;
+    if (fstatat(dirfd(dir), entry->d_name, &source_stat, AT_SYMLINK_NOFOLLOW) != 0)
+    {
+      error_message = "Could not read file information: " + source + " (" + strerror(errno) + ")";
+      break;
+    }
+
+    if (S_ISDIR(source_stat.st_mode))
+    {
+      if (mkdir(destination.c_str(), (source_stat.st_mode & 07777) | OwnerPermissions) != 0)
+      {
+        error_message = "Could not create directory: " + destination + " (" + strerror(errno) + ")";
+        break;
+      }
+      sub_dirs.push_back(entry->d_name);
+    }
+    else if (S_ISLNK(source_stat.st_mode))
+    {
+      // Keep the link target as-is (eg. dosdevices/c: -> ../drive_c), so the clone doesn't point to the source prefix
+      std::string target(static_cast<std::size_t>(source_stat.st_size) + 1, '\0');
+      ssize_t length = readlinkat(dirfd(dir), entry->d_name, target.data(), target.size());
+      if (length < 0 || symlink(target.substr(0, static_cast<std::size_t>(length)).c_str(), destination.c_str()) != 0)
+      {
+        error_message = "Could not copy symbolic link: " + source + " (" + strerror(errno) + ")";
+        break;
+      }
+    }
+    else if (S_ISREG(source_stat.st_mode))
+    {
+      files.push_back({source, destination, source_stat.st_mode & 07777, static_cast<std::uint64_t>(source_stat.st_size)});
+      bytes_total += static_cast<std::uint64_t>(source_stat.st_size);
+    }
+    // Sockets, pipes and device files are skipped
+  }
+  closedir(dir);
+
+  if (!error_message.empty())
+  {
+    std::cerr << "Error: " << error_message << std::endl;
+    throw std::runtime_error(error_message);
+  }
+  for (const std::string& sub_dir : sub_dirs)
+  {
+    if (stop_token.stop_requested())
+      break;
+    copy_tree(source_dir + "/" + sub_dir, destination_dir + "/" + sub_dir, files, bytes_total, stop_token);
+  }
+}
+
+/**
+ * \brief Copy a single regular file, using a reflink when the file system supports it.
+ * \param[in] file File to copy
+ * \param[in,out] bytes_copied Total number of copied bytes (shared between the workers)
+ * \param[in] stop_token Stops the copy when requested, leaving a partial file behind
+ * \throws runtime_error when the file could not be copied
+ */
+void BottleCloner::copy_file(const FileEntry& file, std::atomic<std::uint64_t>& bytes_copied, std::stop_token stop_token)
+{
+  int source_fd = open(file.source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source_fd < 0)
+  {
+    std::cerr << "Error: Could not open " << file.source << ": " << strerror(errno) << std::endl;
+    throw std::runtime_error("Could not open file: " + file.source + " (" + strerror(errno) + ")");
+  }
+  int destination_fd = open(file.destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, file.mode);
+  if (destination_fd < 0)
+  {
+    int error = errno;
+    close(source_fd);
+    std::cerr << "Error: Could not create " << file.destination << ": " << strerror(error) << std::endl;
+    throw std::runtime_error("Could not create file: " + file.destination + " (" + strerror(error) + ")");
+  }
+
+  int error = 0;
+  if (file.size > 0)
+  {
+    // A reflink shares the data blocks (btrfs/XFS), otherwise copy the data
+    if (ioctl(destination_fd, FICLONE, source_fd) == 0)
+      bytes_copied += file.size;
+    else
+      error = copy_data(source_fd, destination_fd, bytes_copied, stop_token);
+  }
+  close(source_fd);
+  if (close(destination_fd) != 0 && error == 0)
+    error = errno;
+
+  if (error != 0)
+  {
+    std::cerr << "Error: Could not copy " << file.source << ": " << strerror(error) << std::endl;
+    throw std::runtime_error("Could not copy file: " + file.source + " (" + strerror(error) + ")");
+  }
+}
+
+/**
+ * \brief Copy the file data in the kernel using copy_file_range(), with a read()/write() fallback
+ * when the file systems don't support it (eg. copying between different file systems on older kernels).
+ * \param[in] source_fd Source file descriptor
+ * \param[in] destination_fd Destination file descriptor
+ * \param[in,out] bytes_copied Total number of copied bytes (shared between the workers)
+ * \param[in] stop_token Stops the copy when requested
+ * \return 0 on success (or stop), otherwise the errno value of the failure
+ */
+int BottleCloner::copy_data(int source_fd, int destination_fd, std::atomic<std::uint64_t>& bytes_copied, std::stop_token stop_token)
+{
+  bool use_copy_file_range = true;
+  std::vector<char> buffer;
+  while (!stop_token.stop_requested())
+  {
+    ssize_t copied;
+    if (use_copy_file_range)
+    {
+      copied = copy_file_range(source_fd, nullptr, destination_fd, nullptr, CopyChunkSize, 0);
+      if (copied < 0 && (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP))
+      {
+        use_copy_file_range = false;
+        continue;
+      }
+    }
+    else
+    {
+      if (buffer.empty())
+        buffer.resize(ReadBufferSize);
+      copied = read(source_fd, buffer.data(), buffer.size());
+      if (copied > 0 && !write_all(destination_fd, buffer.data(), static_cast<std::size_t>(copied)))
+        return errno;
+    }
+
+    if (copied < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return errno;
+    }
+    if (copied == 0)
+      break; // End of file
+    bytes_copied += static_cast<std::uint64_t>(copied);
+  }
+  return 0;
+}
+
+/**
+ * \brief Remove a (partial) copy, without following symbolic links
+ * \param[in] path Directory to remove
+ */
+void BottleCloner::remove_tree(const std::string& path)
+{
+  nftw(path.c_str(), remove_entry, 32, FTW_DEPTH | FTW_PHYS);
+}
@@ -57,6 +57,8 @@ bool BottleConfigFile::write_config_file(const std::string& prefix_path,
   {
     keyfile.set_string("General", "Name", bottle_config.name);
     keyfile.set_string("General", "Description", bottle_config.description);
+    if (!bottle_config.runner.empty())
+      keyfile.set_string("General", "Runner", bottle_config.runner);
     keyfile.set_boolean("Logging", "Enabled", bottle_config.logging_enabled);
     keyfile.set_integer("Logging", "DebugLevel", bottle_config.debug_log_level);
     // Iterate over the key/value environment variable pairs (if present)
@@ -126,6 +128,9 @@ std::tuple<BottleConfigData, std::map<int, ApplicationData>> BottleConfigFile::r
       // Retrieve bottle config
       bottle_config.name = keyfile.get_string("General", "Name");
       bottle_config.description = keyfile.get_string("General", "Description");
+      // Optional: Wine runner pinned to this bottle
+      if (keyfile.has_key("General", "Runner"))
+        bottle_config.runner = keyfile.get_string("General", "Runner");
       bottle_config.logging_enabled = keyfile.get_boolean("Logging", "Enabled");
       bottle_config.debug_log_level = keyfile.get_integer("Logging", "DebugLevel");
 
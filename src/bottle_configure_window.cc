@@ -21,6 +21,7 @@
 #include "bottle_configure_window.h"
 #include "bottle_item.h"
 #include "helper.h"
+#include "winetricks_log.h"
 #include <iostream>
 
 /**
@@ -72,6 +73,9 @@ BottleConfigureWindow::BottleConfigureWindow(Gtk::Window& parent) : active_bottl
   hint_label.set_markup("<big><b>Tip:</b> Hover the mouse over the buttons for more info.</big>");
   hint_label.set_margin_top(8);
   hint_label.set_margin_bottom(4);
+  installed_verbs_label.set_line_wrap(true);
+  installed_verbs_label.set_selectable(true);
+  installed_verbs_label.set_margin_top(8);
 
   first_row_label.set_text("Graphics packages");
   first_row_label.set_attributes(attr_list_label);
@@ -95,6 +99,7 @@ BottleConfigureWindow::BottleConfigureWindow(Gtk::Window& parent) : active_bottl
   configure_grid.attach(third_toolbar, 0, 4, 2, 1);
   configure_grid.attach(fourth_row_label, 0, 5, 2, 1);
   configure_grid.attach(fourth_toolbar, 0, 6, 2, 1);
+  configure_grid.attach(installed_verbs_label, 0, 7, 2, 1);
 
   // TODO: Inform the user to disable desktop effects of the compositor. And set CPU to performance.
 
@@ -199,7 +204,22 @@ void BottleConfigureWindow::reset_active_bottle()
  */
 void BottleConfigureWindow::update_installed()
 {
-  if (is_d3dx9_installed())
+  InstalledPackages installed = get_installed_packages();
+
+  if (!installed.winetricks_verbs.empty())
+  {
+    string verbs;
+    for (const string& verb : installed.winetricks_verbs)
+      verbs += (verbs.empty() ? "" : ", ") + verb;
+    installed_verbs_label.set_markup("<b>Installed with Winetricks:</b> " + Glib::Markup::escape_text(verbs));
+    installed_verbs_label.show();
+  }
+  else
+  {
+    installed_verbs_label.hide();
+  }
+
+  if (installed.d3dx9)
   {
     Gtk::Image* reinstall_d3dx9_image = Gtk::manage(new Gtk::Image());
     reinstall_d3dx9_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -214,7 +234,7 @@ void BottleConfigureWindow::update_installed()
     install_d3dx9_button.set_icon_widget(*install_d3dx9_image);
   }
 
-  if (is_dxvk_installed())
+  if (installed.dxvk)
   {
     Gtk::Image* reinstall_dxvk_image = Gtk::manage(new Gtk::Image());
     reinstall_dxvk_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -229,7 +249,7 @@ void BottleConfigureWindow::update_installed()
     install_dxvk_button.set_icon_widget(*install_dxvk_image);
   }
 
-  if (is_vkd3d_installed())
+  if (installed.vkd3d)
   {
     Gtk::Image* reinstall_vkd3d_image = Gtk::manage(new Gtk::Image());
     reinstall_vkd3d_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -244,7 +264,7 @@ void BottleConfigureWindow::update_installed()
     install_vkd3d_button.set_icon_widget(*install_vkd3d_image);
   }
 
-  if (is_liberation_installed())
+  if (installed.liberation_fonts)
   {
     Gtk::Image* reinstall_liberation_image = Gtk::manage(new Gtk::Image());
     reinstall_liberation_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -259,7 +279,7 @@ void BottleConfigureWindow::update_installed()
     install_liberation_fonts_button.set_icon_widget(*install_liberation_image);
   }
 
-  if (is_core_fonts_installed())
+  if (installed.core_fonts)
   {
     Gtk::Image* reinstall_core_fonts_image = Gtk::manage(new Gtk::Image());
     reinstall_core_fonts_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -275,7 +295,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for Visual C++ 2013
-  if (is_visual_cpp_2013_installed())
+  if (installed.visual_cpp_2013)
   {
     Gtk::Image* reinstall_visual_cpp_2013_image = Gtk::manage(new Gtk::Image());
     reinstall_visual_cpp_2013_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -291,7 +311,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for Visual C++ 2015
-  if (is_visual_cpp_2015_installed())
+  if (installed.visual_cpp_2015)
   {
     Gtk::Image* reinstall_visual_cpp_2015_image = Gtk::manage(new Gtk::Image());
     reinstall_visual_cpp_2015_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -307,7 +327,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for Visual C++ 2017
-  if (is_visual_cpp_2017_installed())
+  if (installed.visual_cpp_2017)
   {
     Gtk::Image* reinstall_visual_cpp_2017_image = Gtk::manage(new Gtk::Image());
     reinstall_visual_cpp_2017_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -323,7 +343,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for Visual C++ 2019
-  if (is_visual_cpp_2019_installed())
+  if (installed.visual_cpp_2019)
   {
     Gtk::Image* reinstall_visual_cpp_2019_image = Gtk::manage(new Gtk::Image());
     reinstall_visual_cpp_2019_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -339,7 +359,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for Visual C++ 2022
-  if (is_visual_cpp_2022_installed())
+  if (installed.visual_cpp_2022)
   {
     Gtk::Image* reinstall_visual_cpp_2022_image = Gtk::manage(new Gtk::Image());
     reinstall_visual_cpp_2022_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -355,7 +375,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for .NET 4.0
-  if (is_dotnet_installed("Microsoft .NET Framework 4 Extended", "Microsoft .NET Framework 4 Extended"))
+  if (installed.dotnet4_0)
   {
     Gtk::Image* reinstall_dotnet4_image = Gtk::manage(new Gtk::Image());
     reinstall_dotnet4_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -371,7 +391,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for .NET 4.5.2
-  if (is_dotnet_installed("{92FB6C44-E685-45AD-9B20-CADF4CABA132}", "Microsoft .NET Framework 4.5.2"))
+  if (installed.dotnet4_5_2)
   {
     Gtk::Image* reinstall_dotnet4_5_2_image = Gtk::manage(new Gtk::Image());
     reinstall_dotnet4_5_2_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -387,7 +407,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for .NET 4.7.2
-  if (is_dotnet_installed("{92FB6C44-E685-45AD-9B20-CADF4CABA132} - 1033", "Microsoft .NET Framework 4.7.2"))
+  if (installed.dotnet4_7_2)
   {
     Gtk::Image* reinstall_dotnet4_7_2_image = Gtk::manage(new Gtk::Image());
     reinstall_dotnet4_7_2_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -403,7 +423,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for .NET 4.8
-  if (is_dotnet_installed("{92FB6C44-E685-45AD-9B20-CADF4CABA132} - 1033", "Microsoft .NET Framework 4.8"))
+  if (installed.dotnet4_8)
   {
     Gtk::Image* reinstall_dotnet4_8_image = Gtk::manage(new Gtk::Image());
     reinstall_dotnet4_8_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -419,7 +439,7 @@ void BottleConfigureWindow::update_installed()
   }
 
   // Check for .NET 6.0 LTS
-  if (is_dotnet_6_installed())
+  if (installed.dotnet6)
   {
     Gtk::Image* reinstall_dotnet6_image = Gtk::manage(new Gtk::Image());
     reinstall_dotnet6_image->set_from_icon_name("view-refresh", Gtk::IconSize(Gtk::ICON_SIZE_LARGE_TOOLBAR));
@@ -438,393 +458,142 @@ void BottleConfigureWindow::update_installed()
 }
 
 /**
- * \brief Check is D3DX9 (DirectX 9 OpenGL) is installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_d3dx9_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native' load order
-      is_installed = Helper::get_dll_override(wine_prefix, "*d3dx9_43");
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check is DXVK (Vulkan based DirectX 9/10/11) is installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_dxvk_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native' load order
-      is_installed = Helper::get_dll_override(wine_prefix, "*dxgi");
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check is VKD3D (Vulkan based DirectX 12) is installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_vkd3d_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native' load order
-      is_installed = Helper::get_dll_override(wine_prefix, "*d3d12");
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if Liberation fonts are installed
- * As fallback: Wine is looking for the liberation font on the local unix system (in the /usr/share/fonts/.. directory)
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_liberation_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    BottleTypes::Bit bit = active_bottle_->bit();
-    try
-    {
-      string fontFilename = Helper::get_font_filename(wine_prefix, bit, "Liberation Mono (TrueType)");
-      is_installed = (fontFilename == "liberationmono-regular.ttf");
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Core fonts are installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_core_fonts_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    BottleTypes::Bit bit = active_bottle_->bit();
-    try
-    {
-      string fontFilename = Helper::get_font_filename(wine_prefix, bit, "Comic Sans MS (TrueType)");
-      is_installed = (fontFilename == "comic.ttf");
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Visual C++ 2013 installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_visual_cpp_2013_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native, builtin' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*msvcp120", DLLOverride::LoadOrder::NativeBuiltin);
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, "{61087a79-ac85-455c-934d-1fa22cc64f36}");
-        // Strings has last occurrence
-        is_installed = (name.rfind("Microsoft Visual C++ 2013 Redistributable") == 0);
-
-        // Try the 64-bit package (fallback)
-        if (!is_installed)
-        {
-          name = Helper::get_uninstaller(wine_prefix, "{ef6b00ec-13e1-4c25-9064-b2f383cb8412}");
-          is_installed = (name.rfind("Microsoft Visual C++ 2013 Redistributable") == 0);
-        }
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Visual C++ 2015 installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_visual_cpp_2015_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native, builtin' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*msvcp140", DLLOverride::LoadOrder::NativeBuiltin);
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, "{462f63a8-6347-4894-a1b3-dbfe3a4c981d}");
-        // Strings has last occurrence
-        is_installed = (name.rfind("Microsoft Visual C++ 2015 Redistributable") == 0);
-
-        // Try the 64-bit package (fallback)
-        if (!is_installed)
-        {
-          name = Helper::get_uninstaller(wine_prefix, "{F20396E5-D84E-3505-A7A8-7358F0155F6C}");
-          is_installed = (name.rfind("Microsoft Visual C++ 2015 Redistributable") == 0);
-        }
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Visual C++ 2017 installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_visual_cpp_2017_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native, builtin' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*msvcp140", DLLOverride::LoadOrder::NativeBuiltin);
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, "{624ba875-fdfc-4efa-9c66-b170dfebc3ec}");
-        // Strings has last occurrence
-        is_installed = (name.rfind("Microsoft Visual C++ 2017 Redistributable") == 0);
-
-        // Try the 64-bit package (fallback)
-        if (!is_installed)
-        {
-          name = Helper::get_uninstaller(wine_prefix, "{65835E57-3712-4382-990A-8D39008A8E0B}");
-          is_installed = (name.rfind("Microsoft Visual C++ 2017") == 0);
-        }
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Visual C++ 2019 installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_visual_cpp_2019_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native, builtin' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*msvcp140", DLLOverride::LoadOrder::NativeBuiltin);
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, "{e3aefa8b-a2ea-42b8-a384-95f2ff6df681}");
-        // Strings has last occurrence
-        is_installed = (name.rfind("Microsoft Visual C++ 2015-2019 Redistributable") == 0);
-
-        // Try the 64-bit package (fallback)
-        if (!is_installed)
-        {
-          name = Helper::get_uninstaller(wine_prefix, "{0F03096E-F81F-48D0-AEE0-9F8513CD883F}");
-          is_installed = (name.rfind("Microsoft Visual C++ 2019") == 0);
-        }
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
-
-/**
- * \brief Check if MS Visual C++ 2022 installed
- * \return True if installed otherwise False
+ * \brief Detect all the packages shown in this window.
+ * The winetricks.log of the bottle is used when available. Packages not found in the log are checked in the registry,
+ * since they could also be installed without winetricks (or by an older winetricks version without log).
+ * \return Installed packages
  */
-bool BottleConfigureWindow::is_visual_cpp_2022_installed()
+BottleConfigureWindow::InstalledPackages BottleConfigureWindow::get_installed_packages()
 {
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native, builtin' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*msvcp140", DLLOverride::LoadOrder::NativeBuiltin);
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, "{2cfeba4a-21f8-4ea7-9927-c5a5c6f13cc9}");
-        // Strings has last occurrence
-        is_installed = (name.rfind("Microsoft Visual C++ 2015-2022 Redistributable") == 0);
-
-        // Try the 64-bit package (fallback)
-        if (!is_installed)
-        {
-          name = Helper::get_uninstaller(wine_prefix, "{1CA7421F-A225-4A9C-B320-A36981A2B789}");
-          is_installed = (name.rfind("Microsoft Visual C++ 2022") == 0);
-        }
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
+  if (active_bottle_ == nullptr)
+    return {};
+
+  std::shared_ptr<const WinetricksLog> winetricks_log;
+  try
+  {
+    winetricks_log = WinetricksLog::open(active_bottle_->wine_location());
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cout << "Error: " << error.what() << std::endl;
+  }
+  if (winetricks_log == nullptr)
+    return get_installed_packages_from_registry();
+
+  InstalledPackages installed = {};
+  installed.d3dx9 = winetricks_log->has_verb("d3dx9") || winetricks_log->has_verb("d3dx9_43");
+  installed.dxvk = winetricks_log->has_verb_with_version("dxvk");
+  installed.vkd3d = winetricks_log->has_verb("vkd3d");
+  installed.liberation_fonts = winetricks_log->has_verb("liberation");
+  installed.core_fonts = winetricks_log->has_verb("corefonts");
+  installed.visual_cpp_2013 = winetricks_log->has_verb("vcrun2013");
+  installed.visual_cpp_2015 = winetricks_log->has_verb("vcrun2015");
+  installed.visual_cpp_2017 = winetricks_log->has_verb("vcrun2017");
+  installed.visual_cpp_2019 = winetricks_log->has_verb("vcrun2019");
+  installed.visual_cpp_2022 = winetricks_log->has_verb("vcrun2022");
+  installed.dotnet4_0 = winetricks_log->has_verb("dotnet40");
+  installed.dotnet4_5_2 = winetricks_log->has_verb("dotnet452");
+  installed.dotnet4_7_2 = winetricks_log->has_verb("dotnet472");
+  installed.dotnet4_8 = winetricks_log->has_verb("dotnet48");
+  installed.dotnet6 = winetricks_log->has_verb("dotnet6") || winetricks_log->has_verb("dotnetdesktop6");
+  installed.winetricks_verbs = winetricks_log->get_verbs();
+
+  bool is_all_installed = installed.d3dx9 && installed.dxvk && installed.vkd3d && installed.liberation_fonts && installed.core_fonts &&
+                          installed.visual_cpp_2013 && installed.visual_cpp_2015 && installed.visual_cpp_2017 && installed.visual_cpp_2019 &&
+                          installed.visual_cpp_2022 && installed.dotnet4_0 && installed.dotnet4_5_2 && installed.dotnet4_7_2 &&
+                          installed.dotnet4_8 && installed.dotnet6;
+  if (!is_all_installed)
+  {
+    // Fallback to the registry for the packages missing in the log
+    InstalledPackages registry = get_installed_packages_from_registry();
+    installed.d3dx9 = installed.d3dx9 || registry.d3dx9;
+    installed.dxvk = installed.dxvk || registry.dxvk;
+    installed.vkd3d = installed.vkd3d || registry.vkd3d;
+    installed.liberation_fonts = installed.liberation_fonts || registry.liberation_fonts;
+    installed.core_fonts = installed.core_fonts || registry.core_fonts;
+    installed.visual_cpp_2013 = installed.visual_cpp_2013 || registry.visual_cpp_2013;
+    installed.visual_cpp_2015 = installed.visual_cpp_2015 || registry.visual_cpp_2015;
+    installed.visual_cpp_2017 = installed.visual_cpp_2017 || registry.visual_cpp_2017;
+    installed.visual_cpp_2019 = installed.visual_cpp_2019 || registry.visual_cpp_2019;
+    installed.visual_cpp_2022 = installed.visual_cpp_2022 || registry.visual_cpp_2022;
+    installed.dotnet4_0 = installed.dotnet4_0 || registry.dotnet4_0;
+    installed.dotnet4_5_2 = installed.dotnet4_5_2 || registry.dotnet4_5_2;
+    installed.dotnet4_7_2 = installed.dotnet4_7_2 || registry.dotnet4_7_2;
+    installed.dotnet4_8 = installed.dotnet4_8 || registry.dotnet4_8;
+    installed.dotnet6 = installed.dotnet6 || registry.dotnet6;
+  }
+  return installed;
 }
 
 /**
- * \brief Check if MS .NET is installed using the uninstaller key & display name.
- * Note: Can not be used to check for .NET 6
- * \param[in] uninstaller_key The uninstaller register key
- * \param[in] uninstaller_name The uninstaller display name
- * \return True if installed otherwise False
+ * \brief Detect all the packages shown in this window using the registry, fallback for packages not in the winetricks.log.
+ * The registry values are collected first, so each registry hive is only looked up once (instead of once per package).
+ * \return Installed packages
  */
-bool BottleConfigureWindow::is_dotnet_installed(const string& uninstaller_key, const string& uninstaller_name)
+BottleConfigureWindow::InstalledPackages BottleConfigureWindow::get_installed_packages_from_registry()
 {
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if DLL is set to 'native' load order
-      bool is_dll_override = Helper::get_dll_override(wine_prefix, "*mscoree");
-      if (is_dll_override)
-      {
-        // Next, check if package can be found to be uninstalled
-        string name = Helper::get_uninstaller(wine_prefix, uninstaller_key);
-        // Check the display name
-        is_installed = (name == uninstaller_name);
-      }
-      else
-      {
-        is_installed = false;
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
+  InstalledPackages installed = {};
+  if (active_bottle_ == nullptr)
+    return installed;
+
+  string wine_prefix = active_bottle_->wine_location();
+  try
+  {
+    const string native = DLLOverride::to_string(DLLOverride::LoadOrder::Native);
+    const string native_builtin = DLLOverride::to_string(DLLOverride::LoadOrder::NativeBuiltin);
+    // DLL overrides (user registry)
+    vector<string> dll_overrides = Helper::get_dll_overrides(wine_prefix, {"*d3dx9_43", "*dxgi", "*d3d12", "*msvcp120", "*msvcp140", "*mscoree"});
+    installed.d3dx9 = (dll_overrides.at(0) == native);
+    installed.dxvk = (dll_overrides.at(1) == native);
+    installed.vkd3d = (dll_overrides.at(2) == native);
+    bool is_msvcp120_override = (dll_overrides.at(3) == native_builtin);
+    bool is_msvcp140_override = (dll_overrides.at(4) == native_builtin);
+    bool is_mscoree_override = (dll_overrides.at(5) == native);
+
+    // Fonts (system registry)
+    // As fallback: Wine is looking for the liberation font on the local unix system (in the /usr/share/fonts/.. directory)
+    vector<string> fonts = Helper::get_font_filenames(wine_prefix, active_bottle_->bit(), {"Liberation Mono (TrueType)", "Comic Sans MS (TrueType)"});
+    installed.liberation_fonts = (fonts.at(0) == "liberationmono-regular.ttf");
+    installed.core_fonts = (fonts.at(1) == "comic.ttf");
+
+    // Uninstaller display names (system registry), the 64-bit packages are used as fallback
+    vector<string> names = Helper::get_uninstallers(wine_prefix, {"{61087a79-ac85-455c-934d-1fa22cc64f36}",
+                                                                  "{ef6b00ec-13e1-4c25-9064-b2f383cb8412}",
+                                                                  "{462f63a8-6347-4894-a1b3-dbfe3a4c981d}",
+                                                                  "{F20396E5-D84E-3505-A7A8-7358F0155F6C}",
+                                                                  "{624ba875-fdfc-4efa-9c66-b170dfebc3ec}",
+                                                                  "{65835E57-3712-4382-990A-8D39008A8E0B}",
+                                                                  "{e3aefa8b-a2ea-42b8-a384-95f2ff6df681}",
+                                                                  "{0F03096E-F81F-48D0-AEE0-9F8513CD883F}",
+                                                                  "{2cfeba4a-21f8-4ea7-9927-c5a5c6f13cc9}",
+                                                                  "{1CA7421F-A225-4A9C-B320-A36981A2B789}",
+                                                                  "Microsoft .NET Framework 4 Extended",
+                                                                  "{92FB6C44-E685-45AD-9B20-CADF4CABA132}",
+                                                                  "{92FB6C44-E685-45AD-9B20-CADF4CABA132} - 1033",
+                                                                  "{5DEFBDBE-FF1A-4EB2-8DFB-17A26A7E6442}",
+                                                                  "{3CC763AD-93B3-41EF-ABF8-CFE63A1DC3A6}"});
+    // Display name should start with the given text
+    auto starts_with = [&names](std::size_t index, const string& text) { return names.at(index).rfind(text, 0) == 0; };
+    installed.visual_cpp_2013 = is_msvcp120_override && (starts_with(0, "Microsoft Visual C++ 2013 Redistributable") ||
+                                                         starts_with(1, "Microsoft Visual C++ 2013 Redistributable"));
+    installed.visual_cpp_2015 = is_msvcp140_override && (starts_with(2, "Microsoft Visual C++ 2015 Redistributable") ||
+                                                         starts_with(3, "Microsoft Visual C++ 2015 Redistributable"));
+    installed.visual_cpp_2017 =
+        is_msvcp140_override && (starts_with(4, "Microsoft Visual C++ 2017 Redistributable") || starts_with(5, "Microsoft Visual C++ 2017"));
+    installed.visual_cpp_2019 =
+        is_msvcp140_override && (starts_with(6, "Microsoft Visual C++ 2015-2019 Redistributable") || starts_with(7, "Microsoft Visual C++ 2019"));
+    installed.visual_cpp_2022 =
+        is_msvcp140_override && (starts_with(8, "Microsoft Visual C++ 2015-2022 Redistributable") || starts_with(9, "Microsoft Visual C++ 2022"));
+    // Note: .NET 6 doesn't use the mscoree DLL override
+    installed.dotnet4_0 = is_mscoree_override && (names.at(10) == "Microsoft .NET Framework 4 Extended");
+    installed.dotnet4_5_2 = is_mscoree_override && (names.at(11) == "Microsoft .NET Framework 4.5.2");
+    installed.dotnet4_7_2 = is_mscoree_override && (names.at(12) == "Microsoft .NET Framework 4.7.2");
+    installed.dotnet4_8 = is_mscoree_override && (names.at(12) == "Microsoft .NET Framework 4.8");
+    installed.dotnet6 = starts_with(13, "Microsoft .NET Runtime - 6") || starts_with(14, "Microsoft .NET Runtime - 6");
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cout << "Error: " << error.what() << std::endl;
+  }
+  return installed;
 }
-
-/**
- * \brief Check if MS .NET v6 is installed
- * \return True if installed otherwise False
- */
-bool BottleConfigureWindow::is_dotnet_6_installed()
-{
-  bool is_installed = false;
-  if (active_bottle_ != nullptr)
-  {
-    Glib::ustring wine_prefix = active_bottle_->wine_location();
-    try
-    {
-      // Check if package can be found to be uninstalled
-      string name = Helper::get_uninstaller(wine_prefix, "{5DEFBDBE-FF1A-4EB2-8DFB-17A26A7E6442}");
-      // Strings has first occurrence of display name
-      is_installed = (name.find("Microsoft .NET Runtime - 6") == 0);
-      // Try the 64-bit package (fallback)
-      if (!is_installed)
-      {
-        name = Helper::get_uninstaller(wine_prefix, "{3CC763AD-93B3-41EF-ABF8-CFE63A1DC3A6}");
-        // Strings has first occurrence of display name
-        is_installed = (name.find("Microsoft .NET Runtime - 6") == 0);
-      }
-    }
-    catch (const std::runtime_error& error)
-    {
-      std::cout << "Error: " << error.what() << std::endl;
-    }
-  }
-  return is_installed;
-}
\ No newline at end of file
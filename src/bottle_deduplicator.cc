@@ -0,0 +1,402 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_deduplicator.cc
+ * \brief   Find identical files across Wine bottles and share their data blocks
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_deduplicator.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <glibmm/checksum.h>
+#include <iostream>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+
+static const std::uint64_t MinFileSize = 4096;                 /*!< Smaller files are skipped, they hardly occupy a data block */
+static const std::uint64_t DedupeChunkSize = 16 * 1024 * 1024; /*!< Bytes per FIDEDUPERANGE call (some file systems limit the range) */
+static const std::size_t ReadBufferSize = 256 * 1024;          /*!< Read buffer size during hashing */
+static const unsigned int MaxHashWorkers = 8;                  /*!< Upper limit of parallel file hashing */
+static const std::uint32_t FiemapExtentCount = 64;             /*!< Extents per FS_IOC_FIEMAP call */
+
+/**
+ * \brief Scan the bottles for identical files (dry-run, nothing is changed on disk)
+ * \param[in] prefix_paths Bottle folders, symbolic links (like dosdevices/z:) and other mounts are not followed
+ * \param[in] stop_token Stops the scan when requested (the report is then incomplete)
+ * \return Report with the groups of identical files and the disk space that could be reclaimed
+ */
+DeduplicationReport BottleDeduplicator::scan(const std::vector<std::string>& prefix_paths, std::stop_token stop_token)
+{
+  DeduplicationReport report;
+  std::vector<FileEntry> files;
+  for (const std::string& prefix_path : prefix_paths)
+  {
+    struct stat prefix_stat;
+    if (stat(prefix_path.c_str(), &prefix_stat) == 0 && S_ISDIR(prefix_stat.st_mode))
+      collect_files(prefix_path, prefix_stat.st_dev, files, stop_token);
+  }
+
+  // Only keep a single path per inode, hardlinks already share their data
+  std::sort(files.begin(), files.end(),
+            [](const FileEntry& a, const FileEntry& b) { return std::tie(a.device, a.size, a.inode) < std::tie(b.device, b.size, b.inode); });
+  files.erase(std::unique(files.begin(), files.end(),
+                          [](const FileEntry& a, const FileEntry& b) { return a.device == b.device && a.inode == b.inode; }),
+              files.end());
+  report.files_scanned = files.size();
+
+  // Files without another file of the same size (on the same file system) can't be a duplicate, skip hashing those
+  std::vector<FileEntry*> candidates;
+  for (std::size_t i = 0; i < files.size(); ++i)
+  {
+    report.bytes_scanned += files[i].size;
+    bool same_as_previous = i > 0 && files[i - 1].device == files[i].device && files[i - 1].size == files[i].size;
+    bool same_as_next = i + 1 < files.size() && files[i + 1].device == files[i].device && files[i + 1].size == files[i].size;
+    if (same_as_previous || same_as_next)
+      candidates.push_back(&files[i]);
+  }
+  compute_checksums(candidates, stop_token);
+  if (stop_token.stop_requested())
+    return report;
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const FileEntry* a, const FileEntry* b)
+            { return std::tie(a->device, a->size, a->checksum, a->path) < std::tie(b->device, b->size, b->checksum, b->path); });
+  for (std::size_t begin = 0; begin < candidates.size();)
+  {
+    std::size_t end = begin + 1;
+    while (end < candidates.size() && candidates[end]->device == candidates[begin]->device && candidates[end]->size == candidates[begin]->size &&
+           candidates[end]->checksum == candidates[begin]->checksum)
+      ++end;
+    // An empty checksum means the file could not be read
+    if (end - begin > 1 && !candidates[begin]->checksum.empty())
+    {
+      // The first file is the source, files already sharing its data blocks (eg. deduplicated before) don't reclaim anything
+      DuplicateGroup group{candidates[begin]->size, {candidates[begin]->path}};
+      std::vector<Extent> source_extents;
+      bool has_source_extents = get_extents(group.paths.front(), group.size, source_extents);
+      std::uint64_t bytes_reclaimable = 0;
+      for (std::size_t i = begin + 1; i < end; ++i)
+      {
+        std::vector<Extent> extents;
+        std::uint64_t bytes_shared = 0;
+        if (has_source_extents && get_extents(candidates[i]->path, group.size, extents))
+          bytes_shared = get_shared_bytes(source_extents, extents);
+        if (bytes_shared >= group.size)
+          continue;
+        group.paths.push_back(candidates[i]->path);
+        bytes_reclaimable += group.size - bytes_shared;
+      }
+      if (group.paths.size() > 1)
+      {
+        report.files_duplicate += group.paths.size() - 1;
+        report.bytes_reclaimable += bytes_reclaimable;
+        report.groups.push_back(std::move(group));
+      }
+    }
+    begin = end;
+  }
+  return report;
+}
+
+/**
+ * \brief Let the identical files of the report share their data blocks (the first file of each group is the source).
+ * Files changed after the scan are skipped by the kernel.
+ * \param[in] report Scan report
+ * \param[in] stop_token Stops deduplicating when requested (files already done stay deduplicated)
+ * \return Result, is_supported is false when the file system doesn't support deduplication (eg. ext4)
+ */
+DeduplicationResult BottleDeduplicator::deduplicate(const DeduplicationReport& report, std::stop_token stop_token)
+{
+  DeduplicationResult result;
+  for (const DuplicateGroup& group : report.groups)
+  {
+    if (stop_token.stop_requested() || !result.is_supported)
+      break;
+    int source_fd = open(group.paths.front().c_str(), O_RDONLY | O_CLOEXEC);
+    if (source_fd < 0)
+    {
+      result.error_messages.push_back(group.paths.front() + ": " + strerror(errno));
+      continue;
+    }
+    std::vector<Extent> source_extents;
+    bool has_source_extents = get_extents(source_fd, group.size, source_extents);
+    for (std::size_t i = 1; i < group.paths.size() && !stop_token.stop_requested(); ++i)
+    {
+      const std::string& path = group.paths[i];
+      // A read-only descriptor is sufficient for files owned by the user, but older kernels require write access
+      int destination_fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+      if (destination_fd < 0)
+        destination_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (destination_fd < 0)
+      {
+        result.error_messages.push_back(path + ": " + strerror(errno));
+        continue;
+      }
+      // Only count the data blocks which were not shared yet (the kernel reports the whole range as deduplicated)
+      std::vector<Extent> extents;
+      bool has_extents = has_source_extents && get_extents(destination_fd, group.size, extents);
+      std::uint64_t bytes_shared_before = has_extents ? get_shared_bytes(source_extents, extents) : 0;
+      if (bytes_shared_before >= group.size)
+      {
+        close(destination_fd);
+        continue;
+      }
+      std::uint64_t bytes_deduplicated = 0;
+      int error = deduplicate_file(source_fd, destination_fd, group.size, bytes_deduplicated);
+      if (error == 0 && has_extents && get_extents(destination_fd, group.size, extents))
+      {
+        std::uint64_t bytes_shared_after = get_shared_bytes(source_extents, extents);
+        bytes_deduplicated = (bytes_shared_after > bytes_shared_before) ? bytes_shared_after - bytes_shared_before : 0;
+      }
+      close(destination_fd);
+      if (error == EOPNOTSUPP || error == EINVAL || error == ENOTTY)
+      {
+        std::cerr << "Error: File system doesn't support deduplication: " << path << std::endl;
+        result.is_supported = false;
+        break;
+      }
+      if (error != 0)
+      {
+        std::cerr << "Error: Could not deduplicate " << path << ": " << strerror(error) << std::endl;
+        result.error_messages.push_back(path + ": " + strerror(error));
+      }
+      else if (bytes_deduplicated > 0)
+      {
+        result.files_deduplicated++;
+        result.bytes_deduplicated += bytes_deduplicated;
+      }
+    }
+    close(source_fd);
+  }
+  return result;
+}
+
+/**
+ * \brief Collect the regular files of a directory (recursively), without following symbolic links or crossing mounts
+ * \param[in] dir_path Directory
+ * \param[in] device Device of the bottle folder, directories on other devices are skipped
+ * \param[in,out] files Found files
+ * \param[in] stop_token Stops the walk when requested
+ */
+void BottleDeduplicator::collect_files(const std::string& dir_path, dev_t device, std::vector<FileEntry>& files, std::stop_token stop_token)
+{
+  DIR* dir = opendir(dir_path.c_str());
+  if (dir == nullptr)
+    return;
+  std::vector<std::string> sub_dirs;
+  while (dirent* entry = readdir(dir))
+  {
+    if (stop_token.stop_requested())
+      break;
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    struct stat entry_stat;
+    if (fstatat(dirfd(dir), entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW) != 0 || entry_stat.st_dev != device)
+      continue;
+    std::string path = dir_path + "/" + entry->d_name;
+    if (S_ISDIR(entry_stat.st_mode))
+      sub_dirs.push_back(std::move(path));
+    else if (S_ISREG(entry_stat.st_mode) && static_cast<std::uint64_t>(entry_stat.st_size) >= MinFileSize)
+      files.push_back({std::move(path), entry_stat.st_dev, entry_stat.st_ino, static_cast<std::uint64_t>(entry_stat.st_size), ""});
+  }
+  closedir(dir);
+  for (const std::string& sub_dir : sub_dirs)
+    collect_files(sub_dir, device, files, stop_token);
+}
+
+/**
+ * \brief Compute the checksums of the files using multiple threads
+ * \param[in,out] files Files, the checksum of each file is set (empty when the file could not be read)
+ * \param[in] stop_token Stops hashing when requested
+ */
+void BottleDeduplicator::compute_checksums(std::vector<FileEntry*>& files, std::stop_token stop_token)
+{
+  std::atomic<std::size_t> next_file = 0;
+  unsigned int worker_count = std::clamp(std::thread::hardware_concurrency(), 1U, MaxHashWorkers);
+  worker_count = static_cast<unsigned int>(std::min<std::size_t>(worker_count, files.size()));
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < worker_count; ++i)
+  {
+    workers.emplace_back(
+        [&files, &next_file, &stop_token]
+        {
+          for (std::size_t index = next_file++; index < files.size() && !stop_token.stop_requested(); index = next_file++)
+            files[index]->checksum = compute_checksum(files[index]->path, stop_token);
+        });
+  }
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+/**
+ * \brief Compute the SHA-256 checksum of the file contents
+ * \param[in] path File path
+ * \param[in] stop_token Stops reading when requested
+ * \return Checksum, or empty string when the file could not be read (completely)
+ */
+std::string BottleDeduplicator::compute_checksum(const std::string& path, std::stop_token stop_token)
+{
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return "";
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  Glib::Checksum checksum(Glib::Checksum::CHECKSUM_SHA256);
+  std::vector<guchar> buffer(ReadBufferSize);
+  ssize_t length;
+  while ((length = read(fd, buffer.data(), buffer.size())) != 0)
+  {
+    if (length < 0 && errno == EINTR)
+      continue;
+    if (length < 0 || stop_token.stop_requested())
+    {
+      close(fd);
+      return "";
+    }
+    checksum.update(buffer.data(), static_cast<gsize>(length));
+  }
+  close(fd);
+  return checksum.get_string();
+}
+
+/**
+ * \brief Share the data blocks of the source file with the destination file (FIDEDUPERANGE),
+ * the kernel only shares ranges with identical contents
+ * \param[in] source_fd Source file descriptor
+ * \param[in] destination_fd Destination file descriptor
+ * \param[in] size File size in bytes
+ * \param[out] bytes_deduplicated Number of bytes now shared
+ * \return 0 on success (or when the contents differ), otherwise the errno value of the failure
+ */
+int BottleDeduplicator::deduplicate_file(int source_fd, int destination_fd, std::uint64_t size, std::uint64_t& bytes_deduplicated)
+{
+  // file_dedupe_range has a flexible array member, allocate room for a single destination (64-bit aligned)
+  std::vector<std::uint64_t> buffer((sizeof(file_dedupe_range) + sizeof(file_dedupe_range_info) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+  auto* range = reinterpret_cast<file_dedupe_range*>(buffer.data());
+  std::uint64_t offset = 0;
+  while (offset < size)
+  {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    range->src_offset = offset;
+    range->src_length = std::min(DedupeChunkSize, size - offset);
+    range->dest_count = 1;
+    range->info[0].dest_fd = destination_fd;
+    range->info[0].dest_offset = offset;
+    if (ioctl(source_fd, FIDEDUPERANGE, range) != 0)
+      return errno;
+    if (range->info[0].status < 0)
+      return -range->info[0].status;
+    if (range->info[0].status == FILE_DEDUPE_RANGE_DIFFERS || range->info[0].bytes_deduped == 0)
+      break; // Changed since the scan
+    offset += range->info[0].bytes_deduped;
+    bytes_deduplicated += range->info[0].bytes_deduped;
+  }
+  return 0;
+}
+
+/**
+ * \brief Get the extents of the file data on disk (FIEMAP). Extents without a fixed location on disk (inline data,
+ * delayed allocation, unknown location) are left out, since these can't be shared.
+ * \param[in] fd File descriptor
+ * \param[in] size File size in bytes, the extents are limited to the file size
+ * \param[out] extents Extents sorted by file offset
+ * \return true on success, false when the file system doesn't support FIEMAP
+ */
+bool BottleDeduplicator::get_extents(int fd, std::uint64_t size, std::vector<Extent>& extents)
+{
+  extents.clear();
+  // fiemap has a flexible array member, allocate room for a number of extents per call (64-bit aligned)
+  std::vector<std::uint64_t> buffer((sizeof(fiemap) + FiemapExtentCount * sizeof(fiemap_extent) + sizeof(std::uint64_t) - 1) /
+                                    sizeof(std::uint64_t));
+  auto* map = reinterpret_cast<fiemap*>(buffer.data());
+  std::uint64_t offset = 0;
+  bool is_last = false;
+  while (!is_last && offset < size)
+  {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    map->fm_start = offset;
+    map->fm_length = size - offset;
+    map->fm_extent_count = FiemapExtentCount;
+    if (ioctl(fd, FS_IOC_FIEMAP, map) != 0)
+      return false;
+    if (map->fm_mapped_extents == 0)
+      break;
+    for (std::uint32_t i = 0; i < map->fm_mapped_extents; ++i)
+    {
+      const fiemap_extent& extent = map->fm_extents[i];
+      is_last = (extent.fe_flags & FIEMAP_EXTENT_LAST) != 0;
+      offset = extent.fe_logical + extent.fe_length;
+      if ((extent.fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC | FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_NOT_ALIGNED)) != 0 ||
+          extent.fe_logical >= size)
+        continue;
+      extents.push_back({extent.fe_logical, extent.fe_physical, std::min<std::uint64_t>(extent.fe_length, size - extent.fe_logical)});
+    }
+  }
+  return true;
+}
+
+/**
+ * \brief Get the extents of the file data on disk, see get_extents(int, std::uint64_t, std::vector<Extent>&)
+ * \param[in] path File path
+ * \param[in] size File size in bytes
+ * \param[out] extents Extents sorted by file offset
+ * \return true on success, false when the file could not be opened or the file system doesn't support FIEMAP
+ */
+bool BottleDeduplicator::get_extents(const std::string& path, std::uint64_t size, std::vector<Extent>& extents)
+{
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  bool is_success = get_extents(fd, size, extents);
+  close(fd);
+  return is_success;
+}
+
+/**
+ * \brief Count the bytes of the destination file using the same data blocks on disk as the same range of the source file
+ * \param[in] source_extents Extents of the source file (sorted by file offset)
+ * \param[in] destination_extents Extents of the destination file (sorted by file offset)
+ * \return Number of shared bytes
+ */
+std::uint64_t BottleDeduplicator::get_shared_bytes(const std::vector<Extent>& source_extents, const std::vector<Extent>& destination_extents)
+{
+  std::uint64_t bytes_shared = 0;
+  std::size_t source_index = 0;
+  std::size_t destination_index = 0;
+  while (source_index < source_extents.size() && destination_index < destination_extents.size())
+  {
+    const Extent& source = source_extents[source_index];
+    const Extent& destination = destination_extents[destination_index];
+    std::uint64_t begin = std::max(source.logical, destination.logical);
+    std::uint64_t end = std::min(source.logical + source.length, destination.logical + destination.length);
+    // Overlapping file range, shared when both map the range to the same location on disk
+    if (begin < end && source.physical + destination.logical == destination.physical + source.logical)
+      bytes_shared += end - begin;
+    if (source.logical + source.length <= destination.logical + destination.length)
+      ++source_index;
+    else
+      ++destination_index;
+  }
+  return bytes_shared;
+}
@@ -47,6 +47,7 @@ BottleItem::BottleItem(const BottleItem& bottle_item) : BottleItem()
     win_ = bottle_item.windows();
     bit_ = bottle_item.bit();
     wine_version_ = bottle_item.wine_version();
+    runner_ = bottle_item.runner();
     is_wine64_bit_ = bottle_item.is_wine64_bit();
     wine_location_ = bottle_item.wine_location();
     wine_c_drive_ = bottle_item.wine_c_drive();
@@ -132,42 +133,17 @@ BottleItem::BottleItem(Glib::ustring& name,
 
 void BottleItem::CreateUI()
 {
-  // To lower case
-  std::string windows_str = BottleItem::str_tolower(BottleTypes::to_string(this->windows()));
-  // Remove spaces
-  windows_str.erase(std::remove_if(std::begin(windows_str), std::end(windows_str), [l = std::locale{}](auto ch) { return std::isspace(ch, l); }),
-                    end(windows_str));
-  Glib::ustring bit_str = BottleTypes::to_string(this->bit());
-  Glib::ustring filename_str = windows_str + "_" + bit_str + ".png";
-  Glib::ustring name_str = this->name();
-  Glib::ustring folder_name_str = this->folder_name();
-  Glib::ustring name_label_text = (!name_str.empty()) ? name_str : folder_name_str; // Fallback to folder name
-  bool is_status = this->status();
-
   // Set left side of the GUI
-  image.set(Helper::get_image_location("windows/" + filename_str));
   image.set_margin_top(8);
   image.set_margin_end(8);
   image.set_margin_bottom(8);
   image.set_margin_start(8);
 
   name_label.set_xalign(0.0);
-  name_label.set_markup("<span size=\"medium\"><b>" + Glib::Markup::escape_text(name_label_text) + "</b></span>");
 
-  Glib::ustring status_text = "Ready";
-  if (is_status)
-  {
-    status_icon.set(Helper::get_image_location("ready.png"));
-  }
-  else
-  {
-    status_text = "Not Ready";
-    status_icon.set(Helper::get_image_location("not_ready.png"));
-  }
   status_icon.set_size_request(2, -1);
   status_icon.set_halign(Gtk::Align::ALIGN_START);
 
-  status_label.set_text(status_text);
   status_label.set_xalign(0.0);
 
   grid.set_column_spacing(8);
@@ -182,10 +158,45 @@ void BottleItem::CreateUI()
   grid.attach(status_icon, 1, 1, 1, 1);
   grid.attach_next_to(status_label, status_icon, Gtk::PositionType::POS_RIGHT, 1, 1);
 
+  update_ui();
+
   // Finally at the grid to the ListBoxRow
   add(grid);
 }
 
+/**
+ * \brief Update the widgets of the listbox item with the current bottle data (eg. after the bottle is changed on disk)
+ */
+void BottleItem::update_ui()
+{
+  // To lower case
+  std::string windows_str = BottleItem::str_tolower(BottleTypes::to_string(this->windows()));
+  // Remove spaces
+  windows_str.erase(std::remove_if(std::begin(windows_str), std::end(windows_str), [l = std::locale{}](auto ch) { return std::isspace(ch, l); }),
+                    end(windows_str));
+  Glib::ustring bit_str = BottleTypes::to_string(this->bit());
+  Glib::ustring filename_str = windows_str + "_" + bit_str + ".png";
+  Glib::ustring name_str = this->name();
+  Glib::ustring folder_name_str = this->folder_name();
+  Glib::ustring name_label_text = (!name_str.empty()) ? name_str : folder_name_str; // Fallback to folder name
+  bool is_status = this->status();
+
+  image.set(Helper::get_image_location("windows/" + filename_str));
+  name_label.set_markup("<span size=\"medium\"><b>" + Glib::Markup::escape_text(name_label_text) + "</b></span>");
+
+  Glib::ustring status_text = "Ready";
+  if (is_status)
+  {
+    status_icon.set(Helper::get_image_location("ready.png"));
+  }
+  else
+  {
+    status_text = "Not Ready";
+    status_icon.set(Helper::get_image_location("not_ready.png"));
+  }
+  status_label.set_text(status_text);
+}
+
 /**
  * \brief String to lower string helper method
  * \param[in] string that needs lower case
@@ -19,17 +19,33 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "bottle_manager.h"
+#include "bottle_cache_file.h"
 #include "bottle_config_file.h"
 #include "bottle_item.h"
+#include "bottle_remover.h"
 #include "dll_override_types.h"
 #include "general_config_file.h"
 #include "helper.h"
 #include "main_window.h"
+#include "overlay_bottle.h"
 #include "signal_controller.h"
 #include "wine_defaults.h"
+#include "wine_runtime.h"
+#include "wine_registry_writer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <stdexcept>
+#include <sys/wait.h>
+
+static const unsigned int BottleRefreshDelay = 500; /*!< Delay in ms before refreshing bottles changed on disk (collects multiple events) */
+static const unsigned int MaxScanThreads = 8;       /*!< Maximum number of worker threads used to scan the bottles (mainly disk I/O bound) */
+static const unsigned int MaxTaskWorkers = 16;      /*!< Maximum number of installs/maintenance tasks running at the same time, more are queued */
+static const unsigned int MaxBatchWorkers = 16;     /*!< Maximum number of bottles of a batch operation handled at the same time */
+
+static const Glib::ustring TaskQueuedMessage = "Queued, waiting until other tasks are finished."; /*!< Shown when all the task workers are busy */
 
 /*************************************************************
  * Public member functions                                   *
@@ -41,20 +57,35 @@
  */
 BottleManager::BottleManager(MainWindow& main_window)
     : error_message_mutex_(),
-      output_loging_mutex_(),
       error_message_winetricks_mutex_(),
+      task_executor_(MaxTaskWorkers),
+      batch_executor_(MaxBatchWorkers),
       main_window_(main_window),
       active_bottle_(nullptr),
       is_wine64_bit_(false),
       is_logging_stderr_(true),
+      batch_parallelism_(4),
+      bottles_update_counter_(0),
+      scan_bottles_update_counter_(0),
       error_message_(),
-      error_message_winetricks_()
+      error_message_winetricks_(),
+      is_deduplicating_(false),
+      is_batch_running_(false),
+      batch_total_(0),
+      batch_done_(0)
 {
   // Connect internal dispatcher(s)
   update_bottles_dispatcher_.connect(sigc::bind(sigc::mem_fun(this, &BottleManager::update_config_and_bottles), "", false));
-  write_log_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::write_log_to_file));
   error_message_winetricks_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_error_winetricks));
   winetricks_finished_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::cleanup_install_update_winetricks_thread));
+  scan_bottles_finished_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_scan_bottles_finished));
+  deduplicate_scan_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_deduplicate_scan_finished));
+  deduplicate_finished_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_deduplicate_finished));
+  remove_progress_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_remove_progress));
+  batch_progress_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_batch_progress));
+  batch_finished_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_batch_finished));
+  refresh_bottle_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_refresh_bottle_finished));
+  task_error_dispatcher_.connect(sigc::mem_fun(this, &BottleManager::on_task_error));
 }
 
 /**
@@ -62,8 +93,13 @@ BottleManager::BottleManager(MainWindow& main_window)
  */
 BottleManager::~BottleManager()
 {
-  // Avoid zombie thread
+  // Avoid zombie threads, stop waiting for the running installs (the programs itself keep running)
+  task_executor_.shutdown();
+  batch_executor_.shutdown();
   this->cleanup_install_update_winetricks_thread();
+  this->cleanup_scan_bottles_thread();
+  bottle_list_changed_timeout_.disconnect();
+  bottles_changed_timeout_.disconnect();
 }
 
 /**
@@ -82,26 +118,26 @@ void BottleManager::prepare()
     install_or_update_winetricks_thread(false);
   }
 
-  // Start the initial read from disk to fetch the bottles & update GUI
-  // "" - during startup (no bottle name to select)
-  // true - during startup
-  // TODO: Run in thread, not blocking the main thread
-  update_config_and_bottles("", true);
-}
+  // Read general & save config in bottle manager
+  GeneralConfigData config_data = load_and_save_general_config();
+  // Set main window about the general config data
+  main_window_.set_general_config(config_data);
 
-/**
- * \brief Write debugging logging to file handler
- */
-void BottleManager::write_log_to_file()
-{
-  std::lock_guard<std::mutex> lock(error_message_mutex_);
-  char last_char = output_logging_.back();
-  // Needs new line at end of string?
-  if (last_char != '\n')
+  // Resume removing the bottles which were still being removed when WineGUI stopped
+  // (the default Wine machine ~/.wine is moved to the trash within the home directory, the overlays within the overlays directory)
+  std::vector<string> trash_dirs{bottle_location_, OverlayBottle::get_overlays_directory()};
+  if (Glib::get_home_dir() != bottle_location_)
+    trash_dirs.push_back(Glib::get_home_dir());
+  for (const string& dir_path : trash_dirs)
   {
-    output_logging_ += '\n';
+    for (const string& trash_path : BottleRemover::find_trash(dir_path))
+      remove_trash(trash_path);
   }
-  Helper::write_to_log_file(logging_bottle_prefix_, output_logging_);
+
+  // Start the initial read from disk to fetch the bottles within a thread (async),
+  // the main window shows placeholder rows until the bottles are scanned.
+  main_window_.show_bottle_placeholders();
+  scan_bottles_thread();
 }
 
 /**
@@ -129,6 +165,262 @@ void BottleManager::on_error_winetricks()
   }
 }
 
+/**
+ * \brief Helper method for cleaning the bottle scan thread.
+ */
+void BottleManager::cleanup_scan_bottles_thread()
+{
+  if (thread_scan_bottles_ && thread_scan_bottles_->joinable())
+  {
+    thread_scan_bottles_->join();
+    thread_scan_bottles_.reset();
+  }
+}
+
+/**
+ * \brief Signal handler when the bottle scan thread is completed, update the GUI with the scanned bottles
+ */
+void BottleManager::on_scan_bottles_finished()
+{
+  this->cleanup_scan_bottles_thread();
+
+  BottleListScanData scan_result;
+  {
+    std::lock_guard<std::mutex> lock(scan_result_mutex_);
+    scan_result = std::move(scan_result_);
+  }
+  // Skip the result if the bottle list got already updated in the meantime (eg. by a refresh), the scan result is outdated
+  if (scan_bottles_update_counter_ != bottles_update_counter_)
+    return;
+  // "" - during startup (no bottle name to select)
+  // false - the window is already shown, so the first bottle needs to be selected explicitly
+  set_bottles(scan_result, "", false);
+}
+
+/**
+ * \brief Signal handler when the duplicate files scan is completed, ask the user to deduplicate the files
+ */
+void BottleManager::on_deduplicate_scan_finished()
+{
+  main_window_.close_busy_dialog();
+  DeduplicationReport report;
+  {
+    std::lock_guard<std::mutex> lock(deduplicate_mutex_);
+    report = deduplicate_report_;
+  }
+  if (report.bytes_reclaimable == 0)
+  {
+    is_deduplicating_ = false;
+    main_window_.show_info_message("No duplicate files found in the " + std::to_string(report.files_scanned) + " scanned files.");
+    return;
+  }
+
+  Glib::ustring confirm_message = "Found <b>" + std::to_string(report.files_duplicate) + "</b> duplicate files across the machines, <b>" +
+                                  Glib::format_size(report.bytes_reclaimable) + "</b> of disk space can be reclaimed (scanned " +
+                                  Glib::format_size(report.bytes_scanned) + ").\n\nDeduplicate the files now?\n\n" +
+                                  "<i>Note:</i> The identical files will share their data on disk, " +
+                                  "each machine can still change its own file (copy-on-write).";
+  if (!main_window_.show_confirm_dialog(confirm_message, true))
+  {
+    is_deduplicating_ = false;
+    return;
+  }
+
+  main_window_.show_busy_dialog("Deduplicate Windows Machines", "Sharing the data of the identical files.");
+  task_executor_.submit(
+      [this, report = std::move(report)](std::stop_token stop_token)
+      {
+        DeduplicationResult result = BottleDeduplicator::deduplicate(report, stop_token);
+        {
+          std::lock_guard<std::mutex> lock(deduplicate_mutex_);
+          deduplicate_result_ = std::move(result);
+        }
+        deduplicate_finished_dispatcher_.emit();
+      });
+}
+
+/**
+ * \brief Signal handler when the deduplication is completed, report the result to the user
+ */
+void BottleManager::on_deduplicate_finished()
+{
+  main_window_.close_busy_dialog();
+  is_deduplicating_ = false;
+  DeduplicationResult result;
+  {
+    std::lock_guard<std::mutex> lock(deduplicate_mutex_);
+    result = deduplicate_result_;
+  }
+  if (!result.is_supported)
+  {
+    main_window_.show_error_message("The file system of the machines doesn't support sharing data between files (deduplication).\n"
+                                    "Deduplication is supported on btrfs and XFS.");
+  }
+  else if (!result.error_messages.empty())
+  {
+    main_window_.show_error_message("Deduplicated " + std::to_string(result.files_deduplicated) + " files (" +
+                                    Glib::format_size(result.bytes_deduplicated) + "), but " + std::to_string(result.error_messages.size()) +
+                                    " files failed:\n" + result.error_messages.front());
+  }
+  else
+  {
+    main_window_.show_info_message("Deduplicated " + std::to_string(result.files_deduplicated) + " files, " +
+                                   Glib::format_size(result.bytes_deduplicated) + " of disk space is reclaimed.");
+  }
+}
+
+/**
+ * \brief Signal handler when the progress of a bottle removal changed, show the overall progress in the main window
+ */
+void BottleManager::on_remove_progress()
+{
+  std::size_t bottle_count;
+  double fraction_sum = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(remove_progress_mutex_);
+    bottle_count = remove_progress_.size();
+    for (const auto& [trash_path, fraction] : remove_progress_)
+      fraction_sum += fraction;
+  }
+  if (bottle_count == 0)
+  {
+    main_window_.hide_remove_progress();
+  }
+  else
+  {
+    Glib::ustring text = (bottle_count == 1) ? "Removing Windows Machine..." : "Removing " + std::to_string(bottle_count) + " Windows Machines...";
+    main_window_.show_remove_progress(text, fraction_sum / static_cast<double>(bottle_count));
+  }
+}
+
+/**
+ * \brief Signal handler when a bottle of the batch operation is finished, update the progress in the busy dialog
+ */
+void BottleManager::on_batch_progress()
+{
+  std::lock_guard<std::mutex> lock(batch_mutex_);
+  if (is_batch_running_ && batch_total_ > 0)
+    main_window_.set_busy_dialog_progress(static_cast<double>(batch_done_) / static_cast<double>(batch_total_));
+}
+
+/**
+ * \brief Signal handler when all the bottles of the batch operation are finished, report the aggregated result to the user
+ */
+void BottleManager::on_batch_finished()
+{
+  main_window_.close_busy_dialog();
+  Glib::ustring heading;
+  std::size_t total;
+  std::size_t done;
+  std::vector<Glib::ustring> errors;
+  std::function<void()> finished;
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    is_batch_running_ = false;
+    heading = batch_heading_;
+    total = batch_total_;
+    done = batch_done_;
+    errors = std::move(batch_errors_);
+    finished = std::move(batch_finished_);
+  }
+  if (finished)
+    finished();
+
+  Glib::ustring message = heading + ": " + std::to_string(done - errors.size()) + " of " + std::to_string(total) + " machines succeeded.";
+  if (done < total)
+    message += "\nCancelled, " + std::to_string(total - done) + " machines are skipped.";
+  if (!errors.empty())
+  {
+    message += "\n\nFailed machines:";
+    for (const Glib::ustring& error : errors)
+      message += "\n" + error;
+    main_window_.show_warning_message(message);
+  }
+  else
+  {
+    main_window_.show_info_message(message);
+  }
+}
+
+/**
+ * \brief Signal handler when a file or directory got added/removed in the bottle location
+ * \param[in] file The changed file or directory
+ * \param[in] other_file Unused
+ * \param[in] event_type File monitor event
+ */
+void BottleManager::on_bottle_location_changed(const Glib::RefPtr<Gio::File>& file,
+                                               const Glib::RefPtr<Gio::File>& /*other_file*/,
+                                               Gio::FileMonitorEvent event_type)
+{
+  // Removed bottles are renamed to a trash folder first, the trash is not shown
+  if (BottleRemover::is_trash(file->get_basename()))
+    return;
+  bool is_bottle_list_changed = false;
+  if (event_type == Gio::FILE_MONITOR_EVENT_CREATED)
+    is_bottle_list_changed = Helper::dir_exists(file->get_path());
+  else if (event_type == Gio::FILE_MONITOR_EVENT_DELETED)
+    is_bottle_list_changed = bottle_monitors_.contains(file->get_path());
+
+  if (is_bottle_list_changed)
+  {
+    // Restart the timer, so multiple events result into a single refresh of the bottle list
+    bottle_list_changed_timeout_.disconnect();
+    bottle_list_changed_timeout_ =
+        Glib::signal_timeout().connect(sigc::mem_fun(*this, &BottleManager::on_bottle_list_changed_timeout), BottleRefreshDelay);
+  }
+}
+
+/**
+ * \brief Signal handler when a file changed within a bottle prefix
+ * \param[in] file The changed file
+ * \param[in] other_file Unused
+ * \param[in] event_type File monitor event
+ * \param[in] prefix_path Bottle prefix of the monitor
+ */
+void BottleManager::on_bottle_changed(const Glib::RefPtr<Gio::File>& file,
+                                      const Glib::RefPtr<Gio::File>& /*other_file*/,
+                                      Gio::FileMonitorEvent event_type,
+                                      const string& prefix_path)
+{
+  static const std::set<string> bottle_files{"user.reg", "system.reg", ".update-timestamp", "winegui.ini"};
+  if (event_type != Gio::FILE_MONITOR_EVENT_CHANGES_DONE_HINT && event_type != Gio::FILE_MONITOR_EVENT_CREATED &&
+      event_type != Gio::FILE_MONITOR_EVENT_DELETED)
+    return;
+  if (!bottle_files.contains(file->get_basename()))
+    return;
+
+  changed_bottles_.insert(prefix_path);
+  // Restart the timer, so multiple events result into a single refresh of the bottle
+  bottles_changed_timeout_.disconnect();
+  bottles_changed_timeout_ = Glib::signal_timeout().connect(sigc::mem_fun(*this, &BottleManager::on_bottles_changed_timeout), BottleRefreshDelay);
+}
+
+/**
+ * \brief Timeout handler, rescan the whole bottle list after bottles got added/removed
+ * \return false, run only once
+ */
+bool BottleManager::on_bottle_list_changed_timeout()
+{
+  this->update_config_and_bottles("", false);
+  return false;
+}
+
+/**
+ * \brief Timeout handler, refresh only the bottles which are changed on disk
+ * \return false, run only once
+ */
+bool BottleManager::on_bottles_changed_timeout()
+{
+  std::set<string> changed_bottles;
+  changed_bottles.swap(changed_bottles_);
+  for (BottleItem& bottle : bottles_)
+  {
+    if (changed_bottles.contains(bottle.wine_location()))
+      refresh_bottle(bottle);
+  }
+  return false;
+}
+
 /**
  * \brief Install or self-update Winetricks within a thread.
  * \param install True to install/update winetricks, false to self-update
@@ -170,6 +462,48 @@ void BottleManager::install_or_update_winetricks_thread(bool install)
   }
 }
 
+/**
+ * \brief Scan the Wine bottles from disk within a thread, the result is applied to the GUI via a dispatcher.
+ */
+void BottleManager::scan_bottles_thread()
+{
+  if (thread_scan_bottles_ == nullptr)
+  {
+    scan_bottles_update_counter_ = bottles_update_counter_;
+    thread_scan_bottles_ = std::make_unique<std::thread>(
+        [this, bottle_location = bottle_location_, is_display_default = is_display_default_wine_machine_, is_wine64_bit = is_wine64_bit_,
+         runner_directories = runner_directories_]
+        {
+          BottleListScanData scan_result;
+          try
+          {
+            // Mount the overlay bottles first (eg. after a reboot), otherwise they show up as empty folders
+            OverlayBottle::mount_all();
+            scan_result = scan_bottles(bottle_location, is_display_default, is_wine64_bit, runner_directories);
+          }
+          catch (const std::exception& error)
+          {
+            scan_result.error_messages.emplace_back(error.what());
+            scan_result.is_aborted = true;
+          }
+          {
+            std::lock_guard<std::mutex> lock(scan_result_mutex_);
+            scan_result_ = std::move(scan_result);
+          }
+          this->scan_bottles_finished_dispatcher_.emit();
+        });
+  }
+}
+
+/**
+ * \brief Refresh the active bottle only, by reading the bottle from disk (eg. after the bottle config is saved)
+ */
+void BottleManager::refresh_active_bottle()
+{
+  if (active_bottle_ != nullptr)
+    refresh_bottle(*active_bottle_);
+}
+
 /**
  * \brief Update WineGUI Config and update bottles by reading the Wine Bottles from disk and update GUI
  * \param select_bottle_name If set, try to find the bottle with this name and set it as active bottle (used for newly created bottles)
@@ -182,101 +516,8 @@ void BottleManager::update_config_and_bottles(const Glib::ustring& select_bottle
   // Set/update main window about the latest general config data
   main_window_.set_general_config(config_data);
 
-  bool try_to_restore = (active_bottle_ != nullptr);
-  if (try_to_restore)
-  {
-    previous_active_bottle_index_ = active_bottle_->get_index();
-    // Save the current bottle list size
-    previous_bottles_list_size_ = bottles_.size();
-  }
-
-  // Clear bottles
-  if (!bottles_.empty())
-    bottles_.clear();
-
-  // Get the bottle directories
-  std::vector<string> bottle_dirs;
-  try
-  {
-    bottle_dirs = get_bottle_paths();
-  }
-  catch (const std::runtime_error& error)
-  {
-    main_window_.show_error_message(error.what());
-    return; // stop
-  }
-
-  if (bottle_dirs.size() > 0)
-  {
-    try
-    {
-      // Create wine bottles from bottle directories and wine version
-      bottles_ = create_wine_bottles(bottle_dirs);
-    }
-    catch (const std::runtime_error& error)
-    {
-      main_window_.show_error_message(error.what());
-      return; // stop
-    }
-
-    if (!bottles_.empty())
-    {
-      // Update main Window
-      main_window_.set_wine_bottles(bottles_);
-
-      // Is select_bottle_name set?
-      if (!select_bottle_name.empty())
-      {
-        // Check if there is a bottle with the same name and select as active bottle
-        auto it = std::find_if(bottles_.begin(), bottles_.end(),
-                               [&select_bottle_name](const BottleItem& bottle) { return bottle.name() == select_bottle_name; });
-        if (it != bottles_.end())
-        {
-          main_window_.select_row_bottle(*it);
-          active_bottle_ = &(*it);
-        }
-      }
-      // Is try_to_restore boolean true?
-      // And: Is the bottle list size the same?
-      // And: Is the previous index not bigger than the list size?
-      else if (try_to_restore && (bottles_.size() == previous_bottles_list_size_) && ((size_t)previous_active_bottle_index_ < bottles_.size()))
-      {
-        // Let's reset the previous state!
-        auto front = bottles_.begin();
-        std::advance(front, previous_active_bottle_index_);
-        main_window_.select_row_bottle(*front);
-        // Set active bottle at the previous index
-        active_bottle_ = &(*front);
-      }
-      else
-      {
-        // Default behaviour: Bottle list is changed, let's set the first bottle in the detailed info panel.
-        // begin() gives us an iterator with the first element
-        auto first = bottles_.begin();
-        // Trigger select row, except during start-up (show_all will auto-select the first listbox item in GTK)
-        if (!is_startup)
-          main_window_.select_row_bottle(*first);
-        // Set active bottle at the first
-        active_bottle_ = &(*first);
-      }
-    }
-    else
-    {
-      main_window_.show_error_message("Could not create an overview of Windows Machines. Empty list.");
-
-      // Send reset signal to reset the active bottle to NULL
-      reset_active_bottle.emit();
-      // Reset locally
-      active_bottle_ = nullptr;
-    }
-  }
-  else
-  {
-    // Send reset signal to reset the active bottle to NULL
-    reset_active_bottle.emit();
-    // Reset locally
-    active_bottle_ = nullptr;
-  }
+  BottleListScanData scan_result = scan_bottles(bottle_location_, is_display_default_wine_machine_, is_wine64_bit_, runner_directories_);
+  set_bottles(scan_result, select_bottle_name, is_startup);
 }
 
 /**
@@ -357,14 +598,18 @@ void BottleManager::new_bottle(SignalController* caller,
     return; // Stop thread prematurely
   }
 
+  // Wait until wineserver terminates, so the settings below can be written directly in the registry files
+  Helper::wait_until_wineserver_is_terminated(prefix_path);
+
   // Continue with additional settings
   if (bottle_created)
   {
+    WineRegistryWriter registry(prefix_path);
     // Always set the Windows Version (we do not know which Wine version the user is using)
     // Only change Windows OS when NOT default
     try
     {
-      Helper::set_windows_version(prefix_path, windows_version);
+      Helper::set_windows_version(registry, windows_version);
     }
     catch (const std::runtime_error& error)
     {
@@ -381,7 +626,7 @@ void BottleManager::new_bottle(SignalController* caller,
     {
       try
       {
-        Helper::set_virtual_desktop(prefix_path, virtual_desktop_resolution);
+        Helper::set_virtual_desktop(registry, virtual_desktop_resolution);
       }
       catch (const std::runtime_error& error)
       {
@@ -397,25 +642,25 @@ void BottleManager::new_bottle(SignalController* caller,
     // Only if Audio driver is not default, change it
     if (audio != WineDefaults::AudioDriver)
     {
-      try
-      {
-        Helper::set_audio_driver(prefix_path, audio);
-      }
-      catch (const std::runtime_error& error)
+      Helper::set_audio_driver(registry, audio);
+    }
+
+    // Write all the settings at once
+    try
+    {
+      registry.commit(Helper::get_wine_executable_location(is_wine64_bit_));
+    }
+    catch (const std::runtime_error& error)
+    {
       {
-        {
-          std::lock_guard<std::mutex> lock(error_message_mutex_);
-          error_message_ = ("Something went wrong during setting another audio driver.\n" + Glib::ustring(error.what()));
-        }
-        caller->signal_error_message_during_create();
-        return; // Stop thread prematurely
+        std::lock_guard<std::mutex> lock(error_message_mutex_);
+        error_message_ = ("Something went wrong during saving the machine settings.\n" + Glib::ustring(error.what()));
       }
+      caller->signal_error_message_during_create();
+      return; // Stop thread prematurely
     }
   }
 
-  // Wait until wineserver terminates
-  Helper::wait_until_wineserver_is_terminated(prefix_path);
-
   // Trigger done signal, which will eventually use a Glib dispatcher to signal back to the GUI thread
   caller->signal_bottle_created();
 }
@@ -445,6 +690,15 @@ void BottleManager::update_bottle(SignalController* caller,
   if (active_bottle_ != nullptr)
   {
     string prefix_path = active_bottle_->wine_location();
+    if (OverlayBottle::is_template_in_use(prefix_path))
+    {
+      {
+        std::lock_guard<std::mutex> lock(error_message_mutex_);
+        error_message_ = "This machine is used as template by other machines (sharing its files), it can't be changed while those machines exist.";
+      }
+      caller->signal_error_message_during_update();
+      return; // Stop thread prematurely
+    }
 
     bool need_update_bottle_config_file = false;
     BottleConfigData bottle_config;
@@ -480,11 +734,12 @@ void BottleManager::update_bottle(SignalController* caller,
       }
     }
 
+    WineRegistryWriter registry(prefix_path);
     if (active_bottle_->windows() != windows_version)
     {
       try
       {
-        Helper::set_windows_version(prefix_path, windows_version);
+        Helper::set_windows_version(registry, windows_version);
       }
       catch (const std::runtime_error& error)
       {
@@ -503,7 +758,7 @@ void BottleManager::update_bottle(SignalController* caller,
       {
         try
         {
-          Helper::set_virtual_desktop(prefix_path, virtual_desktop_resolution);
+          Helper::set_virtual_desktop(registry, virtual_desktop_resolution);
         }
         catch (const std::runtime_error& error)
         {
@@ -517,36 +772,27 @@ void BottleManager::update_bottle(SignalController* caller,
       }
       else
       {
-        try
-        {
-          Helper::disable_virtual_desktop(prefix_path);
-        }
-        catch (const std::runtime_error& error)
-        {
-          {
-            std::lock_guard<std::mutex> lock(error_message_mutex_);
-            error_message_ = ("Something went wrong during disabling virtual desktop mode.\n" + Glib::ustring(error.what()));
-          }
-          caller->signal_error_message_during_update();
-          return; // Stop thread prematurely
-        }
+        Helper::disable_virtual_desktop(registry);
       }
     }
     if (active_bottle_->audio_driver() != audio)
     {
-      try
-      {
-        Helper::set_audio_driver(prefix_path, audio);
-      }
-      catch (const std::runtime_error& error)
+      Helper::set_audio_driver(registry, audio);
+    }
+
+    // Write all the changed settings at once (directly in the registry files, unless wineserver is running)
+    try
+    {
+      registry.commit(get_wine_executable());
+    }
+    catch (const std::runtime_error& error)
+    {
       {
-        {
-          std::lock_guard<std::mutex> lock(error_message_mutex_);
-          error_message_ = ("Something went wrong during setting another audio driver.\n" + Glib::ustring(error.what()));
-        }
-        caller->signal_error_message_during_update();
-        return; // Stop thread prematurely
+        std::lock_guard<std::mutex> lock(error_message_mutex_);
+        error_message_ = ("Something went wrong during saving the machine settings.\n" + Glib::ustring(error.what()));
       }
+      caller->signal_error_message_during_update();
+      return; // Stop thread prematurely
     }
 
     // Wait until wineserver terminates
@@ -561,7 +807,14 @@ void BottleManager::update_bottle(SignalController* caller,
       string new_prefix_path = Glib::build_path(G_DIR_SEPARATOR_S, dirs);
       try
       {
-        Helper::rename_wine_bottle_folder(prefix_path, new_prefix_path);
+        if (!OverlayBottle::get_derived_bottles(prefix_path).empty())
+        {
+          throw std::runtime_error("This machine is used as template by other machines, the folder name can't be changed.");
+        }
+        if (OverlayBottle::is_overlay(prefix_path))
+          OverlayBottle::move(prefix_path, new_prefix_path);
+        else
+          Helper::rename_wine_bottle_folder(prefix_path, new_prefix_path);
       }
       catch (const std::runtime_error& error)
       {
@@ -594,11 +847,15 @@ void BottleManager::update_bottle(SignalController* caller,
  * \param[in] name                        New Bottle Name
  * \param[in] folder_name                 New Bottle Folder Name
  * \param[in] description                 New Description text
+ * \param[in] is_overlay                  Share the files of the current bottle (copy-on-write overlay), instead of copying them
+ * \param[in] stop_token                  Cancels the copy of the bottle when a stop is requested
  */
 void BottleManager::clone_bottle(SignalController* caller,
                                  const Glib::ustring& name,
                                  const Glib::ustring& folder_name,
-                                 const Glib::ustring& description)
+                                 const Glib::ustring& description,
+                                 bool is_overlay,
+                                 std::stop_token stop_token)
 {
   if (active_bottle_ != nullptr)
   {
@@ -609,7 +866,19 @@ void BottleManager::clone_bottle(SignalController* caller,
     string clone_prefix_path = Glib::build_path(G_DIR_SEPARATOR_S, dirs);
     try
     {
-      Helper::copy_wine_bottle_folder(orginal_prefix_path, clone_prefix_path);
+      auto progress = [caller](std::uint64_t bytes_copied, std::uint64_t bytes_total)
+      { caller->signal_clone_progress((bytes_total > 0) ? static_cast<double>(bytes_copied) / static_cast<double>(bytes_total) : 1.0); };
+      if (is_overlay)
+      {
+        // Only the changes of the clone are stored from now on
+        OverlayBottle::create(orginal_prefix_path, clone_prefix_path);
+      }
+      else if (!Helper::copy_wine_bottle_folder(orginal_prefix_path, clone_prefix_path, progress, stop_token))
+      {
+        // Cancelled by the user, the partial copy is already removed (no error)
+        caller->signal_clone_cancelled();
+        return; // Stop thread prematurely
+      }
     }
     catch (const std::runtime_error& error)
     {
@@ -655,16 +924,30 @@ void BottleManager::clone_bottle(SignalController* caller,
 }
 
 /**
- * \brief Remove the current active Wine bottle
+ * \brief Remove the current active Wine bottle (or all the selected bottles)
  */
 void BottleManager::delete_bottle()
 {
-  if (active_bottle_ != nullptr)
+  if (is_batch_selection())
+  {
+    delete_selected_bottles();
+  }
+  else if (active_bottle_ != nullptr)
   {
     try
     {
       string prefix_path = active_bottle_->wine_location();
       Glib::ustring windows = BottleTypes::to_string(active_bottle_->windows());
+      std::vector<string> derived_bottles = OverlayBottle::get_derived_bottles(prefix_path);
+      if (!derived_bottles.empty())
+      {
+        Glib::ustring derived_folder_names;
+        for (const string& derived_bottle : derived_bottles)
+          derived_folder_names += "\n" + Helper::get_folder_name(derived_bottle);
+        main_window_.show_error_message("This machine is used as template by the following machines, remove them first:\n" +
+                                        derived_folder_names);
+        return;
+      }
       // Are you sure?
       Glib::ustring confirm_message = "Are you sure you want to <b>PERMANENTLY</b> remove machine named '" +
                                       Glib::Markup::escape_text(Helper::get_folder_name(prefix_path)) + "' running " + windows +
@@ -673,7 +956,10 @@ void BottleManager::delete_bottle()
       {
         // Signal that bottle is removed
         bottle_removed.emit();
-        Helper::remove_wine_bottle(prefix_path);
+        // The bottle is gone at once, the files are removed in the background
+        string trash_path =
+            OverlayBottle::is_overlay(prefix_path) ? OverlayBottle::move_to_trash(prefix_path) : BottleRemover::move_to_trash(prefix_path);
+        remove_trash(trash_path);
         this->update_config_and_bottles("", false);
       }
       else
@@ -704,6 +990,15 @@ void BottleManager::set_active_bottle(BottleItem* bottle)
   }
 }
 
+/**
+ * \brief Signal handler when the selected bottles change, used by the batch operations
+ * \param[in] bottles - All selected bottles
+ */
+void BottleManager::set_selected_bottles(const std::vector<BottleItem*>& bottles)
+{
+  selected_bottles_ = bottles;
+}
+
 /**
  * \brief Get error message (stored from manager thread)
  * \return Return the error message
@@ -721,36 +1016,22 @@ const Glib::ustring& BottleManager::get_error_message() const
  */
 void BottleManager::run_executable(string program, bool is_msi_file = false)
 {
-  if (is_bottle_not_null())
+  if (is_bottle_not_null() && is_template_not_in_use({active_bottle_}))
   {
     string wine_prefix = active_bottle_->wine_location();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    string program_prefix = is_msi_file ? "msiexec /i" : "start /unix";
     string working_directory = Glib::path_get_dirname(program);
-    // Be-sure to execute the program between quotes (due to spaces)
-    program = program_prefix + " \"" + program + "\"";
+    // Program is passed as a single argument (no quoting needed in case of spaces)
+    std::vector<string> program_args = is_msi_file ? std::vector<string>{"msiexec", "/i", program} : std::vector<string>{"start", "/unix", program};
     auto& env_vars = active_bottle_->env_vars();
 
-    std::thread t(
-        [wine64 = std::move(is_wine64_bit_), wine_prefix, debug_log_level, program, working_directory, env_vars,
-         logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+    launch_program(
+        [&]
         {
-          string output =
-              Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
+          return Helper::spawn_program_under_wine(get_wine_executable(), wine_prefix, debug_log_level, program_args, working_directory, env_vars,
+                                                  is_logging_stderr_, is_debug_logging);
         });
-    t.detach();
   }
 }
 
@@ -760,16 +1041,18 @@ void BottleManager::run_executable(string program, bool is_msi_file = false)
  */
 void BottleManager::run_program(string program)
 {
-  if (is_bottle_not_null())
+  if (is_bottle_not_null() && is_template_not_in_use({active_bottle_}))
   {
     string wine_prefix = active_bottle_->wine_location();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
+    const string winetricks_gui_args = " --gui -q";
     // For all programs (except winetricks)
-    if (!program.ends_with("winetricks --gui -q"))
+    if (!program.ends_with("winetricks" + winetricks_gui_args))
     {
       string working_directory = "";
-      // Be-sure to execute the program between quotes (due to spaces).
+      // Program is passed as a single argument (no quoting needed in case of spaces).
+      std::vector<string> program_args;
       if (program.starts_with("/"))
       {
         // TODO: Provide the user the option whether or not the working directory need to be set.
@@ -777,59 +1060,65 @@ void BottleManager::run_program(string program)
         // And pass it alone with run_program_under_wine() below.
 
         // Add 'start /unix' for Unit style command, like application shortcuts
-        program = "start /unix \"" + program + "\"";
+        program_args = {"start", "/unix", program};
       }
       else
       {
         // Add 'start' for Windows style commands, like 'notepad'
-        program = "start \"" + program + "\"";
+        program_args = {"start", program};
       }
       auto& env_vars = active_bottle_->env_vars();
 
-      std::thread t(
-          [wine64 = std::move(is_wine64_bit_), wine_prefix, debug_log_level, program, working_directory, env_vars,
-           logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-           output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-           output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+      launch_program(
+          [&]
           {
-            string output =
-                Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, program, working_directory, env_vars, true, logging_stderr);
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
+            return Helper::spawn_program_under_wine(get_wine_executable(), wine_prefix, debug_log_level, program_args, working_directory,
+                                                    env_vars, is_logging_stderr_, is_debug_logging);
           });
-      t.detach();
     }
     else
     {
       // We have an exception for winetricks, since that doesn't need the wine command
-      std::thread t(
-          [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-           output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-           output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
-          {
-            string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
-          });
-      t.detach();
+      std::vector<string> program_args{program.substr(0, program.size() - winetricks_gui_args.size()), "--gui", "-q"};
+      auto env_vars = get_winetricks_env_vars(*active_bottle_);
+      launch_program(
+          [&] { return Helper::spawn_program(wine_prefix, debug_log_level, program_args, "", env_vars, is_logging_stderr_, is_debug_logging); });
     }
   }
 }
 
+/**
+ * \brief Start a (long running) program of the user, outside of the task executor.
+ * The program is not occupying a worker while running, it is reaped via a child watch in the GUI thread.
+ * \param[in] spawn Starts the program, returns the process ID (see Helper::spawn_program())
+ */
+void BottleManager::launch_program(const std::function<pid_t()>& spawn)
+{
+  pid_t pid = 0;
+  try
+  {
+    pid = spawn();
+  }
+  catch (const std::runtime_error& error)
+  {
+    main_window_.show_error_message(error.what());
+    return;
+  }
+  Glib::signal_child_watch().connect(sigc::mem_fun(*this, &BottleManager::on_program_exited), pid);
+}
+
+/**
+ * \brief Signal handler when a program started by launch_program() exited
+ * \param[in] pid Process ID of the program
+ * \param[in] status Wait status of the program
+ */
+void BottleManager::on_program_exited(GPid /*pid*/, int status)
+{
+  // Inform the user when the program exited with a non-zero exit code
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    Helper::get_instance().failure_on_exec.emit();
+}
+
 /**
  * \brief Open the Wine C: drive on the current active bottle
  */
@@ -845,68 +1134,78 @@ void BottleManager::open_c_drive()
 }
 
 /**
- * \brief Reboot bottle
+ * \brief Reboot bottle (or all the selected bottles)
  */
 void BottleManager::reboot()
 {
-  if (is_bottle_not_null())
+  if (is_batch_selection())
+  {
+    if (is_template_not_in_use(selected_bottles_))
+      run_batch(main_window_, "Reboot Windows Machines", "Emulating a reboot of the selected machines.",
+                create_batch_jobs({"wineboot", "-r"}, true, false));
+  }
+  else if (is_bottle_not_null() && is_template_not_in_use({active_bottle_}))
   {
     string wine_prefix = active_bottle_->wine_location();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
-        [wine64 = std::move(is_wine64_bit_), wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_]
+    bool is_queued = task_executor_.is_busy();
+    task_executor_.submit(
+        [this, wine_executable = get_wine_executable(), wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
+         debug_logging = std::move(is_debug_logging)](std::stop_token stop_token)
         {
-          string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -r", "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
+          try
           {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
+            Helper::run_program_under_wine(wine_executable, wine_prefix, debug_log_level, {"wineboot", "-r"}, "", {}, true, logging_stderr,
+                                           debug_logging, stop_token);
+          }
+          catch (const std::runtime_error& error)
+          {
+            report_task_error("Could not reboot the machine.
+" + Glib::ustring(error.what()));
           }
         });
-    t.detach();
-    main_window_.show_info_message("Machine emulate reboot requested.");
+    main_window_.show_info_message("Machine emulate reboot requested." + (is_queued ? "\n\n" + TaskQueuedMessage : ""));
   }
 }
 
 /**
- * \brief Update bottle
+ * \brief Update bottle (or all the selected bottles)
  */
 void BottleManager::update()
 {
-  if (is_bottle_not_null())
+  if (is_batch_selection())
+  {
+    if (is_template_not_in_use(selected_bottles_))
+      run_batch(main_window_, "Update Windows Machines", "Updating the Wine configuration of the selected machines.",
+                create_batch_jobs({"wineboot", "-u"}, true, false), [this]() { update_config_and_bottles("", false); });
+  }
+  else if (is_bottle_not_null() && is_template_not_in_use({active_bottle_}))
   {
     string wine_prefix = active_bottle_->wine_location();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
-        [wine64 = std::move(is_wine64_bit_), wine_prefix, debug_log_level, update_bottles_dispatcher = &update_bottles_dispatcher_,
-         logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_]
+    bool is_queued = task_executor_.is_busy();
+    task_executor_.submit(
+        [this, wine_executable = get_wine_executable(), wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
+         debug_logging = std::move(is_debug_logging)](std::stop_token stop_token)
         {
-          string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -u", "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
+          try
           {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
+            Helper::run_program_under_wine(wine_executable, wine_prefix, debug_log_level, {"wineboot", "-u"}, "", {}, true, logging_stderr,
+                                           debug_logging, stop_token);
+            Helper::wait_until_wineserver_is_terminated(wine_prefix, stop_token);
+          }
+          catch (const std::runtime_error& error)
+          {
+            report_task_error("Could not update the machine.
+" + Glib::ustring(error.what()));
           }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          // Emit update bottles (via dispatcher, so the GUI update can take place in the GUI thread)
-          update_bottles_dispatcher->emit();
+          // Always emit update bottles (via dispatcher, so the GUI update can take place in the GUI thread)
+          update_bottles_dispatcher_.emit();
         });
-    t.detach();
+    if (is_queued)
+      main_window_.show_info_message("Machine update requested.\n\n" + TaskQueuedMessage);
   }
 }
 
@@ -935,34 +1234,37 @@ void BottleManager::open_log_file()
 }
 
 /**
- * \brief Kill running processes in bottle
+ * \brief Kill running processes in bottle (or in all the selected bottles)
  */
 void BottleManager::kill_processes()
 {
-  if (is_bottle_not_null())
+  if (is_batch_selection())
+  {
+    run_batch(main_window_, "Kill Processes", "Killing the running processes of the selected machines.",
+              create_batch_jobs({"wineboot", "-k"}, true, false));
+  }
+  else if (is_bottle_not_null())
   {
     string wine_prefix = active_bottle_->wine_location();
     bool is_debug_logging = active_bottle_->is_debug_logging();
     int debug_log_level = active_bottle_->debug_log_level();
-    std::thread t(
-        [wine64 = std::move(is_wine64_bit_), wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
-         debug_logging = std::move(is_debug_logging), output_logging_mutex = std::ref(output_loging_mutex_),
-         logging_bottle_prefix = std::ref(logging_bottle_prefix_), output_logging = std::ref(output_logging_),
-         write_log_dispatcher = &write_log_dispatcher_]
+    bool is_queued = task_executor_.is_busy();
+    task_executor_.submit(
+        [this, wine_executable = get_wine_executable(), wine_prefix, debug_log_level, logging_stderr = std::move(is_logging_stderr_),
+         debug_logging = std::move(is_debug_logging)](std::stop_token stop_token)
         {
-          string output = Helper::run_program_under_wine(wine64, wine_prefix, debug_log_level, "wineboot -k", "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
+          try
           {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
+            Helper::run_program_under_wine(wine_executable, wine_prefix, debug_log_level, {"wineboot", "-k"}, "", {}, true, logging_stderr,
+                                           debug_logging, stop_token);
+          }
+          catch (const std::runtime_error& error)
+          {
+            report_task_error("Could not kill the processes of the machine.
+" + Glib::ustring(error.what()));
           }
         });
-    t.detach();
-    main_window_.show_info_message("Kill processes requested.");
+    main_window_.show_info_message("Kill processes requested." + (is_queued ? "\n\n" + TaskQueuedMessage : ""));
   }
 }
 
@@ -975,39 +1277,12 @@ void BottleManager::install_d3dx9(Gtk::Window& parent, const string& version)
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing D3DX9 (OpenGL implementation of DirectX 9).");
-
     string package = "d3dx9";
     if (version != "")
     {
       package += "_" + version;
     }
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    install_package(parent, "Installing D3DX9 (OpenGL implementation of DirectX 9).", {Helper::get_winetricks_location(), "-q", package}, false);
   }
 }
 
@@ -1021,39 +1296,13 @@ void BottleManager::install_dxvk(Gtk::Window& parent, const string& version)
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing DXVK (Vulkan-based implementation of DirectX 9, 10 and 11).\n");
-
     string package = "dxvk";
     if (version != "latest")
     {
       package += version;
     }
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    install_package(parent, "Installing DXVK (Vulkan-based implementation of DirectX 9, 10 and 11).\n",
+                    {Helper::get_winetricks_location(), "-q", package}, false);
   }
 }
 
@@ -1065,35 +1314,8 @@ void BottleManager::install_vkd3d(Gtk::Window& parent)
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing VKD3D (Vulkan-based implementation of DirectX 12).\n");
-
-    string package = "vkd3d";
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    install_package(parent, "Installing VKD3D (Vulkan-based implementation of DirectX 12).\n", {Helper::get_winetricks_location(), "-q", "vkd3d"},
+                    false);
   }
 }
 
@@ -1106,35 +1328,8 @@ void BottleManager::install_visual_cpp_package(Gtk::Window& parent, const string
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing Visual C++ package (" + version + ").");
-
-    string package = "vcrun" + version;
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q " + package;
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    install_package(parent, "Installing Visual C++ package (" + version + ").", {Helper::get_winetricks_location(), "-q", "vcrun" + version},
+                    false);
   }
 }
 
@@ -1152,48 +1347,9 @@ void BottleManager::install_dot_net(Gtk::Window& parent, const string& version)
                                          "<b>uninstalled</b> before native .NET will be installed.\n\nAre you sure you want to continue?",
                                          true))
     {
-      // Before we execute the install, show busy dialog
-      main_window_.show_busy_install_dialog(parent, "Installing Native .NET package (v" + version + ").\nThis may take quite some time!\n");
-
-      string deinstall_command = this->get_deinstall_mono_command();
-
-      string package = "dotnet" + version;
-      string wine_prefix = active_bottle_->wine_location();
-      bool is_debug_logging = active_bottle_->is_debug_logging();
-      int debug_log_level = active_bottle_->debug_log_level();
       // I can't use -q with .NET installs
-      string install_command = Helper::get_winetricks_location() + " " + package;
-      string program = "";
-      if (!deinstall_command.empty())
-      {
-        // First deinstall Mono then install native .NET
-        program = deinstall_command + "; " + install_command;
-      }
-      else
-      {
-        program = install_command;
-      }
-      // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-      std::thread t(
-          [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-           output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-           output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-           finish_dispatcher = &finished_package_install_dispatcher]
-          {
-            string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-            if (debug_logging && !output.empty())
-            {
-              {
-                std::lock_guard<std::mutex> lock(output_logging_mutex);
-                logging_bottle_prefix.get() = wine_prefix;
-                output_logging.get() = output;
-              }
-              write_log_dispatcher->emit();
-            }
-            Helper::wait_until_wineserver_is_terminated(wine_prefix);
-            finish_dispatcher->emit();
-          });
-      t.detach();
+      install_package(parent, "Installing Native .NET package (v" + version + ").\nThis may take quite some time!\n",
+                      {Helper::get_winetricks_location(), "dotnet" + version}, true);
     }
     else
     {
@@ -1210,34 +1366,7 @@ void BottleManager::install_core_fonts(Gtk::Window& parent)
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing MS Core fonts.");
-
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q corefonts";
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
-        {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
-          {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
-          }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
+    install_package(parent, "Installing MS Core fonts.", {Helper::get_winetricks_location(), "-q", "corefonts"}, false);
   }
 }
 
@@ -1249,35 +1378,57 @@ void BottleManager::install_liberation(Gtk::Window& parent)
 {
   if (is_bottle_not_null())
   {
-    // Before we execute the install, show busy dialog
-    main_window_.show_busy_install_dialog(parent, "Installing Liberation open-source fonts.");
+    install_package(parent, "Installing Liberation open-source fonts.", {Helper::get_winetricks_location(), "-q", "liberation"}, false);
+  }
+}
 
-    string wine_prefix = active_bottle_->wine_location();
-    bool is_debug_logging = active_bottle_->is_debug_logging();
-    int debug_log_level = active_bottle_->debug_log_level();
-    string program = Helper::get_winetricks_location() + " -q liberation";
-    // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
-    std::thread t(
-        [wine_prefix, debug_log_level, program, logging_stderr = std::move(is_logging_stderr_), debug_logging = std::move(is_debug_logging),
-         output_logging_mutex = std::ref(output_loging_mutex_), logging_bottle_prefix = std::ref(logging_bottle_prefix_),
-         output_logging = std::ref(output_logging_), write_log_dispatcher = &write_log_dispatcher_,
-         finish_dispatcher = &finished_package_install_dispatcher]
+/**
+ * \brief Cancel the running batch operation, the remaining bottles are skipped.
+ * The bottles that are already busy are not interrupted.
+ */
+void BottleManager::cancel_batch()
+{
+  std::lock_guard<std::mutex> lock(batch_mutex_);
+  if (is_batch_running_)
+    batch_stop_source_.request_stop();
+}
+
+/**
+ * \brief Scan all the bottles for identical files (in a thread), the user is asked to deduplicate them afterwards.
+ * Overlay bottles are skipped, they already share the files of their template.
+ */
+void BottleManager::deduplicate_bottles()
+{
+  if (is_deduplicating_)
+  {
+    main_window_.show_error_message("The Windows Machines are already being deduplicated. Please wait...");
+    return;
+  }
+  is_deduplicating_ = true;
+  main_window_.show_busy_dialog("Deduplicate Windows Machines", "Searching for identical files across all machines.");
+  task_executor_.submit(
+      [this, bottle_location = bottle_location_, is_display_default_wine_machine = is_display_default_wine_machine_](std::stop_token stop_token)
+      {
+        std::vector<string> prefix_paths;
+        try
         {
-          string output = Helper::run_program(wine_prefix, debug_log_level, program, "", {}, true, logging_stderr);
-          if (debug_logging && !output.empty())
+          for (const string& prefix_path : get_bottle_paths(bottle_location, is_display_default_wine_machine))
           {
-            {
-              std::lock_guard<std::mutex> lock(output_logging_mutex);
-              logging_bottle_prefix.get() = wine_prefix;
-              output_logging.get() = output;
-            }
-            write_log_dispatcher->emit();
+            if (!OverlayBottle::is_overlay(prefix_path))
+              prefix_paths.push_back(prefix_path);
           }
-          Helper::wait_until_wineserver_is_terminated(wine_prefix);
-          finish_dispatcher->emit();
-        });
-    t.detach();
-  }
+        }
+        catch (const std::runtime_error& error)
+        {
+          std::cerr << "Error: Could not get the bottles to deduplicate: " << error.what() << std::endl;
+        }
+        DeduplicationReport report = BottleDeduplicator::scan(prefix_paths, stop_token);
+        {
+          std::lock_guard<std::mutex> lock(deduplicate_mutex_);
+          deduplicate_report_ = std::move(report);
+        }
+        deduplicate_scan_dispatcher_.emit();
+      });
 }
 
 /*************************************************************
@@ -1295,192 +1446,964 @@ GeneralConfigData BottleManager::load_and_save_general_config()
   is_display_default_wine_machine_ = general_config.display_default_wine_machine;
   is_wine64_bit_ = Helper::determine_wine_executable() == 1;
   is_logging_stderr_ = general_config.enable_logging_stderr;
+  runner_directories_ = general_config.runner_directories;
+  batch_parallelism_ = general_config.batch_parallelism;
   return general_config;
 }
 
-bool BottleManager::is_bottle_not_null()
-{
-  bool is_null = (active_bottle_ == nullptr);
-  if (is_null)
-  {
-    main_window_.show_error_message("No Windows Machine selected/empty. First create a new machine!\n\nAborted.");
-  }
-  return !is_null;
-}
-
 /**
- * \brief Wine Mono deinstall command, run before installing native .NET
- * \return uninstall Mono command
- * Note: When nothing todo, the command will be an empty string.
+ * \brief Set the scanned bottles to the bottle manager and update the GUI (runs in the GUI thread)
+ * \param scan_result The scanned bottles
+ * \param select_bottle_name If set, try to find the bottle with this name and set it as active bottle (used for newly created bottles)
+ * \param is_startup Set to true if this function is called during start-up, otherwise false
  */
-string BottleManager::get_deinstall_mono_command()
+void BottleManager::set_bottles(BottleListScanData& scan_result, const Glib::ustring& select_bottle_name, bool is_startup)
 {
-  string command = "";
-  if (active_bottle_ != nullptr)
+  bottles_update_counter_++;
+  bool try_to_restore = (active_bottle_ != nullptr);
+  if (try_to_restore)
   {
-    string wine_prefix = active_bottle_->wine_location();
-    string guid = Helper::get_wine_guid(is_wine64_bit_, wine_prefix, "Wine Mono Runtime");
-
-    if (!guid.empty())
-    {
-      string uninstaller = "";
-      switch (active_bottle_->bit())
-      {
-      case BottleTypes::Bit::win32:
-        uninstaller = "wine uninstaller --remove";
-        break;
-      case BottleTypes::Bit::win64:
-        uninstaller = "wine64 uninstaller --remove";
-        break;
-      }
-      command = uninstaller + " '{" + guid + "}'";
-    }
+    previous_active_bottle_index_ = active_bottle_->get_index();
+    // Save the current bottle list size
+    previous_bottles_list_size_ = bottles_.size();
   }
-  return command;
-}
 
-/**
- * \brief Get Wine version
- * \return Wine version
- */
-string BottleManager::get_wine_version()
-{
-  // Read wine version (is always the same for all bottles atm)
-  string wine_version = "";
-  try
+  // Clear bottles
+  if (!bottles_.empty())
+    bottles_.clear();
+  bottle_fingerprints_.clear();
+  // The selected bottles are gone as well, the listbox signals the new selection
+  selected_bottles_.clear();
+
+  for (const string& error_message : scan_result.error_messages)
   {
-    wine_version = Helper::get_wine_version(is_wine64_bit_);
+    main_window_.show_error_message(error_message);
   }
-  catch (const std::runtime_error& error)
+  if (scan_result.is_aborted)
   {
-    main_window_.show_error_message(error.what());
+    // Clear the bottle list (including placeholders)
+    main_window_.set_wine_bottles(bottles_);
+    // Send reset signal to reset the active bottle to NULL
+    reset_active_bottle.emit();
+    // Reset locally
+    active_bottle_ = nullptr;
+    return; // stop
   }
-  return wine_version;
-}
 
-/**
- * \brief Get Bottle Paths
- * \throws runtime_error when we can not created a Wine bottle directory or configuration folder could not be found
- * \return Return a map of bottle paths (string) and modification time (in ms)
- */
-std::vector<string> BottleManager::get_bottle_paths()
-{
-  if (!Helper::dir_exists(bottle_location_))
+  if (scan_result.bottles.size() > 0)
   {
-    // Create bottle prefix directory if not exist yet
-    if (!Helper::create_dir(bottle_location_))
+    // Create wine bottles from the scanned bottle directories and wine version
+    bottles_ = create_wine_bottles(scan_result);
+    watch_bottles();
+
+    if (!bottles_.empty())
     {
-      throw std::runtime_error("Failed to create the Wine bottle directory: " + bottle_location_);
-    }
-  }
-  if (Helper::dir_exists(bottle_location_))
-  {
-    // Continue
-    return Helper::get_bottles_paths(bottle_location_, is_display_default_wine_machine_);
-  }
-  else
-  {
-    throw std::runtime_error("Configuration directory still not found (probably no permissions):\n" + bottle_location_);
-  }
-  // Otherwise empty
-  return std::vector<string>();
-}
+      // Update main Window
+      main_window_.set_wine_bottles(bottles_);
 
-/**
- * \brief Create wine BottleItem objects and add them to a list.
- * \param[in] bottle_dirs  The list of bottle directories
- * \returns Array of Bottle Items
+      // Is select_bottle_name set?
+      if (!select_bottle_name.empty())
+      {
+        // Check if there is a bottle with the same name and select as active bottle
+        auto it = std::find_if(bottles_.begin(), bottles_.end(),
+                               [&select_bottle_name](const BottleItem& bottle) { return bottle.name() == select_bottle_name; });
+        if (it != bottles_.end())
+        {
+          main_window_.select_row_bottle(*it);
+          active_bottle_ = &(*it);
+        }
+      }
+      // Is try_to_restore boolean true?
+      // And: Is the bottle list size the same?
+      // And: Is the previous index not bigger than the list size?
+      else if (try_to_restore && (bottles_.size() == previous_bottles_list_size_) && ((size_t)previous_active_bottle_index_ < bottles_.size()))
+      {
+        // Let's reset the previous state!
+        auto front = bottles_.begin();
+        std::advance(front, previous_active_bottle_index_);
+        main_window_.select_row_bottle(*front);
+        // Set active bottle at the previous index
+        active_bottle_ = &(*front);
+      }
+      else
+      {
+        // Default behaviour: Bottle list is changed, let's set the first bottle in the detailed info panel.
+        // begin() gives us an iterator with the first element
+        auto first = bottles_.begin();
+        // Trigger select row, except during start-up (show_all will auto-select the first listbox item in GTK)
+        if (!is_startup)
+          main_window_.select_row_bottle(*first);
+        // Set active bottle at the first
+        active_bottle_ = &(*first);
+      }
+    }
+    else
+    {
+      main_window_.show_error_message("Could not create an overview of Windows Machines. Empty list.");
+
+      // Send reset signal to reset the active bottle to NULL
+      reset_active_bottle.emit();
+      // Reset locally
+      active_bottle_ = nullptr;
+    }
+  }
+  else
+  {
+    // Clear the bottle list (including placeholders)
+    main_window_.set_wine_bottles(bottles_);
+    watch_bottles();
+    // Send reset signal to reset the active bottle to NULL
+    reset_active_bottle.emit();
+    // Reset locally
+    active_bottle_ = nullptr;
+  }
+}
+
+/**
+ * \brief Watch the bottle location and the files of each bottle for changes on disk.
+ * Added/removed bottles trigger a rescan of the bottle list, changed bottles are refreshed in place.
  */
-std::list<BottleItem> BottleManager::create_wine_bottles(const std::vector<string>& bottle_dirs)
+void BottleManager::watch_bottles()
 {
-  std::list<BottleItem> bottles;
-  Glib::ustring wine_version = get_wine_version();
-
-  // Retrieve detailed info for each wine bottle prefix
-  for (const string& prefix : bottle_dirs)
-  {
-    // Reset variables
-    Glib::ustring folder_name = "";
-    Glib::ustring virtual_desktop = "";
-    BottleTypes::Bit bit = BottleTypes::Bit::win32;
-    Glib::ustring c_drive_location = "- Unknown -";
-    Glib::ustring last_time_wine_updated = "- Unknown -";
-    BottleTypes::AudioDriver audio_driver = BottleTypes::AudioDriver::pulseaudio;
-    BottleTypes::Windows windows = WineDefaults::WindowsOs;
-    bool status = false;
-
-    // Retrieve bottle config data & custom app list
-    BottleConfigData bottle_config;
-    std::map<int, ApplicationData> bottle_app_list;
-    std::tie(bottle_config, bottle_app_list) = BottleConfigFile::read_config_file(prefix);
-
+  // (Re)create the bottle location monitor, when the location is changed
+  if (!bottle_location_monitor_ || monitored_bottle_location_ != bottle_location_)
+  {
+    if (bottle_location_monitor_)
+      bottle_location_monitor_->cancel();
     try
     {
-      folder_name = Helper::get_folder_name(prefix);
+      bottle_location_monitor_ = Gio::File::create_for_path(bottle_location_)->monitor_directory();
+      bottle_location_monitor_->signal_changed().connect(sigc::mem_fun(*this, &BottleManager::on_bottle_location_changed));
+      monitored_bottle_location_ = bottle_location_;
     }
-    catch (const std::runtime_error& error)
+    catch (const Glib::Error& ex)
     {
-      main_window_.show_error_message(error.what());
+      std::cerr << "Error: Could not watch the bottle location " << bottle_location_ << " for changes: " << ex.what() << std::endl;
+      bottle_location_monitor_.reset();
     }
+  }
 
+  // Keep the monitors of existing bottles, add monitors for new bottles
+  std::map<string, Glib::RefPtr<Gio::FileMonitor>> bottle_monitors;
+  for (const BottleItem& bottle : bottles_)
+  {
+    string prefix_path = bottle.wine_location();
+    auto it = bottle_monitors_.find(prefix_path);
+    if (it != bottle_monitors_.end())
+    {
+      bottle_monitors.emplace(prefix_path, it->second);
+      bottle_monitors_.erase(it);
+      continue;
+    }
     try
     {
-      bit = Helper::get_windows_bitness(prefix);
+      Glib::RefPtr<Gio::FileMonitor> monitor = Gio::File::create_for_path(prefix_path)->monitor_directory();
+      monitor->signal_changed().connect(sigc::bind(sigc::mem_fun(*this, &BottleManager::on_bottle_changed), prefix_path));
+      bottle_monitors.emplace(prefix_path, monitor);
     }
-    catch (const std::runtime_error& error)
+    catch (const Glib::Error& ex)
     {
-      main_window_.show_error_message(error.what());
+      std::cerr << "Error: Could not watch the bottle " << prefix_path << " for changes: " << ex.what() << std::endl;
     }
-    try
+  }
+  // Stop watching removed bottles
+  for (auto& [prefix_path, monitor] : bottle_monitors_)
+  {
+    monitor->cancel();
+  }
+  bottle_monitors_ = std::move(bottle_monitors);
+}
+
+/**
+ * \brief Read a single bottle from disk again within a thread (async), the bottle item is updated in place via a dispatcher
+ * (without rebuilding the bottle list).
+ * \param[in] bottle Bottle item to refresh
+ */
+void BottleManager::refresh_bottle(BottleItem& bottle)
+{
+  task_executor_.submit(
+      [this, prefix_path = bottle.wine_location().raw(), runner = bottle.runner(), is_wine64_bit = is_wine64_bit_](std::stop_token)
+      {
+        RefreshedBottle refreshed;
+        try
+        {
+          // Fingerprint is taken before scanning, so a change during the scan will trigger another refresh
+          string fingerprint = Helper::get_bottle_fingerprint(prefix_path);
+          refreshed.data = scan_wine_bottle(prefix_path);
+          refreshed.data.fingerprint = fingerprint;
+        }
+        catch (const std::exception& error)
+        {
+          refreshed.data.prefix = prefix_path;
+          refreshed.data.error_messages.emplace_back(error.what());
+        }
+        if (refreshed.data.config.runner != runner)
+        {
+          refreshed.is_runner_changed = true;
+          try
+          {
+            refreshed.wine_version = refreshed.data.config.runner.empty() ? WineRuntime::get_wine_version(is_wine64_bit)
+                                                                          : WineRuntime::get_runner_version(refreshed.data.config.runner);
+          }
+          catch (const std::exception& error)
+          {
+            refreshed.wine_version_error_message = error.what();
+          }
+        }
+        {
+          std::lock_guard<std::mutex> lock(refreshed_bottles_mutex_);
+          refreshed_bottles_.push_back(std::move(refreshed));
+        }
+        refresh_bottle_dispatcher_.emit();
+      });
+}
+
+/**
+ * \brief Store the error of a failed background task and show it in the GUI thread (called from the task)
+ * \param[in] message Error message
+ */
+void BottleManager::report_task_error(const Glib::ustring& message)
+{
+  std::cerr << "Error: " << message << std::endl;
+  {
+    std::lock_guard<std::mutex> lock(task_error_messages_mutex_);
+    task_error_messages_.push_back(message);
+  }
+  task_error_dispatcher_.emit();
+}
+
+/**
+ * \brief Signal handler when background task(s) failed, show the error messages
+ */
+void BottleManager::on_task_error()
+{
+  std::vector<Glib::ustring> error_messages;
+  {
+    std::lock_guard<std::mutex> lock(task_error_messages_mutex_);
+    error_messages.swap(task_error_messages_);
+  }
+  Glib::ustring message;
+  for (const Glib::ustring& error_message : error_messages)
+    message += (message.empty() ? "" : "\n\n") + error_message;
+  if (!message.empty())
+    main_window_.show_error_message(message);
+}
+
+/**
+ * \brief Signal handler when bottle(s) are rescanned, update the bottle items in place
+ */
+void BottleManager::on_refresh_bottle_finished()
+{
+  std::vector<RefreshedBottle> refreshed_bottles;
+  {
+    std::lock_guard<std::mutex> lock(refreshed_bottles_mutex_);
+    refreshed_bottles.swap(refreshed_bottles_);
+  }
+  for (RefreshedBottle& refreshed : refreshed_bottles)
+  {
+    BottleScanData& data = refreshed.data;
+    // The bottle could not be scanned at all, keep showing the previous data
+    if (data.fingerprint.empty())
     {
-      c_drive_location = Helper::get_c_letter_drive(prefix);
+      for (const string& error_message : data.error_messages)
+      {
+        main_window_.show_error_message(error_message);
+      }
+      continue;
     }
-    catch (const std::runtime_error& error)
+    // The bottle could be removed in the meantime (or the bottle list got rebuilt)
+    auto bottle_it = std::find_if(bottles_.begin(), bottles_.end(), [&data](const BottleItem& item) { return item.wine_location() == data.prefix; });
+    if (bottle_it == bottles_.end())
+      continue;
+    BottleItem& bottle = *bottle_it;
+    // Skip if the bottle didn't change since the last scan (eg. already refreshed)
+    auto it = bottle_fingerprints_.find(data.prefix);
+    if (it != bottle_fingerprints_.end() && it->second == data.fingerprint)
+      continue;
+
+    for (const string& error_message : data.error_messages)
     {
-      main_window_.show_error_message(error.what());
+      main_window_.show_error_message(error_message);
     }
-    try
+    bottle.name(data.config.name);
+    bottle.folder_name(data.folder_name);
+    bottle.description(data.config.description);
+    bottle.status(data.status);
+    bottle.windows(data.windows);
+    bottle.bit(data.bit);
+    bottle.wine_c_drive(data.c_drive_location);
+    bottle.wine_last_changed(data.last_time_wine_updated);
+    bottle.audio_driver(data.audio_driver);
+    bottle.virtual_desktop(data.virtual_desktop);
+    bottle.is_debug_logging(data.config.logging_enabled);
+    bottle.debug_log_level(data.config.debug_log_level);
+    bottle.env_vars(data.config.env_vars);
+    if (refreshed.is_runner_changed && bottle.runner() != data.config.runner)
     {
-      last_time_wine_updated = Helper::get_last_wine_updated(prefix);
+      bottle.runner(data.config.runner);
+      if (refreshed.wine_version_error_message.empty())
+        bottle.wine_version(refreshed.wine_version);
+      else
+        main_window_.show_error_message(refreshed.wine_version_error_message);
     }
-    catch (const std::runtime_error& error)
+    bottle.app_list(data.app_list);
+    bottle.update_ui();
+    bottle_fingerprints_[data.prefix] = data.fingerprint;
+    main_window_.refresh_bottle(bottle);
+  }
+}
+
+/**
+ * \brief Remove the trash folder of a removed bottle in the background, the progress is shown in the main window.
+ * When WineGUI is closed during the removal, the rest is removed during the next start-up.
+ * \param[in] trash_path Trash folder (see BottleRemover::move_to_trash())
+ */
+void BottleManager::remove_trash(const string& trash_path)
+{
+  {
+    std::lock_guard<std::mutex> lock(remove_progress_mutex_);
+    remove_progress_[trash_path] = 0.0;
+  }
+  on_remove_progress();
+  task_executor_.submit(
+      [this, trash_path](std::stop_token stop_token)
+      {
+        auto progress = [this, &trash_path](std::uint64_t entries_removed, std::uint64_t entries_total)
+        {
+          {
+            std::lock_guard<std::mutex> lock(remove_progress_mutex_);
+            remove_progress_[trash_path] = (entries_total > 0) ? static_cast<double>(entries_removed) / static_cast<double>(entries_total) : 1.0;
+          }
+          remove_progress_dispatcher_.emit();
+        };
+        try
+        {
+          BottleRemover::remove(trash_path, progress, stop_token);
+        }
+        catch (const std::runtime_error&)
+        {
+          // Already logged, the rest is tried again during the next start-up
+        }
+        {
+          std::lock_guard<std::mutex> lock(remove_progress_mutex_);
+          remove_progress_.erase(trash_path);
+        }
+        remove_progress_dispatcher_.emit();
+      });
+}
+
+/**
+ * \brief Remove all the selected bottles (after confirmation), the files are removed in the background
+ */
+void BottleManager::delete_selected_bottles()
+{
+  std::vector<BottleItem*> bottles = selected_bottles_;
+  std::set<string> prefix_paths;
+  for (const BottleItem* bottle : bottles)
+    prefix_paths.insert(bottle->wine_location());
+
+  Glib::ustring folder_names;
+  for (const BottleItem* bottle : bottles)
+  {
+    // Templates can only be removed together with all the machines using them
+    for (const string& derived_bottle : OverlayBottle::get_derived_bottles(bottle->wine_location()))
     {
-      main_window_.show_error_message(error.what());
+      if (!prefix_paths.contains(derived_bottle))
+      {
+        main_window_.show_error_message("Machine '" + bottle->folder_name() + "' is used as template by machine '" +
+                                        Helper::get_folder_name(derived_bottle) + "', remove or select it as well.");
+        return;
+      }
     }
+    folder_names += "\n" + Glib::Markup::escape_text(bottle->folder_name());
+  }
+  // Are you sure?
+  Glib::ustring confirm_message = "Are you sure you want to <b>PERMANENTLY</b> remove the following " + std::to_string(bottles.size()) +
+                                  " machines?\n" + folder_names + "\n\n<i>Note:</i> This action cannot be undone!";
+  if (!main_window_.show_confirm_dialog(confirm_message, true))
+    return; // Nothing, canceled
+
+  // Signal that bottle is removed
+  bottle_removed.emit();
+  // Remove the overlay bottles first, before their template is removed
+  std::stable_partition(bottles.begin(), bottles.end(),
+                        [](const BottleItem* bottle) { return OverlayBottle::is_overlay(bottle->wine_location()); });
+  Glib::ustring error_messages;
+  for (const BottleItem* bottle : bottles)
+  {
+    string prefix_path = bottle->wine_location();
     try
     {
-      audio_driver = Helper::get_audio_driver(prefix);
+      // The bottle is gone at once, the files are removed in the background
+      string trash_path =
+          OverlayBottle::is_overlay(prefix_path) ? OverlayBottle::move_to_trash(prefix_path) : BottleRemover::move_to_trash(prefix_path);
+      remove_trash(trash_path);
     }
     catch (const std::runtime_error& error)
     {
-      main_window_.show_error_message(error.what());
+      error_messages += "\n" + Glib::ustring(error.what());
     }
-    try
+  }
+  this->update_config_and_bottles("", false);
+  if (!error_messages.empty())
+    main_window_.show_error_message("Not all the machines could be removed:\n" + error_messages);
+}
+
+/**
+ * \brief Install a Winetricks package in the active bottle (or in all the selected bottles)
+ * \param[in] parent Parent GTK window were the request is coming from
+ * \param[in] message Shown in the busy dialog during the install
+ * \param[in] program Winetricks followed by its arguments
+ * \param[in] is_deinstall_mono Deinstall Wine Mono first (if installed), used before installing native .NET
+ */
+void BottleManager::install_package(Gtk::Window& parent, const Glib::ustring& message, const std::vector<string>& program, bool is_deinstall_mono)
+{
+  if (!is_template_not_in_use(is_batch_selection() ? selected_bottles_ : std::vector<BottleItem*>{active_bottle_}))
+    return;
+  if (is_batch_selection())
+  {
+    run_batch(parent, "Installing software", message, create_batch_jobs(program, false, is_deinstall_mono),
+              [this]() { finished_package_install_dispatcher.emit(); });
+    return;
+  }
+
+  // Before we execute the install, show busy dialog
+  main_window_.show_busy_install_dialog(parent, task_executor_.is_busy() ? message + "\n\n" + TaskQueuedMessage : message);
+
+  std::vector<string> deinstall_command;
+  if (is_deinstall_mono)
+    deinstall_command = get_deinstall_mono_command(*active_bottle_);
+  string wine_prefix = active_bottle_->wine_location();
+  bool is_debug_logging = active_bottle_->is_debug_logging();
+  int debug_log_level = active_bottle_->debug_log_level();
+  auto env_vars = get_winetricks_env_vars(*active_bottle_);
+  // finished_package_install_dispatcher signal is needed in order to close the busy dialog again
+  task_executor_.submit(
+      [this, wine_prefix, debug_log_level, deinstall_command, program, env_vars, logging_stderr = std::move(is_logging_stderr_),
+       debug_logging = std::move(is_debug_logging)](std::stop_token stop_token)
+      {
+        try
+        {
+          if (!deinstall_command.empty())
+          {
+            // First deinstall Mono then install native .NET
+            Helper::run_program(wine_prefix, debug_log_level, deinstall_command, "", {}, true, logging_stderr, debug_logging, stop_token);
+          }
+          Helper::run_program(wine_prefix, debug_log_level, program, "", env_vars, true, logging_stderr, debug_logging, stop_token);
+          Helper::wait_until_wineserver_is_terminated(wine_prefix, stop_token);
+        }
+        catch (const std::runtime_error& error)
+        {
+          report_task_error("Could not install the software.
+" + Glib::ustring(error.what()));
+        }
+        // Always close the busy dialog
+        finished_package_install_dispatcher.emit();
+      });
+}
+
+/**
+ * \brief Create a batch job for each selected bottle, running the program with the settings of that bottle
+ * \param[in] program Program followed by its arguments
+ * \param[in] is_under_wine Run the program under the Wine of the bottle (like wineboot), otherwise as-is (like winetricks)
+ * \param[in] is_deinstall_mono Deinstall Wine Mono first (if installed), used before installing native .NET
+ * \return Batch jobs, one for each selected bottle
+ */
+std::vector<BottleManager::BatchJob> BottleManager::create_batch_jobs(const std::vector<string>& program, bool is_under_wine, bool is_deinstall_mono)
+{
+  std::vector<BatchJob> jobs;
+  for (const BottleItem* bottle : selected_bottles_)
+  {
+    std::vector<std::vector<string>> commands;
+    if (is_deinstall_mono)
     {
-      windows = Helper::get_windows_version(prefix);
-      status = Helper::get_bottle_status(prefix);
+      std::vector<string> deinstall_command = get_deinstall_mono_command(*bottle);
+      if (!deinstall_command.empty())
+        commands.push_back(std::move(deinstall_command));
     }
-    catch (const std::runtime_error& error)
+    commands.push_back(program);
+    std::vector<std::pair<string, string>> env_vars;
+    if (is_under_wine)
+      commands.back().insert(commands.back().begin(), get_wine_executable(*bottle));
+    else
+      env_vars = get_winetricks_env_vars(*bottle);
+
+    // No error dialog for each failed bottle (give_error is false), the failures are reported together at the end
+    jobs.push_back({bottle->folder_name(),
+                    [commands, env_vars, wine_prefix = bottle->wine_location(), debug_log_level = bottle->debug_log_level(),
+                     debug_logging = bottle->is_debug_logging(), logging_stderr = is_logging_stderr_](std::stop_token stop_token)
+                    {
+                      int exit_code = 0;
+                      // Stop at the first failing command (eg. don't install .NET when Mono could not be removed)
+                      for (const std::vector<string>& command : commands)
+                      {
+                        exit_code = Helper::run_program(wine_prefix, debug_log_level, command, "", env_vars, false, logging_stderr, debug_logging,
+                                                        stop_token);
+                        if (exit_code != 0)
+                          break;
+                      }
+                      Helper::wait_until_wineserver_is_terminated(wine_prefix, stop_token);
+                      return exit_code;
+                    }});
+  }
+  return jobs;
+}
+
+/**
+ * \brief Run the jobs of a batch operation in the background, at most batch_parallelism_ bottles at the same time.
+ * The progress is shown in the busy dialog, the result of all bottles is reported at the end (see on_batch_finished()).
+ * \param[in] parent Parent GTK window were the request is coming from
+ * \param[in] heading Heading of the busy dialog and the result
+ * \param[in] message Shown in the busy dialog
+ * \param[in] jobs A job for each bottle
+ * \param[in] finished Called (in the GUI thread) when all the jobs are finished, before the result is shown
+ */
+void BottleManager::run_batch(Gtk::Window& parent,
+                              const Glib::ustring& heading,
+                              const Glib::ustring& message,
+                              std::vector<BatchJob> jobs,
+                              std::function<void()> finished)
+{
+  if (is_batch_running_)
+  {
+    main_window_.show_error_message("There is already a batch operation running on the Windows Machines. Please wait...");
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    is_batch_running_ = true;
+    batch_stop_source_ = std::stop_source();
+    batch_heading_ = heading;
+    batch_finished_ = std::move(finished);
+    batch_total_ = jobs.size();
+    batch_done_ = 0;
+    batch_errors_.clear();
+  }
+  main_window_.show_busy_progress_dialog(parent, heading,
+                                         message + "\nRunning on " + std::to_string(jobs.size()) + " Windows Machines, at most " +
+                                             std::to_string(batch_parallelism_) + " at the same time.");
+
+  auto shared_jobs = std::make_shared<const std::vector<BatchJob>>(std::move(jobs));
+  auto next_job = std::make_shared<std::atomic<std::size_t>>(0);
+  std::size_t worker_count = std::min<std::size_t>(std::clamp(batch_parallelism_, 1, static_cast<int>(MaxBatchWorkers)), shared_jobs->size());
+  auto running_workers = std::make_shared<std::atomic<std::size_t>>(worker_count);
+  // Each worker takes the next bottle until all bottles are done, the last worker reports the result
+  // The batch has its own workers, so a large batch doesn't delay (or get delayed by) the other tasks
+  for (std::size_t i = 0; i < worker_count; i++)
+  {
+    batch_executor_.submit(
+        [this, shared_jobs, next_job, running_workers, batch_stop_token = batch_stop_source_.get_token()](std::stop_token executor_stop_token)
+        {
+          // Stop the running programs when either the batch is cancelled or the executor shuts down
+          std::stop_source job_stop_source;
+          std::stop_callback stop_on_shutdown(executor_stop_token, [&job_stop_source] { job_stop_source.request_stop(); });
+          std::stop_callback stop_on_cancel(batch_stop_token, [&job_stop_source] { job_stop_source.request_stop(); });
+          std::stop_token stop_token = job_stop_source.get_token();
+          for (std::size_t index = (*next_job)++; index < shared_jobs->size(); index = (*next_job)++)
+          {
+            if (stop_token.stop_requested())
+              break;
+            const BatchJob& job = (*shared_jobs)[index];
+            int exit_code = 0;
+            string error_message;
+            try
+            {
+              exit_code = job.run(stop_token);
+            }
+            catch (const std::exception& error)
+            {
+              error_message = error.what();
+            }
+            {
+              std::lock_guard<std::mutex> lock(batch_mutex_);
+              batch_done_++;
+              if (!error_message.empty())
+                batch_errors_.push_back(job.folder_name + " (" + error_message + ")");
+              else if (exit_code == 127)
+                batch_errors_.push_back(job.folder_name + " (could not be started)");
+              else if (exit_code != 0 && !stop_token.stop_requested())
+                batch_errors_.push_back(job.folder_name + " (exit code " + std::to_string(exit_code) + ")");
+            }
+            batch_progress_dispatcher_.emit();
+          }
+          if (--(*running_workers) == 0)
+            batch_finished_dispatcher_.emit();
+        });
+  }
+}
+
+/**
+ * \brief Check if multiple bottles are selected, the operations then run on all the selected bottles
+ * \return True if there are multiple bottles selected, otherwise false
+ */
+bool BottleManager::is_batch_selection() const
+{
+  return selected_bottles_.size() > 1;
+}
+
+bool BottleManager::is_bottle_not_null()
+{
+  bool is_null = (active_bottle_ == nullptr);
+  if (is_null)
+  {
+    main_window_.show_error_message("No Windows Machine selected/empty. First create a new machine!\n\nAborted.");
+  }
+  return !is_null;
+}
+
+/**
+ * \brief Check that none of the bottles is used as template by a mounted overlay bottle, the template files are read-only
+ * as long as the machines using them exist. Shows an error message otherwise.
+ * \param[in] bottles Bottles that are going to be changed
+ * \return True if the bottles can be changed, otherwise false
+ */
+bool BottleManager::is_template_not_in_use(const std::vector<BottleItem*>& bottles)
+{
+  for (const BottleItem* bottle : bottles)
+  {
+    if (OverlayBottle::is_template_in_use(bottle->wine_location()))
     {
-      main_window_.show_error_message(error.what());
+      main_window_.show_error_message("Machine '" + bottle->folder_name() +
+                                      "' is used as template by other machines (sharing its files), it can't be changed while those "
+                                      "machines exist.\n\nAborted.");
+      return false;
     }
+  }
+  return true;
+}
+
+/**
+ * \brief Get the wine executable of the active bottle: the pinned runner or the Wine found in PATH
+ * \return Wine executable (name in PATH or full path)
+ */
+string BottleManager::get_wine_executable() const
+{
+  return WineRuntime::get_wine_executable((active_bottle_ != nullptr) ? active_bottle_->runner() : "", is_wine64_bit_);
+}
+
+/**
+ * \brief Get the wine executable of the provided bottle: the pinned runner or the Wine found in PATH
+ * \param[in] bottle Wine bottle
+ * \return Wine executable (name in PATH or full path)
+ */
+string BottleManager::get_wine_executable(const BottleItem& bottle) const
+{
+  return WineRuntime::get_wine_executable(bottle.runner(), is_wine64_bit_);
+}
+
+/**
+ * \brief Get the environment variables for winetricks, so winetricks uses the pinned runner of the bottle (instead of the Wine found in PATH)
+ * \param[in] bottle Wine bottle
+ * \return Environment variables (WINE and WINESERVER)
+ */
+std::vector<std::pair<string, string>> BottleManager::get_winetricks_env_vars(const BottleItem& bottle) const
+{
+  return {{"WINE", get_wine_executable(bottle)}, {"WINESERVER", WineRuntime::get_wineserver_executable(bottle.runner())}};
+}
+
+/**
+ * \brief Wine Mono deinstall command, run before installing native .NET
+ * \param[in] bottle Wine bottle
+ * \return uninstall Mono command (program followed by its arguments)
+ * Note: When nothing todo, the command will be an empty list.
+ */
+std::vector<string> BottleManager::get_deinstall_mono_command(const BottleItem& bottle)
+{
+  std::vector<string> command;
+  string wine_prefix = bottle.wine_location();
+  string guid;
+  try
+  {
+    guid = Helper::get_wine_guid(wine_prefix, "Wine Mono Runtime");
+  }
+  catch (const std::runtime_error& error)
+  {
+    std::cout << "Error: " << error.what() << std::endl;
+  }
+
+  if (!guid.empty())
+  {
+    // Use the wine binary matching the bottle bitness (of the pinned runner, if any)
+    string wine = WineRuntime::get_wine_executable(bottle.runner(), bottle.bit() == BottleTypes::Bit::win64);
+    command = {wine, "uninstaller", "--remove", "{" + guid + "}"};
+  }
+  return command;
+}
+
+/**
+ * \brief Get Bottle Paths
+ * \param bottle_location Directory containing the Wine bottles
+ * \param is_display_default_wine_machine Also include the default Wine machine (~/.wine)
+ * \throws runtime_error when we can not created a Wine bottle directory or configuration folder could not be found
+ * \return Return a map of bottle paths (string) and modification time (in ms)
+ */
+std::vector<string> BottleManager::get_bottle_paths(const string& bottle_location, bool is_display_default_wine_machine)
+{
+  if (!Helper::dir_exists(bottle_location))
+  {
+    // Create bottle prefix directory if not exist yet
+    if (!Helper::create_dir(bottle_location))
+    {
+      throw std::runtime_error("Failed to create the Wine bottle directory: " + bottle_location);
+    }
+  }
+  if (Helper::dir_exists(bottle_location))
+  {
+    // Continue
+    return Helper::get_bottles_paths(bottle_location, is_display_default_wine_machine);
+  }
+  else
+  {
+    throw std::runtime_error("Configuration directory still not found (probably no permissions):\n" + bottle_location);
+  }
+  // Otherwise empty
+  return std::vector<string>();
+}
+
+/**
+ * \brief Read the bottle directories and scan all the bottles, including the Wine version.
+ * Only plain data is collected (no GTK calls), so this method is safe to run in a thread.
+ * \param bottle_location Directory containing the Wine bottles
+ * \param is_display_default_wine_machine Also include the default Wine machine (~/.wine)
+ * \param is_wine64_bit Use the 64-bit Wine executable
+ * \param runner_directories Custom directories with Wine runners
+ * \return Scan result of all the bottles
+ */
+BottleListScanData BottleManager::scan_bottles(const string& bottle_location,
+                                               bool is_display_default_wine_machine,
+                                               bool is_wine64_bit,
+                                               const std::vector<string>& runner_directories)
+{
+  BottleListScanData scan_result;
+  // Get the bottle directories
+  std::vector<string> bottle_dirs;
+  try
+  {
+    bottle_dirs = get_bottle_paths(bottle_location, is_display_default_wine_machine);
+  }
+  catch (const std::runtime_error& error)
+  {
+    scan_result.error_messages.emplace_back(error.what());
+    scan_result.is_aborted = true;
+    return scan_result;
+  }
+
+  if (!bottle_dirs.empty())
+  {
+    // Discover the Wine runners, which can be pinned per bottle (only changed runner binaries are executed)
+    WineRuntime::discover_runners(runner_directories);
+    // Read wine version of the Wine found in PATH (used by all bottles without a pinned runner)
     try
     {
-      virtual_desktop = Helper::get_virtual_desktop(prefix);
+      scan_result.wine_version = WineRuntime::get_wine_version(is_wine64_bit);
     }
     catch (const std::runtime_error& error)
     {
-      main_window_.show_error_message(error.what());
+      scan_result.error_messages.emplace_back(error.what());
+    }
+    scan_result.bottles = scan_wine_bottles(bottle_dirs);
+  }
+  return scan_result;
+}
+
+/**
+ * \brief Retrieve all the details of a single Wine bottle from disk.
+ * Only plain data is collected (no GTK calls), so this method is safe to run in a worker thread.
+ * \param[in] prefix Bottle prefix path
+ * \return Bottle scan data, including the error messages that occurred during the scan
+ */
+BottleScanData BottleManager::scan_wine_bottle(const string& prefix)
+{
+  BottleScanData data;
+  data.prefix = prefix;
+
+  // Retrieve bottle config data & custom app list
+  std::tie(data.config, data.app_list) = BottleConfigFile::read_config_file(prefix);
+
+  try
+  {
+    data.folder_name = Helper::get_folder_name(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.bit = Helper::get_windows_bitness(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.c_drive_location = Helper::get_c_letter_drive(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.last_time_wine_updated = Helper::get_last_wine_updated(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.audio_driver = Helper::get_audio_driver(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.windows = Helper::get_windows_version(prefix);
+    data.status = Helper::get_bottle_status(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  try
+  {
+    data.virtual_desktop = Helper::get_virtual_desktop(prefix);
+  }
+  catch (const std::runtime_error& error)
+  {
+    data.error_messages.emplace_back(error.what());
+  }
+  return data;
+}
+
+/**
+ * \brief Scan the Wine bottles in parallel on a bounded pool of worker threads.
+ * The bottles are independent of each other, the results are stored in the same order as the bottle directories.
+ * Bottles which files didn't change since the previous scan are loaded from the persistent bottle cache instead.
+ * \param[in] bottle_dirs The list of bottle directories
+ * \return Bottle scan data of each bottle directory
+ */
+std::vector<BottleScanData> BottleManager::scan_wine_bottles(const std::vector<string>& bottle_dirs)
+{
+  std::vector<BottleScanData> results(bottle_dirs.size());
+  std::map<string, BottleCacheData> cache = BottleCacheFile::read_cache_file();
+  // Fingerprints are taken before scanning, so a change during the scan will invalidate the cache entry next time
+  std::vector<string> fingerprints(bottle_dirs.size());
+  std::vector<std::size_t> changed_indexes;
+  for (std::size_t index = 0; index < bottle_dirs.size(); index++)
+  {
+    fingerprints[index] = Helper::get_bottle_fingerprint(bottle_dirs[index]);
+    auto it = cache.find(bottle_dirs[index]);
+    if (it != cache.end() && it->second.fingerprint == fingerprints[index])
+    {
+      results[index] = it->second.bottle;
+      // Bottle config & custom app list are not cached
+      std::tie(results[index].config, results[index].app_list) = BottleConfigFile::read_config_file(bottle_dirs[index]);
+    }
+    else
+    {
+      changed_indexes.push_back(index);
+    }
+  }
+
+  std::atomic<std::size_t> next_index{0};
+  auto worker = [&bottle_dirs, &results, &changed_indexes, &next_index]
+  {
+    std::size_t next;
+    while ((next = next_index++) < changed_indexes.size())
+    {
+      std::size_t index = changed_indexes[next];
+      try
+      {
+        results[index] = scan_wine_bottle(bottle_dirs[index]);
+      }
+      catch (const std::exception& error)
+      {
+        results[index].prefix = bottle_dirs[index];
+        results[index].error_messages.emplace_back(error.what());
+      }
+    }
+  };
+
+  unsigned int worker_count = std::clamp(std::thread::hardware_concurrency(), 1U, MaxScanThreads);
+  worker_count = std::min(worker_count, static_cast<unsigned int>(changed_indexes.size()));
+  std::vector<std::thread> workers;
+  workers.reserve(worker_count);
+  for (unsigned int i = 0; i < worker_count; i++)
+  {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers)
+  {
+    thread.join();
+  }
+  for (std::size_t index = 0; index < bottle_dirs.size(); index++)
+  {
+    results[index].fingerprint = fingerprints[index];
+  }
+
+  // Update the cache, bottles with scan errors are not cached (and removed bottles are dropped)
+  bool is_cache_changed = false;
+  std::map<string, BottleCacheData> new_cache;
+  for (std::size_t index = 0; index < bottle_dirs.size(); index++)
+  {
+    const BottleScanData& result = results[index];
+    if (!result.error_messages.empty())
+      continue;
+    BottleCacheData& cache_data = new_cache[bottle_dirs[index]];
+    cache_data.fingerprint = fingerprints[index];
+    cache_data.bottle = result;
+    cache_data.bottle.config = BottleConfigData();
+    cache_data.bottle.app_list.clear();
+    if (std::find(changed_indexes.begin(), changed_indexes.end(), index) != changed_indexes.end())
+      is_cache_changed = true;
+  }
+  if (is_cache_changed || new_cache.size() != cache.size())
+    BottleCacheFile::write_cache_file(new_cache);
+  return results;
+}
+
+/**
+ * \brief Create wine BottleItem objects and add them to a list.
+ * \param[in] scan_result  The scanned bottles
+ * \returns Array of Bottle Items
+ */
+std::list<BottleItem> BottleManager::create_wine_bottles(BottleListScanData& scan_result)
+{
+  std::list<BottleItem> bottles;
+  Glib::ustring wine_version = scan_result.wine_version;
+
+  // Creating the GTK widgets needs to happen in the GUI thread, in the same (sorted) order as the bottle directories
+  for (BottleScanData& data : scan_result.bottles)
+  {
+    for (const string& error_message : data.error_messages)
+    {
+      main_window_.show_error_message(error_message);
     }
 
     // Convert to Glib ustrings
-    Glib::ustring name(bottle_config.name);
-    Glib::ustring description(bottle_config.description);
-    Glib::ustring prefix_path(prefix);
-    BottleItem* bottle = new BottleItem(name, folder_name, description, status, windows, bit, wine_version, is_wine64_bit_, prefix_path,
-                                        c_drive_location, last_time_wine_updated, audio_driver, virtual_desktop, bottle_config.logging_enabled,
-                                        bottle_config.debug_log_level, bottle_config.env_vars, bottle_app_list);
-    bottles.emplace_back(*bottle);
+    Glib::ustring name(data.config.name);
+    Glib::ustring folder_name(data.folder_name);
+    Glib::ustring description(data.config.description);
+    Glib::ustring prefix_path(data.prefix);
+    Glib::ustring c_drive_location(data.c_drive_location);
+    Glib::ustring last_time_wine_updated(data.last_time_wine_updated);
+    Glib::ustring virtual_desktop(data.virtual_desktop);
+    // Bottles with a pinned runner show the version of that runner
+    Glib::ustring bottle_wine_version = wine_version;
+    if (!data.config.runner.empty())
+      bottle_wine_version = WineRuntime::get_runner_version(data.config.runner);
+    BottleItem bottle(name, folder_name, description, data.status, data.windows, data.bit, bottle_wine_version, is_wine64_bit_, prefix_path,
+                      c_drive_location, last_time_wine_updated, data.audio_driver, virtual_desktop, data.config.logging_enabled,
+                      data.config.debug_log_level, data.config.env_vars, data.app_list);
+    bottle.runner(data.config.runner);
+    // The copy constructor creates the GUI of the bottle item
+    bottles.emplace_back(bottle);
+    bottle_fingerprints_[data.prefix] = data.fingerprint;
   }
   return bottles;
 }
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    bottle_remover.cc
+ * \brief   Crash-safe background removal of Wine bottles
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bottle_remover.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+static const std::string TrashPrefix = ".winegui-trash-";           /*!< Name prefix of bottle folders being removed (hidden folder) */
+static const unsigned int MaxRemoveWorkers = 8;                     /*!< Upper limit of directories emptied in parallel */
+static const std::chrono::milliseconds ProgressInterval{100};       /*!< Interval between progress reports */
+static const mode_t OwnerPermissions = S_IRUSR | S_IWUSR | S_IXUSR; /*!< Required to remove the contents of a directory */
+
+/**
+ * \brief Rename the bottle folder to a unique trash name in the same parent directory, the bottle disappears at once
+ * \param[in] prefix_path Bottle folder
+ * \throws runtime_error when the folder could not be renamed
+ * \return Full path of the trash folder, to be removed with remove()
+ */
+std::string BottleRemover::move_to_trash(const std::string& prefix_path)
+{
+  std::string::size_type separator = prefix_path.find_last_of('/');
+  std::string parent_path = (separator != std::string::npos) ? prefix_path.substr(0, separator) : ".";
+  std::string name = (separator != std::string::npos) ? prefix_path.substr(separator + 1) : prefix_path;
+  auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  std::string trash_path = parent_path + "/" + TrashPrefix + name + "." + std::to_string(timestamp);
+  if (rename(prefix_path.c_str(), trash_path.c_str()) != 0)
+  {
+    std::cerr << "Error: Couldn't move Wine bottle to trash. Wine prefix path: " << prefix_path << ": " << strerror(errno) << std::endl;
+    throw std::runtime_error("Something went wrong when removing the Windows Machine.\n\nFull path location: " + prefix_path + " (" +
+                             strerror(errno) + ")");
+  }
+  return trash_path;
+}
+
+/**
+ * \brief Remove the folder including its contents, without following symbolic links or crossing mounts
+ * \param[in] path Folder to remove (normally the trash folder of a bottle)
+ * \param[in] progress Optional progress callback, called from the calling thread with the removed and total number of entries
+ * \param[in] stop_token Stops the removal when requested, the rest is left behind
+ * \throws runtime_error when the folder could not be removed completely
+ * \return True when removed, false when the removal got stopped
+ */
+bool BottleRemover::remove(const std::string& path, const ProgressCallback& progress, std::stop_token stop_token)
+{
+  struct stat path_stat;
+  if (lstat(path.c_str(), &path_stat) != 0)
+  {
+    std::cerr << "Error: Couldn't remove, path doesn't exists: " << path << std::endl;
+    throw std::runtime_error("Could not remove, path doesn't exists: " + path);
+  }
+  if (!S_ISDIR(path_stat.st_mode))
+  {
+    if (unlink(path.c_str()) != 0)
+      throw std::runtime_error("Could not remove: " + path + " (" + strerror(errno) + ")");
+    return true;
+  }
+  if ((path_stat.st_mode & OwnerPermissions) != OwnerPermissions)
+    chmod(path.c_str(), path_stat.st_mode | OwnerPermissions);
+
+  // Walk the directory tree first, parent directories come before their sub-directories
+  std::vector<std::string> directories{path};
+  std::uint64_t entries_total = 1;
+  collect_directories(path, path_stat.st_dev, directories, entries_total);
+
+  std::atomic<std::uint64_t> entries_removed = 0;
+  std::atomic<std::size_t> next_directory = 0;
+  std::mutex mutex;
+  std::condition_variable finished_cv;
+  std::string error_message;
+  unsigned int running = std::clamp(std::thread::hardware_concurrency(), 1U, MaxRemoveWorkers);
+  running = static_cast<unsigned int>(std::min<std::size_t>(running, directories.size()));
+
+  // Empty the directories in parallel (all entries except sub-directories)
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < running; ++i)
+  {
+    workers.emplace_back(
+        [&]
+        {
+          for (std::size_t index = next_directory++; index < directories.size() && !stop_token.stop_requested(); index = next_directory++)
+          {
+            std::string error = remove_files(directories[index], entries_removed);
+            if (!error.empty())
+            {
+              std::lock_guard<std::mutex> lock(mutex);
+              if (error_message.empty())
+                error_message = error;
+            }
+          }
+          std::lock_guard<std::mutex> lock(mutex);
+          --running;
+          finished_cv.notify_all();
+        });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running > 0)
+    {
+      finished_cv.wait_for(lock, ProgressInterval);
+      if (progress && running > 0)
+      {
+        lock.unlock();
+        progress(entries_removed, entries_total);
+        lock.lock();
+      }
+    }
+  }
+  for (std::thread& worker : workers)
+    worker.join();
+  if (stop_token.stop_requested())
+    return false;
+
+  // The (now empty) directories, deepest first
+  for (auto it = directories.rbegin(); it != directories.rend(); ++it)
+  {
+    if (rmdir(it->c_str()) == 0)
+      entries_removed++;
+    else if (errno != ENOENT && error_message.empty())
+      error_message = "Could not remove directory: " + *it + " (" + strerror(errno) + ")";
+  }
+  if (!error_message.empty())
+  {
+    std::cerr << "Error: " << error_message << std::endl;
+    throw std::runtime_error(error_message);
+  }
+  if (progress)
+    progress(entries_total, entries_total);
+  return true;
+}
+
+/**
+ * \brief Find the trash folders left behind in a directory (eg. after a crash during the removal)
+ * \param[in] dir_path Directory (like the bottle location)
+ * \return Full paths of the trash folders
+ */
+std::vector<std::string> BottleRemover::find_trash(const std::string& dir_path)
+{
+  std::vector<std::string> trash;
+  DIR* dir = opendir(dir_path.c_str());
+  if (dir == nullptr)
+    return trash;
+  while (dirent* entry = readdir(dir))
+  {
+    if (is_trash(entry->d_name))
+      trash.push_back(dir_path + "/" + entry->d_name);
+  }
+  closedir(dir);
+  return trash;
+}
+
+/**
+ * \brief Check if the folder name is a trash name (a bottle being removed)
+ * \param[in] name Folder name (not the full path)
+ * \return true if trash, otherwise false
+ */
+bool BottleRemover::is_trash(std::string_view name)
+{
+  return name.starts_with(TrashPrefix);
+}
+
+/**
+ * \brief Collect all sub-directories (recursively) and count the entries to remove,
+ * directories without owner permissions get them (otherwise their contents can't be removed)
+ * \param[in] dir_path Directory
+ * \param[in] device Device of the removed folder, directories on other devices (mounts) are not entered
+ * \param[in,out] directories Found directories, in pre-order
+ * \param[in,out] entries_total Number of entries (files, links and directories)
+ */
+void BottleRemover::collect_directories(const std::string& dir_path,
+                                        dev_t device,
+                                        std::vector<std::string>& directories,
+                                        std::uint64_t& entries_total)
+{
+  DIR* dir = opendir(dir_path.c_str());
+  if (dir == nullptr)
+    return;
+  std::vector<std::string> sub_dirs;
+  while (dirent* entry = readdir(dir))
+  {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    entries_total++;
+    struct stat entry_stat;
+    if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN)
+      continue;
+    if (fstatat(dirfd(dir), entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISDIR(entry_stat.st_mode) || entry_stat.st_dev != device)
+      continue;
+    if ((entry_stat.st_mode & OwnerPermissions) != OwnerPermissions)
+      fchmodat(dirfd(dir), entry->d_name, entry_stat.st_mode | OwnerPermissions, 0);
+    sub_dirs.push_back(dir_path + "/" + entry->d_name);
+  }
+  closedir(dir);
+  for (const std::string& sub_dir : sub_dirs)
+  {
+    directories.push_back(sub_dir);
+    collect_directories(sub_dir, device, directories, entries_total);
+  }
+}
+
+/**
+ * \brief Remove all entries of a single directory, except its sub-directories
+ * \param[in] dir_path Directory
+ * \param[in,out] entries_removed Number of removed entries (shared between the workers)
+ * \return Error message of the first failure, empty on success
+ */
+std::string BottleRemover::remove_files(const std::string& dir_path, std::atomic<std::uint64_t>& entries_removed)
+{
+  DIR* dir = opendir(dir_path.c_str());
+  if (dir == nullptr)
+    return "Could not open directory: " + dir_path + " (" + strerror(errno) + ")";
+  std::string error_message;
+  while (dirent* entry = readdir(dir))
+  {
+    if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+      continue;
+    // Sub-directories are removed after they are emptied (also mounts, which will then fail)
+    if (entry->d_type == DT_DIR)
+      continue;
+    if (entry->d_type == DT_UNKNOWN)
+    {
+      struct stat entry_stat;
+      if (fstatat(dirfd(dir), entry->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(entry_stat.st_mode))
+        continue;
+    }
+    if (unlinkat(dirfd(dir), entry->d_name, 0) == 0)
+      entries_removed++;
+    else if (errno != ENOENT && error_message.empty())
+      error_message = "Could not remove: " + dir_path + "/" + entry->d_name + " (" + strerror(errno) + ")";
+  }
+  closedir(dir);
+  return error_message;
+}
@@ -24,7 +24,7 @@
  * \brief Constructor
  * \param parent Reference to parent GTK+ Window
  */
-BusyDialog::BusyDialog(Gtk::Window& parent) : Gtk::Dialog("Applying Changes"), default_parent_(parent)
+BusyDialog::BusyDialog(Gtk::Window& parent) : Gtk::Dialog("Applying Changes"), default_parent_(parent), cancel_button_(nullptr)
 {
   set_transient_for(parent);
   set_default_size(400, 120);
@@ -45,6 +45,9 @@ BusyDialog::BusyDialog(Gtk::Window& parent) : Gtk::Dialog("Applying Changes"), d
   box->pack_start(message_label, true, false);
   box->pack_start(loading_bar, true, false);
 
+  cancel_button_ = add_button("Cancel", Gtk::RESPONSE_CANCEL);
+  cancel_button_->set_no_show_all(true);
+
   show_all_children();
 }
 
@@ -66,6 +69,30 @@ void BusyDialog::set_message(const Glib::ustring& heading_text, const Glib::ustr
   this->message_label.set_text(message + " Please wait...");
 }
 
+/**
+ * \brief Show the actual progress, instead of pulsing the loading bar (until the dialog is shown again)
+ * \param[in] fraction Progress between 0.0 and 1.0
+ */
+void BusyDialog::set_progress(double fraction)
+{
+  if (!timer_.empty() && timer_.connected())
+  {
+    timer_.disconnect();
+  }
+  loading_bar.set_fraction(fraction);
+  loading_bar.set_show_text(true);
+}
+
+/**
+ * \brief Show or hide the cancel button. The cancel signal is emitted when clicked.
+ * \param[in] cancellable Whether the task can be cancelled by the user
+ */
+void BusyDialog::set_cancellable(bool cancellable)
+{
+  cancel_button_->set_sensitive(true);
+  cancel_button_->set_visible(cancellable);
+}
+
 /**
  * \brief Show the busy dialog (override the show(), calls parent show())
  */
@@ -76,6 +103,7 @@ void BusyDialog::show()
     timer_.disconnect();
   }
 
+  loading_bar.set_show_text(false);
   int time_interval = 200;
   timer_ = Glib::signal_timeout().connect(sigc::mem_fun(*this, &BusyDialog::pulsing), time_interval);
   Gtk::Dialog::show();
@@ -97,6 +125,20 @@ void BusyDialog::close()
   Gtk::Dialog::close();
 }
 
+/**
+ * \brief Signal handler when a dialog button is clicked
+ * \param[in] response_id Response of the clicked button
+ */
+void BusyDialog::on_response(int response_id)
+{
+  if (response_id == Gtk::RESPONSE_CANCEL)
+  {
+    // Avoid multiple presses, the dialog stays open until the task is stopped
+    cancel_button_->set_sensitive(false);
+    cancel.emit();
+  }
+}
+
 /**
  * \brief Trigger the loading bar,
  * until timer is disconnected.
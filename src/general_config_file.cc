@@ -57,6 +57,12 @@ bool GeneralConfigFile::write_config_file(const GeneralConfigData& general_confi
     keyfile.set_string("General", "DefaultFolder", general_config.default_folder);
     keyfile.set_boolean("General", "DisplayDefaultWineMachine", general_config.display_default_wine_machine);
     keyfile.set_boolean("General", "EnableLoggingStderr", general_config.enable_logging_stderr);
+    keyfile.set_integer("General", "BatchParallelism", general_config.batch_parallelism);
+    if (!general_config.runner_directories.empty())
+    {
+      std::vector<Glib::ustring> runner_directories(general_config.runner_directories.begin(), general_config.runner_directories.end());
+      keyfile.set_string_list("General", "RunnerDirectories", runner_directories);
+    }
     success = keyfile.save_to_file(config_file_path);
   }
   catch (const Glib::Error& ex)
@@ -98,6 +104,7 @@ GeneralConfigData GeneralConfigFile::read_config_file()
   general_config.default_folder = final_default_prefix_folder;
   general_config.display_default_wine_machine = true;
   general_config.enable_logging_stderr = true;
+  general_config.batch_parallelism = 4;
 
   // Check if config file exists
   if (!Glib::file_test(config_file_path, Glib::FileTest::FILE_TEST_IS_REGULAR))
@@ -114,6 +121,17 @@ GeneralConfigData GeneralConfigFile::read_config_file()
       general_config.default_folder = keyfile.get_string("General", "DefaultFolder");
       general_config.display_default_wine_machine = keyfile.get_boolean("General", "DisplayDefaultWineMachine");
       general_config.enable_logging_stderr = keyfile.get_boolean("General", "EnableLoggingStderr");
+      // Optional: added later, older config files don't have it yet
+      if (keyfile.has_key("General", "BatchParallelism"))
+        general_config.batch_parallelism = keyfile.get_integer("General", "BatchParallelism");
+      // Optional: custom Wine runner directories
+      if (keyfile.has_key("General", "RunnerDirectories"))
+      {
+        for (const Glib::ustring& directory : keyfile.get_string_list("General", "RunnerDirectories"))
+        {
+          general_config.runner_directories.push_back(directory);
+        }
+      }
     }
     catch (const Glib::Error& ex)
     {
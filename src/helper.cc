@@ -19,13 +19,21 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "helper.h"
+#include "bottle_remover.h"
+#include "log_writer.h"
+#include "process_runner.h"
+#include "shell_link.h"
 #include "wine_defaults.h"
+#include "wine_registry.h"
+#include "wine_registry_writer.h"
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <cstring>
 #include <ctime>
 #include <fcntl.h>
 #include <fstream>
+#include <functional>
 #include <giomm/file.h>
 #include <glibmm/fileutils.h>
 #include <glibmm/miscutils.h>
@@ -33,11 +41,16 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <poll.h>
 #include <pwd.h>
 #include <regex>
+#include <sstream>
 #include <stdexcept>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <thread>
 #include <time.h>
 #include <tuple>
 #include <unistd.h>
@@ -70,6 +83,20 @@ static const string RegKeyVirtualDesktop = "[Software\\\\Wine\\\\Explorer]";
 static const string RegKeyVirtualDesktopResolution = "[Software\\\\Wine\\\\Explorer\\\\Desktops]";
 static const string RegKeyDllOverrides = "[Software\\\\Wine\\\\DllOverrides]";
 static const string RegKeyMenuFiles = "[Software\\\\Wine\\\\MenuFiles]";
+static const string RegKeyUninstall = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\"; // Append the GUID (partial key)
+static const string RegKeyUninstallList = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall]";
+static const string RegKeyUninstallList64 = "[Software\\\\Wow6432Node\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall]";
+static const string RegKeyFonts = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Fonts]";
+static const string RegKeyFonts64 = "[Software\\\\Wow6432Node\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Fonts]";
+
+// Reg key paths (unescaped, used when writing to the registry)
+static const string RegPathName9x = "Software\\Microsoft\\Windows\\CurrentVersion";
+static const string RegPathNameNT = "Software\\Microsoft\\Windows NT\\CurrentVersion";
+static const string RegPathType = "System\\CurrentControlSet\\Control\\ProductOptions";
+static const string RegPathWine = "Software\\Wine";
+static const string RegPathAudio = "Software\\Wine\\Drivers";
+static const string RegPathVirtualDesktop = "Software\\Wine\\Explorer";
+static const string RegPathVirtualDesktopResolution = "Software\\Wine\\Explorer\\Desktops";
 
 // Reg names
 static const string RegNameNTVersion = "CurrentVersion";
@@ -86,6 +113,9 @@ static const string RegNameVirtualDesktopDefault = "Default";
 static const string RegValueMenu = "\\Start Menu\\";
 static const string RegValueDesktop = "\\Desktop\\";
 
+// Wineserver wait
+static const int WineserverPollInterval = 100; /*!< Interval in ms to check the stop token (or the lock without pidfd support) */
+
 // Other files
 static const string WineGuiMetaFile = ".winegui.conf";
 static const string UpdateTimestamp = ".update-timestamp";
@@ -128,6 +158,122 @@ static const struct
 //// Size of Windows Versions struct, see above!
 static const unsigned int WindowsStructSize = 20;
 
+/**
+ * \brief File extension (lower case) to icon name table, used by string_to_icon().
+ * \note Keep the table sorted by extension, it's searched with a binary search (checked at compile time).
+ */
+using ExtensionIcon = std::pair<std::string_view, std::string_view>; /*!< File extension + icon name */
+static constexpr std::array<ExtensionIcon, 104> ExtensionIcons{{
+    {"ai", "image_file"},
+    {"aif", "multimedia_file"},
+    {"avi", "multimedia_file"},
+    {"bat", "default_app_file"},
+    {"bin", "default_app_file"},
+    {"bmp", "image_file"},
+    {"c", "text_file"},
+    {"cc", "text_file"},
+    {"cda", "multimedia_file"},
+    {"cgi", "text_file"},
+    {"class", "text_file"},
+    {"cmd", "default_app_file"},
+    {"com", "default_app_file"},
+    {"cpp", "text_file"},
+    {"cs", "text_file"},
+    {"css", "html_document"},
+    {"csv", "excel_document"},
+    {"desktop", "default_app_file"},
+    {"doc", "word_document"},
+    {"docb", "word_document"},
+    {"docm", "word_document"},
+    {"docx", "word_document"},
+    {"dot", "word_document"},
+    {"dotm", "word_document"},
+    {"dotx", "word_document"},
+    {"eps", "pdf_file"},
+    {"exe", "default_app_file"},
+    {"flact", "multimedia_file"},
+    {"gif", "image_file"},
+    {"h", "text_file"},
+    {"h264", "multimedia_file"},
+    {"hlp", "help_file"},
+    {"htm", "html_document"},
+    {"html", "html_document"},
+    {"inf1", "installer_file"},
+    {"java", "text_file"},
+    {"jpeg", "image_file"},
+    {"jpg", "image_file"},
+    {"js", "html_document"},
+    {"lnk", "link_file"},
+    {"m4v", "multimedia_file"},
+    {"md", "text_file"},
+    {"mid", "multimedia_file"},
+    {"midi", "multimedia_file"},
+    {"mkv", "multimedia_file"},
+    {"mov", "multimedia_file"},
+    {"mp3", "multimedia_file"},
+    {"mp4", "multimedia_file"},
+    {"mpa", "multimedia_file"},
+    {"mpeg", "multimedia_file"},
+    {"mpg", "multimedia_file"},
+    {"msi", "installer_file"},
+    {"msp", "installer_file"},
+    {"mst", "installer_file"},
+    {"odp", "powerpoint_document"},
+    {"ods", "excel_document"},
+    {"odt", "word_document"},
+    {"ogg", "multimedia_file"},
+    {"paf", "installer_file"},
+    {"pdf", "pdf_file"},
+    {"php", "text_file"},
+    {"pl", "text_file"},
+    {"png", "image_file"},
+    {"potx", "powerpoint_document"},
+    {"ppa", "powerpoint_document"},
+    {"pps", "powerpoint_document"},
+    {"ppsm", "powerpoint_document"},
+    {"ppsx", "powerpoint_document"},
+    {"ppt", "powerpoint_document"},
+    {"pptm", "powerpoint_document"},
+    {"pptx", "powerpoint_document"},
+    {"ps", "image_file"},
+    {"psd", "image_file"},
+    {"py", "text_file"},
+    {"rm", "multimedia_file"},
+    {"rtf", "wordpad"},
+    {"sh", "text_file"},
+    {"svg", "image_file"},
+    {"swift", "text_file"},
+    {"text", "text_file"},
+    {"tif", "image_file"},
+    {"tiff", "image_file"},
+    {"txt", "text_file"},
+    {"url", "url"},
+    {"vb", "text_file"},
+    {"vbe", "text_file"},
+    {"vbs", "text_file"},
+    {"vbscript", "text_file"},
+    {"wav", "multimedia_file"},
+    {"webm", "multimedia_file"},
+    {"webp", "image_file"},
+    {"wma", "multimedia_file"},
+    {"wpl", "multimedia_file"},
+    {"ws", "text_file"},
+    {"wsf", "text_file"},
+    {"wsh", "text_file"},
+    {"xhtml", "html_document"},
+    {"xla", "excel_document"},
+    {"xls", "excel_document"},
+    {"xlsb", "excel_document"},
+    {"xlsm", "excel_document"},
+    {"xlsx", "excel_document"},
+    {"xlt", "excel_document"},
+    {"xltx", "excel_document"},
+}};
+static constexpr std::size_t MaxExtensionLength = 8; /*!< Longest extension in the table above */
+static_assert(std::ranges::is_sorted(ExtensionIcons, {}, &ExtensionIcon::first), "ExtensionIcons must be sorted by extension");
+static_assert(std::ranges::all_of(ExtensionIcons, [](const ExtensionIcon& entry) { return entry.first.size() <= MaxExtensionLength; }),
+              "MaxExtensionLength is too small");
+
 /// Meyers Singleton
 Helper::Helper() = default;
 /// Destructor
@@ -164,7 +310,8 @@ vector<string> Helper::get_bottles_paths(const string& dir_path, bool display_de
   while (!name.empty())
   {
     auto path = Glib::build_filename(dir_path, name);
-    if (Glib::file_test(path, Glib::FileTest::FILE_TEST_IS_DIR))
+    // Skip the bottles which are being removed
+    if (Glib::file_test(path, Glib::FileTest::FILE_TEST_IS_DIR) && !BottleRemover::is_trash(name))
     {
       list.emplace_back(path);
     }
@@ -187,98 +334,135 @@ vector<string> Helper::get_bottles_paths(const string& dir_path, bool display_de
 
 /**
  * \brief Run any program with only setting the WINEPREFIX env variable (run this method async).
- * Returns stdout output. Redirect stderr to stdout (2>&1), if you want stderr as well.
+ * When debug logging is enabled, the output is streamed to the WineGUI log file of the bottle while the program runs.
  * Improvement/TODO: We could now also log the output from the program into a GUI console window.
  * \param[in] prefix_path The path to wine bottle
  * \param[in] debug_log_level Debug log level
- * \param[in] program Program that gets executed (ideally full path)
+ * \param[in] program Program (ideally full path) followed by its arguments, no quoting needed
  * \param[in] working_directory Working directory of where the program will be executed
+ * \param[in] env_vars Array of environment variables to set
  * \param[in] give_error Inform user when application exit with non-zero exit code
  * \param[in] stderr_output Also output stderr (together with stout)
- * \param[in] env_vars Array of environment variables to set
- * \return Terminal stdout output
+ * \param[in] debug_logging Append the output to the WineGUI log file (winegui.log in the bottle)
+ * \param[in] stop_token Stop waiting for the program on request (the program keeps running, no error is given)
+ * \return Exit code of the program (127 if the program could not be started, -1 when stopped)
  */
-string Helper::run_program(const string& prefix_path,
-                           int debug_log_level,
-                           const string& program,
-                           const string& working_directory,
-                           const vector<pair<string, string>>& env_vars,
-                           bool give_error,
-                           bool stderr_output)
+int Helper::run_program(const string& prefix_path,
+                        int debug_log_level,
+                        const vector<string>& program,
+                        const string& working_directory,
+                        const vector<pair<string, string>>& env_vars,
+                        bool give_error,
+                        bool stderr_output,
+                        bool debug_logging,
+                        std::stop_token stop_token)
 {
-  string output;
+  vector<pair<string, string>> program_env_vars = get_program_env_vars(prefix_path, debug_log_level, env_vars);
 
-  string debug = (debug_log_level != 1) ? "WINEDEBUG=" + Helper::log_level_to_winedebug_string(debug_log_level) + " " : "";
-  string exec_program = (stderr_output) ? program + " 2>&1" : program;
-  string change_directory = working_directory.empty() ? "" : "cd \"" + working_directory + "\" && ";
-  string env_vars_str(debug + "WINEPREFIX=\"" + prefix_path + "\" ");
+  // Output is written chunk by chunk via a bounded buffer, even gigabytes of (debug) output doesn't end-up in memory
+  std::unique_ptr<LogWriter> log_writer;
+  if (debug_logging)
+    log_writer = std::make_unique<LogWriter>(Helper::get_log_file_path(prefix_path));
+  std::function<void(std::string_view)> on_output;
+  if (log_writer)
+    on_output = [&log_writer](std::string_view chunk) { log_writer->write(chunk); };
 
-  // Convert key/value pair to string, append to env_vars_str
-  for (const auto& [key, value] : env_vars)
+  int exit_code = ProcessRunner::stream(program, on_output, program_env_vars, working_directory, stderr_output, stop_token);
+  if (log_writer)
+    log_writer->close();
+  if (give_error && exit_code != 0 && !stop_token.stop_requested())
   {
-    env_vars_str += key + "=\"" + value + "\" ";
+    // Dispatcher will run the connected slot in the main loop,
+    // instead of the same context/thread in case of a signal.emit() call.
+    // Signal error message to the user:
+    Helper::get_instance().failure_on_exec.emit();
   }
-
-  string command = change_directory + env_vars_str + exec_program;
-  if (give_error)
-  {
-    // Execute the command that also shows an error message to the user when exit code is non-zero
-    output = exec_error_message(command);
-  }
-  else
-  {
-    // No error message when exit code is non-zero, but we can still return the output and log to disk (if logging is enabled)
-    const auto& [_, output_value] = exec(command);
-    output = output_value;
-  }
-  return output;
+  return exit_code;
 }
 
 /**
  * \brief Run a Windows program under Wine (run this method async).
- * Returns stdout output. Redirect stderr to stdout (2>&1), if you want stderr as well.
- * \param[in] wine_64_bit If true use Wine 64-bit binary, false use 32-bit binary
+ * When debug logging is enabled, the output is streamed to the WineGUI log file of the bottle while the program runs.
+ * \param[in] wine_executable Wine executable of the runner (name in PATH or full path), see WineRuntime::get_wine_executable()
  * \param[in] prefix_path The path to bottle wine
  * \param[in] debug_log_level Debug log level
- * \param[in] program Program/executable that will be executed (be sure your application executable is between
- * brackets in case of spaces)
+ * \param[in] program Program/executable that will be executed followed by its arguments (no quoting needed in case of spaces)
  * \param[in] working_directory Working directory of where the program will be executed
+ * \param[in] env_vars Array of environment variables to set
  * \param[in] give_error Inform user when application exit with non-zero exit code
  * \param[in] stderr_output Also output stderr (together with stout)
+ * \param[in] debug_logging Append the output to the WineGUI log file (winegui.log in the bottle)
+ * \param[in] stop_token Stop waiting for the program on request (the program keeps running, no error is given)
+ * \return Exit code of the program (127 if the program could not be started, -1 when stopped)
+ */
+int Helper::run_program_under_wine(const string& wine_executable,
+                                   const string& prefix_path,
+                                   int debug_log_level,
+                                   const vector<string>& program,
+                                   const string& working_directory,
+                                   const vector<pair<string, string>>& env_vars,
+                                   bool give_error,
+                                   bool stderr_output,
+                                   bool debug_logging,
+                                   std::stop_token stop_token)
+{
+  vector<string> wine_program{wine_executable};
+  wine_program.insert(wine_program.end(), program.begin(), program.end());
+  return Helper::run_program(
+      prefix_path, debug_log_level, wine_program, working_directory, env_vars, give_error, stderr_output, debug_logging, std::move(stop_token));
+}
+
+/**
+ * \brief Start any program with only setting the WINEPREFIX env variable, without waiting for the program.
+ * Used for long running programs, the program is not occupying a worker thread while running.
+ * When debug logging is enabled, the output is appended to the WineGUI log file of the bottle.
+ * \param[in] prefix_path The path to wine bottle
+ * \param[in] debug_log_level Debug log level
+ * \param[in] program Program (ideally full path) followed by its arguments, no quoting needed
+ * \param[in] working_directory Working directory of where the program will be executed
  * \param[in] env_vars Array of environment variables to set
- * \return Terminal stdout output
+ * \param[in] stderr_output Also output stderr (together with stout)
+ * \param[in] debug_logging Append the output to the WineGUI log file (winegui.log in the bottle)
+ * \throws runtime_error when the program could not be started
+ * \return Process ID of the program, the caller needs to reap the process (see Glib::signal_child_watch())
  */
-string Helper::run_program_under_wine(bool wine_64_bit,
-                                      const string& prefix_path,
-                                      int debug_log_level,
-                                      const string& program,
-                                      const string& working_directory,
-                                      const vector<pair<string, string>>& env_vars,
-                                      bool give_error,
-                                      bool stderr_output)
+pid_t Helper::spawn_program(const string& prefix_path,
+                            int debug_log_level,
+                            const vector<string>& program,
+                            const string& working_directory,
+                            const vector<pair<string, string>>& env_vars,
+                            bool stderr_output,
+                            bool debug_logging)
 {
-  return Helper::run_program(prefix_path, debug_log_level, Helper::get_wine_executable_location(wine_64_bit) + " " + program, working_directory,
-                             env_vars, give_error, stderr_output);
+  string output_path = debug_logging ? Helper::get_log_file_path(prefix_path) : "";
+  return ProcessRunner::spawn(program, get_program_env_vars(prefix_path, debug_log_level, env_vars), working_directory, output_path, stderr_output);
 }
 
 /**
- * \brief Write/append logging to WineGUI log file
- * \param logging_bottle_prefix Wine Bottle prefix location
- * \param logging Logging data
+ * \brief Start a Windows program under Wine, without waiting for the program (see spawn_program()).
+ * \param[in] wine_executable Wine executable of the runner (name in PATH or full path), see WineRuntime::get_wine_executable()
+ * \param[in] prefix_path The path to bottle wine
+ * \param[in] debug_log_level Debug log level
+ * \param[in] program Program/executable that will be executed followed by its arguments (no quoting needed in case of spaces)
+ * \param[in] working_directory Working directory of where the program will be executed
+ * \param[in] env_vars Array of environment variables to set
+ * \param[in] stderr_output Also output stderr (together with stout)
+ * \param[in] debug_logging Append the output to the WineGUI log file (winegui.log in the bottle)
+ * \throws runtime_error when the program could not be started
+ * \return Process ID of the program
  */
-void Helper::write_to_log_file(const string& logging_bottle_prefix, const string& logging)
+pid_t Helper::spawn_program_under_wine(const string& wine_executable,
+                                       const string& prefix_path,
+                                       int debug_log_level,
+                                       const vector<string>& program,
+                                       const string& working_directory,
+                                       const vector<pair<string, string>>& env_vars,
+                                       bool stderr_output,
+                                       bool debug_logging)
 {
-  string log_path = Helper::get_log_file_path(logging_bottle_prefix);
-  auto file = Gio::File::create_for_path(log_path);
-  try
-  {
-    auto output = file->append_to(Gio::FileCreateFlags::FILE_CREATE_NONE);
-    output->write(logging);
-  }
-  catch (const Glib::Error& ex)
-  {
-    std::cerr << "Error: Couldn't write debug logging to log file. Error " << ex.what() << std::endl;
-  }
+  vector<string> wine_program{wine_executable};
+  wine_program.insert(wine_program.end(), program.begin(), program.end());
+  return Helper::spawn_program(prefix_path, debug_log_level, wine_program, working_directory, env_vars, stderr_output, debug_logging);
 }
 
 /**
@@ -293,17 +477,93 @@ string Helper::get_log_file_path(const string& logging_bottle_prefix)
 
 /**
  * \brief Blocking wait (with timeout functionality) until wineserver is terminated.
- */
-void Helper::wait_until_wineserver_is_terminated(const string& prefix_path)
-{
-  const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" timeout 60 wineserver -w 2>&1");
-  if (exit_code == 124)
+ * Waits on the wineserver process directly (using a pidfd), instead of starting 'wineserver -w'.
+ * \param[in] prefix_path The path to bottle wine
+ * \param[in] stop_token Stop waiting on request
+ * \param[in] timeout Maximum time to wait
+ */
+void Helper::wait_until_wineserver_is_terminated(const string& prefix_path, std::stop_token stop_token, std::chrono::milliseconds timeout)
+{
+  pid_t pid = get_wineserver_pid(prefix_path);
+  if (pid == 0)
+    return; // Not running
+
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  int pid_fd = -1;
+#ifdef SYS_pidfd_open
+  if (pid > 0)
+    pid_fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#endif
+  bool is_running = true;
+  while (is_running && !stop_token.stop_requested())
+  {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0)
+      break;
+    // Wake up regularly to check the stop token
+    int poll_time = static_cast<int>(std::min<std::chrono::milliseconds::rep>(remaining.count(), WineserverPollInterval));
+    if (pid_fd >= 0)
+    {
+      // The pidfd becomes readable when the process exits
+      struct pollfd poll_fd = {pid_fd, POLLIN, 0};
+      int result = poll(&poll_fd, 1, poll_time);
+      if (result > 0 || (result < 0 && errno != EINTR))
+        is_running = false;
+    }
+    else
+    {
+      // No pidfd support (or the PID is unknown), check the lock of the wineserver instead
+      std::this_thread::sleep_for(std::chrono::milliseconds(poll_time));
+      is_running = is_wineserver_running(prefix_path);
+    }
+  }
+  if (pid_fd >= 0)
+    close(pid_fd);
+  if (is_running && !stop_token.stop_requested())
   {
-    std::cout << "INFO: Time-out of wineserver wait command triggered (wineserver is still running..)" << std::endl;
-    std::cout << "INFO: Output of wineserver: " << output << std::endl;
+    std::cout << "INFO: Time-out of wineserver wait triggered (wineserver is still running..)" << std::endl;
   }
 }
 
+/**
+ * \brief Check if the wineserver of the bottle is running, without starting any process.
+ * \param[in] prefix_path The path to bottle wine
+ * \return True if the wineserver is running
+ */
+bool Helper::is_wineserver_running(const string& prefix_path)
+{
+  return get_wineserver_pid(prefix_path) != 0;
+}
+
+/**
+ * \brief Get the process ID of the wineserver of the bottle, without starting any process.
+ * The wineserver holds a lock on the lock file in its server directory: /tmp/.wine-<uid>/server-<device>-<inode>/lock,
+ * where device and inode are from the bottle prefix directory.
+ * \param[in] prefix_path The path to bottle wine
+ * \return Process ID, 0 if the wineserver is not running or -1 if it's running but the PID is unknown (eg. other PID namespace)
+ */
+pid_t Helper::get_wineserver_pid(const string& prefix_path)
+{
+  struct stat prefix_stat;
+  if (stat(prefix_path.c_str(), &prefix_stat) != 0)
+    return 0;
+  char server_dir[64];
+  snprintf(server_dir, sizeof(server_dir), "server-%llx-%llx", static_cast<unsigned long long>(prefix_stat.st_dev),
+           static_cast<unsigned long long>(prefix_stat.st_ino));
+  string lock_file_path = Glib::build_filename("/tmp", ".wine-" + std::to_string(getuid()), server_dir, "lock");
+  int fd = open(lock_file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return 0;
+  struct flock lock = {};
+  lock.l_type = F_WRLCK;
+  lock.l_whence = SEEK_SET;
+  pid_t pid = 0;
+  if (fcntl(fd, F_GETLK, &lock) == 0 && lock.l_type != F_UNLCK)
+    pid = (lock.l_pid > 0) ? lock.l_pid : -1;
+  close(fd);
+  return pid;
+}
+
 /**
  * \brief Determine which type of wine executable to use
  * \return -1 on failure, 0 on 32-bit, 1 on 64-bit wine executable
@@ -311,21 +571,15 @@ void Helper::wait_until_wineserver_is_terminated(const string& prefix_path)
 int Helper::determine_wine_executable()
 {
   int return_status = -1;
-  // Try wine 32-bit
-  const auto& [exit_code32, _] = exec("command -v " + Helper::get_wine_executable_location(false));
-  if (exit_code32 == 0)
+  // Try wine 32-bit (search in PATH, no need to spawn a shell)
+  if (!Glib::find_program_in_path(Helper::get_wine_executable_location(false)).empty())
   {
     return_status = 0;
   }
   // Try wine 64-bit
-  if (return_status != 0)
+  else if (!Glib::find_program_in_path(Helper::get_wine_executable_location(true)).empty())
   {
-    // cppcheck-suppress shadowVariable
-    const auto& [exit_code64, _] = exec("command -v " + Helper::get_wine_executable_location(true));
-    if (exit_code64 == 0)
-    {
-      return_status = 1;
-    }
+    return_status = 1;
   }
   return return_status;
 }
@@ -367,13 +621,13 @@ string Helper::get_winetricks_location()
 
 /**
  * \brief Get Wine version from CLI
- * \param[in] wine_64_bit If true use Wine 64-bit binary, false use 32-bit binary
+ * \param[in] wine_executable Wine executable (name in PATH or full path)
  * \throws runtime_error we could not determine Wine version
  * \return Return the wine version
  */
-string Helper::get_wine_version(bool wine_64_bit)
+string Helper::get_wine_version(const string& wine_executable)
 {
-  const auto& [exit_code, output] = exec(Helper::get_wine_executable_location(wine_64_bit) + " --version 2>&1");
+  const auto& [exit_code, output] = exec({wine_executable, "--version"});
   if (exit_code == 0 && !output.empty())
   {
     vector<string> results = split(output, '-');
@@ -390,15 +644,13 @@ string Helper::get_wine_version(bool wine_64_bit)
       }
       else
       {
-        std::cerr << "Error: Couldn't determine Wine version. Using wine executable: " << Helper::get_wine_executable_location(wine_64_bit)
-                  << ", output: " << output << std::endl;
+        std::cerr << "Error: Couldn't determine Wine version. Using wine executable: " << wine_executable << ", output: " << output << std::endl;
         throw std::runtime_error("Could not determine Wine version?\nSomething went wrong.");
       }
     }
     else
     {
-      std::cerr << "Error: Couldn't determine Wine version. Using wine executable: " << Helper::get_wine_executable_location(wine_64_bit)
-                << ", output: " << output << std::endl;
+      std::cerr << "Error: Couldn't determine Wine version. Using wine executable: " << wine_executable << ", output: " << output << std::endl;
       throw std::runtime_error("Could not determine Wine version?\nSomething went wrong.");
     }
   }
@@ -446,20 +698,20 @@ string Helper::open_file_from_uri(const string& uri)
  */
 void Helper::create_wine_bottle(bool wine_64_bit, const string& prefix_path, BottleTypes::Bit bit, const bool disable_gecko_mono)
 {
-  string wine_arch = "";
+  vector<pair<string, string>> env_vars{{"WINEPREFIX", prefix_path}};
   switch (bit)
   {
   case BottleTypes::Bit::win32:
-    wine_arch = " WINEARCH=win32";
+    env_vars.emplace_back("WINEARCH", "win32");
     break;
   case BottleTypes::Bit::win64:
-    wine_arch = " WINEARCH=win64";
+    env_vars.emplace_back("WINEARCH", "win64");
     break;
   }
-  string wine_dll_overrides = (disable_gecko_mono) ? " WINEDLLOVERRIDES=\"mscoree=d;mshtml=d\"" : "";
-  string command =
-      "WINEPREFIX=\"" + prefix_path + "\"" + wine_arch + wine_dll_overrides + " " + Helper::get_wine_executable_location(wine_64_bit) + " wineboot";
-  const auto& [exit_code, output] = exec(command + " 2>&1");
+  if (disable_gecko_mono)
+    env_vars.emplace_back("WINEDLLOVERRIDES", "mscoree=d;mshtml=d");
+  string command = Helper::get_wine_executable_location(wine_64_bit) + " wineboot";
+  const auto& [exit_code, output] = exec({Helper::get_wine_executable_location(wine_64_bit), "wineboot"}, env_vars);
   if (exit_code != 0)
   {
     std::cerr << "Error: Couldn't create Wine bottle. Command: " << command << ", output: " << output << std::endl;
@@ -468,31 +720,6 @@ void Helper::create_wine_bottle(bool wine_64_bit, const string& prefix_path, Bot
   }
 }
 
-/**
- * \brief Remove existing Wine bottle using prefix
- * \param[in] prefix_path - The wine bottle path which will be removed
- * \throws runtime_error when we could not remove the Wine bottle
- */
-void Helper::remove_wine_bottle(const string& prefix_path)
-{
-  if (Helper::dir_exists(prefix_path))
-  {
-    const auto& [exit_code, output] = exec("rm -rf \"" + prefix_path + "\" 2>&1");
-    if (exit_code != 0)
-    {
-      std::cerr << "Error: Couldn't remove Wine bottle. Wine prefix path: " << prefix_path << ", output: " << output << std::endl;
-      throw std::runtime_error("Something went wrong when removing the Windows Machine. Wine machine: " + get_folder_name(prefix_path) +
-                               "\n\nFull path location: " + prefix_path);
-    }
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't remove Wine bottle, prefix path doesn't exists. Wine prefix path: " << prefix_path << "." << std::endl;
-    throw std::runtime_error("Could not remove Windows Machine, prefix is not a directory. Wine machine: " + get_folder_name(prefix_path) +
-                             "\n\nFull path location: " + prefix_path);
-  }
-}
-
 /**
  * \brief Rename Wine bottle folder
  * \param[in] current_prefix_path Current wine bottle path
@@ -503,7 +730,7 @@ void Helper::rename_wine_bottle_folder(const string& current_prefix_path, const
 {
   if (Helper::dir_exists(current_prefix_path))
   {
-    const auto& [exit_code, output] = exec("mv \"" + current_prefix_path + "\" \"" + new_prefix_path + "\" 2>&1");
+    const auto& [exit_code, output] = exec({"mv", current_prefix_path, new_prefix_path});
     if (exit_code != 0)
     {
       std::cerr << "Error: Couldn't rename Wine bottle. Wine prefix path: " << current_prefix_path << ", output: " << output << std::endl;
@@ -520,21 +747,31 @@ void Helper::rename_wine_bottle_folder(const string& current_prefix_path, const
 }
 
 /**
- * \brief Copy Wine bottle folder
+ * \brief Copy Wine bottle folder, using reflinks when the file system supports it
  * \param[in] source_prefix_path Current source wine bottle path
  * \param[in] destination_prefix_path Destination wine bottle path
+ * \param[in] progress Optional progress callback (copied bytes, total bytes), called from the calling thread
+ * \param[in] stop_token Request a stop to cancel the copy
  * \throws runtime_error when we could not copy the Wine Bottle
+ * \return True when copied, false when the copy got cancelled (the partial copy is removed)
  */
-void Helper::copy_wine_bottle_folder(const string& source_prefix_path, const string& destination_prefix_path)
+bool Helper::copy_wine_bottle_folder(const string& source_prefix_path,
+                                     const string& destination_prefix_path,
+                                     const BottleCloner::ProgressCallback& progress,
+                                     std::stop_token stop_token)
 {
   if (Helper::dir_exists(source_prefix_path))
   {
-    const auto& [exit_code, output] = exec("cp -r \"" + source_prefix_path + "\" \"" + destination_prefix_path + "\" 2>&1");
-    if (exit_code != 0)
+    try
+    {
+      return BottleCloner::clone(source_prefix_path, destination_prefix_path, progress, stop_token);
+    }
+    catch (const std::runtime_error& error)
     {
-      std::cerr << "Error: Couldn't copy Wine bottle. Wine prefix path: " << source_prefix_path << ", output: " << output << std::endl;
+      std::cerr << "Error: Couldn't copy Wine bottle. Wine prefix path: " << source_prefix_path << ", error: " << error.what() << std::endl;
       throw std::runtime_error("Failed to copy the folder. Wine machine: " + get_folder_name(source_prefix_path) +
-                               "\n\nSource full path location: " + source_prefix_path + ". Tried to copy to destination: " + destination_prefix_path);
+                               "\n\nSource full path location: " + source_prefix_path + ". Tried to copy to destination: " + destination_prefix_path +
+                               "\n\n" + error.what());
     }
   }
   else
@@ -810,8 +1047,10 @@ string Helper::get_last_wine_updated(const string& prefix_path)
     if (!epoch_time.empty())
     {
       time_t secsSinceEpoch = strtoul(epoch_time.c_str(), NULL, 0);
+      struct tm local_time;
+      localtime_r(&secsSinceEpoch, &local_time); // Thread-safe, bottles are scanned in parallel
       std::stringstream stringStream;
-      stringStream << std::put_time(localtime(&secsSinceEpoch), "%c");
+      stringStream << std::put_time(&local_time, "%c");
       return stringStream.str();
     }
     else
@@ -860,6 +1099,29 @@ bool Helper::get_bottle_status(const string& prefix_path)
   }
 }
 
+/**
+ * \brief Get a fingerprint of the bottle files the bottle details are read from (modification time + size of each file).
+ * The fingerprint changes whenever one of those files got changed, added or removed.
+ * \param[in] prefix_path Bottle prefix
+ * \return Fingerprint of the bottle
+ */
+string Helper::get_bottle_fingerprint(const string& prefix_path)
+{
+  static const std::array<string, 5> files{UserReg, SystemReg, UpdateTimestamp, "winegui.ini", "dosdevices"};
+  std::stringstream fingerprint;
+  for (const string& file : files)
+  {
+    struct stat file_stat;
+    fingerprint << file << ':';
+    if (stat(Glib::build_filename(prefix_path, file).c_str(), &file_stat) == 0)
+      fingerprint << file_stat.st_mtim.tv_sec << '.' << file_stat.st_mtim.tv_nsec << ':' << file_stat.st_size;
+    else
+      fingerprint << '-';
+    fingerprint << ';';
+  }
+  return fingerprint.str();
+}
+
 /**
  * \brief Retrieve the Linux icon path and comment from Linux .desktop file using the Windows shortcut path (.lnk file).
  * Searching for the desktop file at: ~/.local/share/applications/wine. And then search for the icon image at: ~/.local/share/icons.
@@ -967,28 +1229,9 @@ string Helper::get_program_icon_from_shortcut_file(const string& prefix_path, co
   std::replace(shortcut_path_linux.begin(), shortcut_path_linux.end(), '\\', '/');
   // Add prefix and /drive_c/ folder to path
   shortcut_path_linux = prefix_path + "/drive_c/" + shortcut_path_linux;
-  // Read Shortcut file from disk
+  // Read Shortcut file from disk, and parse the binary structures directly
   string file_content = Helper::read_file(shortcut_path_linux);
-  // Convert content to hex value string
-  string hex_content = Helper::string2hex(file_content);
-  std::size_t target_path_starts = hex_content.find("431000000000"); // Searching for x43x10x00x00x00x00 hex pattern (C:\ drive)
-  if (target_path_starts == std::string::npos)
-  {
-    // Fallback, try to search on D:\ drive
-    target_path_starts = hex_content.find("441000000000");
-  }
-  if (target_path_starts == std::string::npos)
-  {
-    // Fallback, try to search on Z:\ drive
-    target_path_starts = hex_content.find("5A1000000000");
-  }
-  if (target_path_starts != std::string::npos)
-  {
-    hex_content = hex_content.substr(target_path_starts + 12); // Remove all content incl. hex search string
-    hex_content.resize(hex_content.find("00"));                // Until the first x00 hex value
-    // Convert hex string back to normal string
-    target_path = Helper::hex2string(hex_content);
-  }
+  target_path = ShellLink::parse(file_content).target_path;
   if (!target_path.empty())
   {
     return string_to_icon(target_path);
@@ -1072,12 +1315,18 @@ void Helper::install_or_update_winetricks()
     }
   }
 
-  const auto& [exit_code, output] =
-      exec("cd \"$(mktemp -d)\" && wget -q https://raw.githubusercontent.com/Winetricks/winetricks/master/src/winetricks "
-           "&& chmod +x winetricks && mv winetricks " +
-           WinetricksExecutable + " 2>&1");
+  // Download next to the final location first, the rename below replaces an existing winetricks script atomically
+  string download_path = WinetricksExecutable + ".download";
+  auto [exit_code, output] =
+      exec({"wget", "-q", "-O", download_path, "https://raw.githubusercontent.com/Winetricks/winetricks/master/src/winetricks"});
+  if (exit_code == 0 && (chmod(download_path.c_str(), 0755) != 0 || std::rename(download_path.c_str(), WinetricksExecutable.c_str()) != 0))
+  {
+    exit_code = errno;
+    output = std::strerror(errno);
+  }
   if (exit_code != 0)
   {
+    std::remove(download_path.c_str());
     std::cerr << "Error: Downloading Winetricks failed. Winetricks path: " << WinetricksExecutable << std::endl;
     std::cerr << "Error: " << output << std::endl;
     throw std::runtime_error("Winetricks helper script can not be downloaded. This could/will result into issues with WineGUI!");
@@ -1100,7 +1349,7 @@ void Helper::self_update_winetricks()
 {
   if (file_exists(WinetricksExecutable))
   {
-    const auto& [exit_code, output] = exec(WinetricksExecutable + " --self-update 2>&1");
+    const auto& [exit_code, output] = exec({WinetricksExecutable, "--self-update"});
     if (exit_code != 0)
     {
       // TODO: This could be a bug as well, maybe fallback to redownloading the winetricks binary?
@@ -1117,132 +1366,108 @@ void Helper::self_update_winetricks()
 }
 
 /**
- * \brief Set Windows OS version by using Winetricks
- * \param[in] prefix_path Bottle prefix
+ * \brief Set Windows OS version, the same registry values winetricks (winver) would set
+ * \param[in] registry Registry writer of the bottle, the changes are applied on commit
  * \param[in] windows Windows version (enum)
- * \throws runtime_error when we could not set the Windows OS version
+ * \throws runtime_error when the Windows OS version is unknown
  */
-void Helper::set_windows_version(const string& prefix_path, BottleTypes::Windows windows)
+void Helper::set_windows_version(WineRegistryWriter& registry, BottleTypes::Windows windows)
 {
-  if (file_exists(WinetricksExecutable))
+  bool is_64_bit = false;
+  try
   {
-    string win = BottleTypes::get_winetricks_string(windows);
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " " + win + " 2>&1");
-    if (exit_code != 0)
-    {
-      std::cerr << "Error: Couldn't set Windows OS version. Wine prefix path: " << prefix_path << ", Winetricks path: " << WinetricksExecutable
-                << ", to Windows version: " << BottleTypes::to_string(windows) << "(Winetricks string: " << win << ")"
-                << ", output: " << output << std::endl;
-      throw std::runtime_error("Could not set Windows OS version");
-    }
+    is_64_bit = (get_windows_bitness(registry.get_prefix_path()) == BottleTypes::Bit::win64);
   }
-  else
+  catch (const std::runtime_error&)
+  {
+    // Assume 32-bit (only matters for Windows XP)
+  }
+  for (unsigned int i = 0; i < WindowsStructSize; i++)
   {
-    std::cerr << "Error: Couldn't set Windows OS version, no Winetricks executable found. Winetricks path: " << WinetricksExecutable << std::endl;
+    // Windows XP has a 64-bit and 32-bit variant (both listed in the table, 64-bit first)
+    if (WindowsVersions[i].windows != windows || (WindowsVersions[i].version == "winxp64" && !is_64_bit))
+      continue;
+
+    registry.set_string(WineRegistryWriter::Hive::user, RegPathWine, RegNameWindowsVersion, WindowsVersions[i].version);
+    if (!WindowsVersions[i].productType.empty())
+    {
+      registry.set_string(WineRegistryWriter::Hive::system, RegPathNameNT, RegNameNTVersion, WindowsVersions[i].versionNumber);
+      registry.set_string(WineRegistryWriter::Hive::system, RegPathNameNT, RegNameNTBuild, WindowsVersions[i].buildNumber);
+      registry.set_string(WineRegistryWriter::Hive::system, RegPathNameNT, RegNameNTBuildNumber, WindowsVersions[i].buildNumber);
+      registry.set_string(WineRegistryWriter::Hive::system, RegPathType, RegNameProductType, WindowsVersions[i].productType);
+    }
+    else
+    {
+      registry.set_string(WineRegistryWriter::Hive::system, RegPathName9x, RegName9xVersion,
+                          WindowsVersions[i].versionNumber + "." + WindowsVersions[i].buildNumber);
+    }
+    return;
   }
+  std::cerr << "Error: Couldn't set Windows OS version. Wine prefix path: " << registry.get_prefix_path()
+            << ", unknown Windows version: " << BottleTypes::to_string(windows) << std::endl;
+  throw std::runtime_error("Could not set Windows OS version");
 }
 
 /**
- * \brief Set custom virtual desktop resolution by using Winetricks
- * \param[in] prefix_path Bottle prefix
+ * \brief Set custom virtual desktop resolution, like winetricks (vd=WxH) would do
+ * \param[in] registry Registry writer of the bottle, the changes are applied on commit
  * \param[in] resolution New screen resolution (eg. 1920x1080)
- * \throws runtime_error when we could not set the virtual desktop resolution
+ * \throws runtime_error when the resolution is invalid
  */
-void Helper::set_virtual_desktop(const string& prefix_path, string resolution)
+void Helper::set_virtual_desktop(WineRegistryWriter& registry, string resolution)
 {
-  if (file_exists(WinetricksExecutable))
+  vector<string> res = split(resolution, 'x');
+  if (res.size() >= 2)
   {
-    vector<string> res = split(resolution, 'x');
-    if (res.size() >= 2)
+    int x = 0, y = 0;
+    try
     {
-      int x = 0, y = 0;
-      try
-      {
-        x = std::atoi(res.at(0).c_str());
-        y = std::atoi(res.at(1).c_str());
-      }
-      catch (std::exception const& e)
-      {
-        std::cerr << "Error: Couldn't set virtual desktop resolution, Winetricks path: " << WinetricksExecutable << ", error message: " << e.what()
-                  << std::endl;
-        throw std::runtime_error("Could not set virtual desktop resolution (invalid input)");
-      }
-
-      if (x < 640 || y < 480)
-      {
-        // Set to minimum resolution
-        resolution = "640x480";
-      }
+      x = std::stoi(res.at(0));
+      y = std::stoi(res.at(1));
+    }
+    catch (std::exception const& e)
+    {
+      std::cerr << "Error: Couldn't set virtual desktop resolution, error message: " << e.what() << std::endl;
+      throw std::runtime_error("Could not set virtual desktop resolution (invalid input)");
+    }
 
-      const auto [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " vd=" + resolution + " 2>&1");
-      if (exit_code != 0)
-      {
-        std::cerr << "Error: Couldn't set virtual desktop resolution. Wine prefix path: " << prefix_path
-                  << ", Winetricks path: " << WinetricksExecutable << ", output: " << output << std::endl;
-        throw std::runtime_error("Could not set virtual desktop resolution");
-      }
+    if (x < 640 || y < 480)
+    {
+      // Set to minimum resolution
+      resolution = "640x480";
     }
     else
     {
-      std::cerr << "Error: Couldn't set virtual desktop resolution, invalid input. Wine prefix path: " << prefix_path
-                << ", Winetricks path: " << WinetricksExecutable << std::endl;
-      throw std::runtime_error("Could not set virtual desktop resolution (invalid input)");
+      resolution = std::to_string(x) + "x" + std::to_string(y);
     }
+    registry.set_string(WineRegistryWriter::Hive::user, RegPathVirtualDesktop, RegNameVirtualDesktop, RegNameVirtualDesktopDefault);
+    registry.set_string(WineRegistryWriter::Hive::user, RegPathVirtualDesktopResolution, RegNameVirtualDesktopDefault, resolution);
   }
   else
   {
-    std::cerr << "Error:Couldn't set virtual desktop resolution, no Winetricks executable found. Wine prefix path: " << prefix_path
-              << ", Winetricks path: " << WinetricksExecutable << std::endl;
+    std::cerr << "Error: Couldn't set virtual desktop resolution, invalid input. Wine prefix path: " << registry.get_prefix_path() << std::endl;
+    throw std::runtime_error("Could not set virtual desktop resolution (invalid input)");
   }
 }
 
 /**
- * \brief Disable Virtual Desktop fully by using Winetricks
- * \param[in] prefix_path Bottle prefix
- * \throws runtime_error when we could not disable the virtual desktop
+ * \brief Disable Virtual Desktop fully, like winetricks (vd=off) would do
+ * \param[in] registry Registry writer of the bottle, the changes are applied on commit
  */
-void Helper::disable_virtual_desktop(const string& prefix_path)
+void Helper::disable_virtual_desktop(WineRegistryWriter& registry)
 {
-  if (file_exists(WinetricksExecutable))
-  {
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " vd=off 2>&1");
-    if (exit_code != 0)
-    {
-      std::cerr << "Error: Couldn't disable desktop, Winetricks path: " << WinetricksExecutable << ", output: " << output << std::endl;
-      throw std::runtime_error("Could not disable virtual desktop");
-    }
-  }
-  else
-  {
-    std::cerr << "Error:Couldn't disable desktop, no Winetricks executable found. Winetricks path: " << WinetricksExecutable << std::endl;
-  }
+  registry.remove_value(WineRegistryWriter::Hive::user, RegPathVirtualDesktop, RegNameVirtualDesktop);
+  registry.remove_value(WineRegistryWriter::Hive::user, RegPathVirtualDesktopResolution, RegNameVirtualDesktopDefault);
 }
 
 /**
- * \brief Set Audio Driver by using Winetricks
- * \param[in] prefix_path Bottle prefix
+ * \brief Set Audio Driver, like winetricks (sound=) would do
+ * \param[in] registry Registry writer of the bottle, the changes are applied on commit
  * \param[in] audio_driver Audio driver to be set
- * \throws runtime_error when we could not set the auditor driver
  */
-void Helper::set_audio_driver(const string& prefix_path, BottleTypes::AudioDriver audio_driver)
+void Helper::set_audio_driver(WineRegistryWriter& registry, BottleTypes::AudioDriver audio_driver)
 {
-  if (file_exists(WinetricksExecutable))
-  {
-    string audio = BottleTypes::get_winetricks_string(audio_driver);
-    const auto& [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + WinetricksExecutable + " sound=" + audio + " 2>&1");
-    if (exit_code != 0)
-    {
-      std::cerr << "Error: Couldn't set audio driver. Wine prefix path: " << prefix_path << ", Winetricks path: " << WinetricksExecutable
-                << ", to audio driver: " << BottleTypes::to_string(audio_driver) << "(Winetricks string: " << audio << ")"
-                << ", output: " << output << std::endl;
-      throw std::runtime_error("Could not set Audio driver");
-    }
-  }
-  else
-  {
-    std::cerr << "Error:Couldn't set audio driver, no Winetricks executable found. Wine prefix path: " << prefix_path
-              << ", Winetricks path: " << WinetricksExecutable << std::endl;
-  }
+  registry.set_string(WineRegistryWriter::Hive::user, RegPathAudio, RegNameAudio, BottleTypes::get_winetricks_string(audio_driver));
 }
 
 /**
@@ -1307,20 +1532,51 @@ string Helper::log_level_to_winedebug_string(int log_level)
 
 /**
  * \brief Get a Wine GUID based on the application name (if installed)
- * \param[in] wine_64_bit If true use Wine 64-bit binary, false use 32-bit binary
  * \param[in] prefix_path Bottle prefix
- * \param[in] application_name Application name to search for
- * \return GUID or empty string when not installed/found
+ * \param[in] application_name Application name to search for (part of the display name)
+ * \throws runtime_error when Windows registry could not be opened
+ * \return GUID (without braces) or empty string when not installed/found
  */
-string Helper::get_wine_guid(bool wine_64_bit, const string& prefix_path, const string& application_name)
+string Helper::get_wine_guid(const string& prefix_path, const string& application_name)
 {
-  auto [exit_code, output] = exec("WINEPREFIX=\"" + prefix_path + "\" " + Helper::get_wine_executable_location(wine_64_bit) +
-                                  " uninstaller --list | grep \"" + application_name + "\" | cut -d \"{\" -f2 | cut -d \"}\" -f1 2>&1");
-  if (exit_code == 0 && !output.empty())
+  for (const InstalledProgramData& program : get_installed_programs(prefix_path))
   {
-    output.erase(std::remove(output.begin(), output.end(), '\n'), output.end());
+    if (!program.guid.empty() && program.display_name.find(application_name) != string::npos)
+      return program.guid;
   }
-  return output;
+  return "";
+}
+
+/**
+ * \brief Get all the installed programs from the Uninstall keys in the system registry (incl. the 32-bit programs on 64-bit),
+ * without starting 'wine uninstaller --list'. Just like the uninstaller, keys without a display name are skipped.
+ * \param[in] prefix_path Bottle prefix
+ * \throws runtime_error when Windows registry could not be opened
+ * \return Installed programs, in registry order
+ */
+vector<InstalledProgramData> Helper::get_installed_programs(const string& prefix_path)
+{
+  vector<InstalledProgramData> programs;
+  auto registry = WineRegistry::open(Glib::build_filename(prefix_path, SystemReg));
+  for (const string& uninstall_key : {RegKeyUninstallList, RegKeyUninstallList64})
+  {
+    for (std::string_view key_name : registry->get_subkeys(uninstall_key))
+    {
+      InstalledProgramData program;
+      program.display_name = registry->get_value(key_name, "DisplayName");
+      if (program.display_name.empty())
+        continue;
+      // Subkey name without the parent key (incl. the escaped backslash) and the closing bracket
+      std::size_t start = uninstall_key.size() + 1;
+      program.key = WineRegistry::unescape(key_name.substr(start, key_name.size() - start - 1));
+      if (program.key.size() > 2 && program.key.front() == '{' && program.key.back() == '}')
+        program.guid = program.key.substr(1, program.key.size() - 2);
+      program.display_version = registry->get_value(key_name, "DisplayVersion");
+      program.publisher = registry->get_value(key_name, "Publisher");
+      programs.push_back(std::move(program));
+    }
+  }
+  return programs;
 }
 
 /**
@@ -1333,10 +1589,23 @@ string Helper::get_wine_guid(bool wine_64_bit, const string& prefix_path, const
  */
 bool Helper::get_dll_override(const string& prefix_path, const string& dll_name, DLLOverride::LoadOrder load_order)
 {
-  string file_path = Glib::build_filename(prefix_path, UserReg);
-  string value_name = dll_name;
-  string value = Helper::get_reg_value(file_path, RegKeyDllOverrides, value_name);
-  return DLLOverride::to_string(load_order) == value;
+  return DLLOverride::to_string(load_order) == get_dll_overrides(prefix_path, {dll_name}).front();
+}
+
+/**
+ * \brief Get the load order of multiple DLL overrides at once
+ * \param[in] prefix_path Bottle prefix
+ * \param[in] dll_names DLL Names
+ * \throws runtime_error when Windows registry could not be opened
+ * \return DLL overrides registry value of each DLL in the same order (eg. native,builtin), empty string if not overridden
+ */
+vector<string> Helper::get_dll_overrides(const string& prefix_path, const vector<string>& dll_names)
+{
+  vector<pair<string, string>> key_value_names;
+  key_value_names.reserve(dll_names.size());
+  for (const string& dll_name : dll_names)
+    key_value_names.emplace_back(RegKeyDllOverrides, dll_name);
+  return Helper::get_reg_values(Glib::build_filename(prefix_path, UserReg), key_value_names);
 }
 
 /**
@@ -1349,9 +1618,23 @@ bool Helper::get_dll_override(const string& prefix_path, const string& dll_name,
  */
 string Helper::get_uninstaller(const string& prefix_path, const string& uninstallerKey)
 {
-  string file_path = Glib::build_filename(prefix_path, SystemReg);
-  string key_name = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Uninstall\\\\" + uninstallerKey;
-  return Helper::get_reg_value(file_path, key_name, "DisplayName");
+  return get_uninstallers(prefix_path, {uninstallerKey}).front();
+}
+
+/**
+ * \brief Retrieve multiple uninstallers at once (if available)
+ * \param[in] prefix_path Bottle prefix
+ * \param[in] uninstaller_keys GUIDs or application names of the uninstallers
+ * \throws runtime_error when Windows registry could not be opened
+ * \return Uninstaller display name of each key in the same order, empty string if not found
+ */
+vector<string> Helper::get_uninstallers(const string& prefix_path, const vector<string>& uninstaller_keys)
+{
+  vector<pair<string, string>> key_value_names;
+  key_value_names.reserve(uninstaller_keys.size());
+  for (const string& uninstaller_key : uninstaller_keys)
+    key_value_names.emplace_back(RegKeyUninstall + uninstaller_key, "DisplayName");
+  return Helper::get_reg_values(Glib::build_filename(prefix_path, SystemReg), key_value_names);
 }
 
 /**
@@ -1364,18 +1647,25 @@ string Helper::get_uninstaller(const string& prefix_path, const string& uninstal
  */
 string Helper::get_font_filename(const string& prefix_path, BottleTypes::Bit bit, const string& fontName)
 {
-  string file_path = Glib::build_filename(prefix_path, SystemReg);
-  string key_name = "";
-  switch (bit)
-  {
-  case BottleTypes::Bit::win32:
-    key_name = "[Software\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Fonts]";
-    break;
-  case BottleTypes::Bit::win64:
-    key_name = "[Software\\\\Wow6432Node\\\\Microsoft\\\\Windows\\\\CurrentVersion\\\\Fonts]";
-    break;
-  }
-  return Helper::get_reg_value(file_path, key_name, fontName);
+  return get_font_filenames(prefix_path, bit, {fontName}).front();
+}
+
+/**
+ * \brief Retrieve multiple font file paths from the system registry at once
+ * \param[in] prefix_path Bottle prefix
+ * \param[in] bit Bottle bit (32 or 64) enum
+ * \param[in] font_names Font names
+ * \throws runtime_error when Windows registry could not be opened
+ * \return Font file path of each font in the same order (or empty string if not found)
+ */
+vector<string> Helper::get_font_filenames(const string& prefix_path, BottleTypes::Bit bit, const vector<string>& font_names)
+{
+  string key_name = (bit == BottleTypes::Bit::win64) ? RegKeyFonts64 : RegKeyFonts;
+  vector<pair<string, string>> key_value_names;
+  key_value_names.reserve(font_names.size());
+  for (const string& font_name : font_names)
+    key_value_names.emplace_back(key_name, font_name);
+  return Helper::get_reg_values(Glib::build_filename(prefix_path, SystemReg), key_value_names);
 }
 
 /**
@@ -1455,84 +1745,20 @@ string Helper::encode_text(const string& text)
  */
 string Helper::string_to_icon(const std::string& filename)
 {
-  string icon;
-  // Get file extension
-  string ext;
+  // Get file extension, lowercased into a buffer on the stack
   size_t dot_pos = filename.find_last_of('.');
-  if (dot_pos != string::npos)
-  {
-    ext = filename.substr(dot_pos + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-  }
-  if (ext == "url")
-  {
-    icon = "url";
-  }
-  else if (ext == "htm" || ext == "html" || ext == "xhtml" || ext == "css" || ext == "js")
-  {
-    icon = "html_document";
-  }
-  else if (ext == "mp3" || ext == "mp4" || ext == "flact" || ext == "mpg" || ext == "mpeg" || ext == "ogg" || ext == "mov" || ext == "webm" ||
-           ext == "wav" || ext == "mpa" || ext == "wma" || ext == "wpl" || ext == "mid" || ext == "midi" || ext == "aif" || ext == "cda" ||
-           ext == "avi" || ext == "h264" || ext == "m4v" || ext == "mkv" || ext == "rm")
-  {
-    icon = "multimedia_file";
-  }
-  else if (ext == "png" || ext == "tif" || ext == "tiff" || ext == "jpg" || ext == "jpeg" || ext == "ai" || ext == "bmp" || ext == "gif" ||
-           ext == "ps" || ext == "psd" || ext == "svg" || ext == "webp")
-  {
-    icon = "image_file";
-  }
-  else if (ext == "pdf" || ext == "ps" || ext == "eps")
-  {
-    icon = "pdf_file";
-  }
-  else if (ext == "doc" || ext == "docx" || ext == "docm" || ext == "dotx" || ext == "dotm" || ext == "docb" || ext == "dot" || ext == "odt")
-  {
-    icon = "word_document";
-  }
-  else if (ext == "ppt" || ext == "pptx" || ext == "potx" || ext == "ppsx" || ext == "ppsm" || ext == "ppa" || ext == "pptm" || ext == "pps" ||
-           ext == "odp")
-  {
-    icon = "powerpoint_document";
-  }
-  else if (ext == "xls" || ext == "xlt" || ext == "xlsm" || ext == "xlsx" || ext == "csv" || ext == "xla" || ext == "xlsb" || ext == "xltx" ||
-           ext == "ods")
-  {
-    icon = "excel_document";
-  }
-  else if (ext == "txt" || ext == "h" || ext == "c" || ext == "cc" || ext == "cpp" || ext == "cgi" || ext == "py" || ext == "class" || ext == "pl" ||
-           ext == "cs" || ext == "java" || ext == "php" || ext == "sh" || ext == "swift" || ext == "text" || ext == "md" || ext == "vb" ||
-           ext == "vbe" || ext == "vbs" || ext == "vbscript" || ext == "ws" || ext == "wsf" || ext == "wsh")
-  {
-    icon = "text_file";
-  }
-  else if (ext == "rtf")
-  {
-    icon = "wordpad";
-  }
-  else if (ext == "msi" || ext == "msp" || ext == "mst" || ext == "inf1" || ext == "paf")
-  {
-    icon = "installer_file";
-  }
-  else if (ext == "hlp")
-  {
-    icon = "help_file";
-  }
-  else if (ext == "lnk")
-  {
-    icon = "link_file";
-  }
-  else if (ext == "desktop" || ext == "exe" || ext == "bat" || ext == "bin" || ext == "cmd" || ext == "com")
-  {
-    icon = "default_app_file";
-  }
-  else
-  {
-    // Unknown icon
-    icon = "unknown_file";
-  }
-  return icon;
+  size_t ext_length = (dot_pos != string::npos) ? filename.size() - dot_pos - 1 : 0;
+  if (ext_length == 0 || ext_length > MaxExtensionLength)
+    return "unknown_file";
+  std::array<char, MaxExtensionLength> ext_buffer;
+  std::transform(filename.begin() + dot_pos + 1, filename.end(), ext_buffer.begin(), [](unsigned char c) { return std::tolower(c); });
+  std::string_view ext(ext_buffer.data(), ext_length);
+
+  const auto* it = std::ranges::lower_bound(ExtensionIcons, ext, {}, &ExtensionIcon::first);
+  if (it != ExtensionIcons.end() && it->first == ext)
+    return string(it->second);
+  // Unknown icon
+  return "unknown_file";
 }
 
 /****************************************************************************
@@ -1540,92 +1766,37 @@ string Helper::string_to_icon(const std::string& filename)
  ****************************************************************************/
 
 /**
- * \brief Execute command on terminal. Returns both the exit code as well as stdout output.
- * Note: Redirect stderr to stdout (2>&1), if you want stderr as well.
- * \param[in] command The command to be executed
- * \example const auto& [exit_code, output] = exec("echo 1");
- * \throws runtime_error when popen failed (empty pipe pointer)
- * \return Exit code and terminal stdout output as a pair
+ * \brief Execute a program (without shell). Returns both the exit code as well as the output.
+ * \param[in] program Program followed by its arguments
+ * \param[in] env_vars Environment variables to set
+ * \param[in] working_directory Working directory of the program (empty is the current working directory)
+ * \param[in] stderr_output Also output stderr (together with stdout)
+ * \example const auto& [exit_code, output] = exec({"echo", "1"});
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code and output as a pair
  */
-std::pair<int, string> Helper::exec(const string& command)
+std::pair<int, string>
+Helper::exec(const vector<string>& program, const vector<pair<string, string>>& env_vars, const string& working_directory, bool stderr_output)
 {
-  int exit_code = -1;
-  string output = "";
-
-  // local scope kicks off pclose before returning exit_code
-  {
-    std::array<char, 128> buffer{};
-    // And use the standard C pclose method during stream closure.
-    auto deleter = [&exit_code](std::FILE* ptr) { exit_code = pclose(ptr); };
-
-    // Execute command using popen,
-    std::unique_ptr<std::FILE, decltype(deleter)> pipe(popen(command.c_str(), "r"), deleter);
-    if (!pipe)
-    {
-      throw std::runtime_error("popen() failed!");
-    }
-    while (std::fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr)
-    {
-      output += buffer.data();
-    }
-  }
-  return std::make_pair(exit_code, output);
+  return ProcessRunner::run(program, env_vars, working_directory, stderr_output);
 }
 
 /**
- * \brief Execute command on terminal, give user an error message when exit code is non-zero.
- * Returns stdout output. Redirect stderr to stdout (2>&1), if you want stderr as well.
- * \param[in] command The command to be executed
- * \throws runtime_error when popen failed (empty pipe pointer)
- * \return Terminal stdout output
+ * \brief Environment variables of a program running in the bottle (WINEDEBUG, WINEPREFIX and the bottle variables)
+ * \param[in] prefix_path The path to wine bottle
+ * \param[in] debug_log_level Debug log level
+ * \param[in] env_vars Environment variables of the bottle
+ * \return Environment variables to set
  */
-string Helper::exec_error_message(const string& command)
+vector<pair<string, string>>
+Helper::get_program_env_vars(const string& prefix_path, int debug_log_level, const vector<pair<string, string>>& env_vars)
 {
-  // Max 128 characters
-  std::array<char, 128> buffer;
-  string output = "";
-
-  // Execute command using popen
-  struct custom_file_deleter
-  {
-    void operator()(std::FILE* fp)
-    {
-      // Use a custom close file function during the pipe close (close_exec_stream)
-      // See close_exec_stream below.
-      Helper::close_exec_stream(fp);
-    }
-  };
-  using unique_file_custom_deleter = std::unique_ptr<std::FILE, custom_file_deleter>;
-  unique_file_custom_deleter pipe{popen(command.c_str(), "r")};
-  if (!pipe)
-  {
-    throw std::runtime_error("popen() failed!");
-  }
-  while (fgets(buffer.data(), buffer.size(), pipe.get()) != nullptr)
-  {
-    output += buffer.data();
-  }
-  return output;
-}
-
-/**
- * Custom pclose method, which is executed during the stream closure of C popen command.
- * Check on pclose return value, signal a failure/pop-up to the user, when exit-code is non-zero.
- */
-int Helper::close_exec_stream(std::FILE* file)
-{
-  if (file)
-  {
-    if (pclose(file) != 0)
-    {
-      // Dispatcher will run the connected slot in the main loop,
-      // instead of the same context/thread in case of a signal.emit() call.
-      // This is needed because the CloseFile is called in a different context then usual!
-      // Signal error message to the user:
-      Helper::get_instance().failure_on_exec.emit();
-    }
-  }
-  return 0; // Just always return OK
+  vector<pair<string, string>> program_env_vars;
+  if (debug_log_level != 1)
+    program_env_vars.emplace_back("WINEDEBUG", Helper::log_level_to_winedebug_string(debug_log_level));
+  program_env_vars.emplace_back("WINEPREFIX", prefix_path);
+  program_env_vars.insert(program_env_vars.end(), env_vars.begin(), env_vars.end());
+  return program_env_vars;
 }
 
 /**
@@ -1660,7 +1831,7 @@ string Helper::get_winetricks_version()
   string version = "unknown";
   if (file_exists(WinetricksExecutable))
   {
-    const auto& [exit_code, output] = exec(WinetricksExecutable + " --version");
+    const auto& [exit_code, output] = exec({WinetricksExecutable, "--version"}, {}, "", false);
     if (exit_code == 0 && !output.empty())
     {
       if (output.length() >= 8)
@@ -1682,42 +1853,20 @@ string Helper::get_winetricks_version()
  */
 string Helper::get_reg_value(const string& file_path, const string& key_name, const string& value_name)
 {
-  string output;
-  output.reserve(10);
-  std::ifstream reg_file(file_path);
-  if (reg_file.is_open())
-  {
-    string line;
-    line.reserve(128);
-    bool match = false;
-    while (std::getline(reg_file, line))
-    {
-      if (!match)
-      {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        string value_pattern = '"' + value_name + "\"=";
-        std::size_t pos = line.find(value_pattern);
-        if (pos != std::string::npos)
-        {
-          output = line.substr(pos + value_pattern.size());
-          // Remove quotes
-          output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
-          break;
-        }
-      }
-    }
-    reg_file.close();
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't open registry file during get_reg_value(). Trying to read from file: " << file_path << "(using key: " << key_name
-              << " and value: " << value_name << ")" << std::endl;
-    throw std::runtime_error("Could not open registry file!");
-  }
-  return output;
+  return WineRegistry::open(file_path)->get_value(key_name, value_name);
+}
+
+/**
+ * \brief Get multiple values from the Wine registry from disk at once (the registry is only opened once)
+ * \param[in] file_path        File path of registry
+ * \param[in] key_value_names  Key name (full or part of the path, starting with '[') + value name pairs
+ * \throws runtime_error when we couldn't load the Windows registry
+ * \return Data of each value name in the same order (empty string if not found)
+ */
+vector<string> Helper::get_reg_values(const string& file_path, const vector<pair<string, string>>& key_value_names)
+{
+  vector<WineRegistry::ValueQuery> queries(key_value_names.begin(), key_value_names.end());
+  return WineRegistry::open(file_path)->get_values(queries);
 }
 
 /**
@@ -1729,37 +1878,8 @@ string Helper::get_reg_value(const string& file_path, const string& key_name, co
  */
 vector<string> Helper::get_reg_keys(const string& file_path, const string& key_name)
 {
-  vector<string> keys;
-  keys.reserve(10);
-  std::ifstream reg_file(file_path);
-  if (reg_file.is_open())
-  {
-    string line;
-    line.reserve(128);
-    bool match = false;
-    while (std::getline(reg_file, line))
-    {
-      if (!match)
-      {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        if (line.empty() || reg_file.eof())
-          break; // End of key section in registry
-        if (!line.starts_with('#'))
-          keys.emplace_back(line);
-      }
-    }
-    reg_file.close();
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't open registry file during get_reg_keys(). Trying to read from file: " << file_path << "(using key: " << key_name
-              << ")" << std::endl;
-    throw std::runtime_error("Could not open registry file!");
-  }
-  return keys;
+  auto key_lines = WineRegistry::open(file_path)->get_key_lines(key_name);
+  return vector<string>(key_lines.begin(), key_lines.end());
 }
 
 /**
@@ -1806,48 +1926,15 @@ vector<pair<string, string>> Helper::get_reg_keys_name_data_pair_filter_ignore(c
 {
   vector<pair<string, string>> pairs;
   pairs.reserve(3);
-  std::ifstream reg_file(file_path);
-  if (reg_file.is_open())
+  auto registry = WineRegistry::open(file_path);
+  for (const auto& [name, data] : registry->get_values(key_name))
   {
-    string line;
-    line.reserve(128);
-    bool match = false;
-    while (std::getline(reg_file, line))
+    // Only string data is returned, if filter is not empty it will only continue if the value contains the filter string.
+    // Only the values that are returned get unescaped.
+    if (data.starts_with('"') && is_reg_value_matching(name, data, key_value_filter, key_name_ignore_filter))
     {
-      if (!match)
-      {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        if (line.empty() || reg_file.eof())
-          break; // End of key section in registry
-
-        line = unescape_reg_key_data(line);
-        // Skip '#' elements and if filter is not empty it will only continue if the line contains the filter string
-        if (!line.starts_with('#') && (key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
-            (key_name_ignore_filter.empty() || line.find(key_name_ignore_filter) == string::npos))
-        {
-          auto results = split(line, '"');
-          if (results.size() >= 5)
-          {
-            auto key = results.at(1);
-            key.erase(std::remove(key.begin(), key.end(), '\"'), key.end());
-            auto value = results.at(3);
-            value.erase(std::remove(value.begin(), value.end(), '\"'), value.end());
-            pairs.emplace_back(std::make_pair(key, value));
-          }
-        }
-      }
+      pairs.emplace_back(WineRegistry::unescape(name), WineRegistry::unquote(data));
     }
-    reg_file.close();
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't open registry file during get_reg_keys_name_data_pair_filter_ignore(). Trying to read from file: " << file_path
-              << "(using key: " << key_name << ", key value filter: " << key_value_filter << " and key ignore filter: " << key_name_ignore_filter
-              << ")" << std::endl;
-    throw std::runtime_error("Could not open registry file!");
   }
   return pairs;
 }
@@ -1894,50 +1981,33 @@ vector<string> Helper::get_reg_keys_value_data_filter_ignore(const string& file_
 {
   vector<string> keys;
   keys.reserve(10);
-  std::ifstream reg_file(file_path);
-  if (reg_file.is_open())
+  auto registry = WineRegistry::open(file_path);
+  for (const auto& [name, data] : registry->get_values(key_name))
   {
-    string line;
-    line.reserve(128);
-    bool match = false;
-    while (std::getline(reg_file, line))
+    // Only string data is returned, if filter is not empty it will only continue if the value contains the filter string.
+    // Only the values that are returned get unescaped.
+    if (data.starts_with('"') && is_reg_value_matching(name, data, key_value_filter, key_name_ignore_filter))
     {
-      if (!match)
-      {
-        match = line.starts_with(key_name);
-      }
-      else
-      {
-        if (line.empty() || reg_file.eof())
-          break; // End of key section in registry
-
-        line = unescape_reg_key_data(line);
-        // Skip '#' elements and if filter is not empty it will only continue if the line contains the filter string
-        if (!line.starts_with('#') && (key_value_filter.empty() || line.find(key_value_filter) != string::npos) &&
-            (key_name_ignore_filter.empty() || line.find(key_name_ignore_filter) == string::npos))
-        {
-          auto results = split(line, '"');
-          if (results.size() >= 5)
-          {
-            line = results.at(3);
-            line.erase(std::remove(line.begin(), line.end(), '\"'), line.end());
-            keys.emplace_back(line);
-          }
-        }
-      }
+      keys.emplace_back(WineRegistry::unquote(data));
     }
-    reg_file.close();
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't open registry file during get_reg_keys_value_data_filter_ignore(). Trying to read from file: " << file_path
-              << "(using key: " << key_name << ", key value filter: " << key_value_filter << " and key ignore filter: " << key_name_ignore_filter
-              << ")" << std::endl;
-    throw std::runtime_error("Could not open registry file!");
   }
   return keys;
 }
 
+/**
+ * \brief Check if the raw registry value name + data passes the filters
+ * \param[in] name  Raw (escaped) value name
+ * \param[in] data  Raw (escaped) value data
+ * \param[in] key_value_filter Value should contain the filter string (empty means no filtering)
+ * \param[in] key_name_ignore_filter Value should not contain the ignore filter string (empty means no filtering)
+ * \return True if the value matches the filters
+ */
+bool Helper::is_reg_value_matching(std::string_view name, std::string_view data, const string& key_value_filter, const string& key_name_ignore_filter)
+{
+  auto contains = [&name, &data](const string& filter) { return name.find(filter) != string::npos || data.find(filter) != string::npos; };
+  return (key_value_filter.empty() || contains(key_value_filter)) && (key_name_ignore_filter.empty() || !contains(key_name_ignore_filter));
+}
+
 /**
  * \brief Get a meta value from the registry from disk
  * \param[in] file_path      File of registry
@@ -1947,34 +2017,7 @@ vector<string> Helper::get_reg_keys_value_data_filter_ignore(const string& file_
  */
 string Helper::get_reg_meta_data(const string& file_path, const string& meta_value_name)
 {
-  string output;
-  output.reserve(10);
-  std::ifstream reg_file(file_path);
-  if (reg_file.is_open())
-  {
-    string meta_pattern = "#" + meta_value_name + "=";
-    string line;
-    line.reserve(80);
-    while (std::getline(reg_file, line))
-    {
-      std::size_t pos = line.find(meta_pattern);
-      if (pos != std::string::npos)
-      {
-        output = line.substr(pos + meta_pattern.size());
-        // Remove quotes
-        output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
-        break;
-      }
-    }
-    reg_file.close();
-  }
-  else
-  {
-    std::cerr << "Error: Couldn't open registry file during get_reg_meta_data(). Trying to read from file: " << file_path
-              << "(using meta value name: " << meta_value_name << ")" << std::endl;
-    throw std::runtime_error("Could not open registry file!");
-  }
-  return output;
+  return WineRegistry::open(file_path)->get_meta_data(meta_value_name);
 }
 
 /**
@@ -2053,187 +2096,3 @@ vector<string> Helper::split(const string& s, const char delimiter)
   }
   return output;
 }
-
-/**
- * \brief Parse an escaped Wine registry key data back into an UTF-8 string
- * The code is adopted from the parse_strW() method:
- * https://source.winehq.org/git/wine.git/blob/refs/heads/master:/server/unicode.c#l101
- *
- * \param[in] src Key data to be unescaped
- * \return UTF-8 string
- */
-string Helper::unescape_reg_key_data(const string& src)
-{
-  auto to_hex = [](char ch) -> char { return std::isdigit(ch) ? ch - '0' : std::tolower(ch) - 'a' + 10; };
-
-  auto wchar_to_utf8 = [](wchar_t wc) -> string
-  {
-    string s;
-    if (0 <= wc && wc <= 0x7f)
-    {
-      s += (char)wc;
-    }
-    else if (0x80 <= wc && wc <= 0x7ff)
-    {
-      s += (0xc0 | (wc >> 6));
-      s += (0x80 | (wc & 0x3f));
-    }
-    else if (0x800 <= wc && wc <= 0xffff)
-    {
-      s += (0xe0 | (wc >> 12));
-      s += (0x80 | ((wc >> 6) & 0x3f));
-      s += (0x80 | (wc & 0x3f));
-    }
-    else if (0x10000 <= wc && wc <= 0x1fffff)
-    {
-      s += (0xf0 | (wc >> 18));
-      s += (0x80 | ((wc >> 12) & 0x3f));
-      s += (0x80 | ((wc >> 6) & 0x3f));
-      s += (0x80 | (wc & 0x3f));
-    }
-    else if (0x200000 <= wc && wc <= 0x3ffffff)
-    {
-      s += (0xf8 | (wc >> 24));
-      s += (0x80 | ((wc >> 18) & 0x3f));
-      s += (0x80 | ((wc >> 12) & 0x3f));
-      s += (0x80 | ((wc >> 6) & 0x3f));
-      s += (0x80 | (wc & 0x3f));
-    }
-    else if (0x4000000 <= wc && wc <= 0x7fffffff)
-    {
-      s += (0xfc | (wc >> 30));
-      s += (0x80 | ((wc >> 24) & 0x3f));
-      s += (0x80 | ((wc >> 18) & 0x3f));
-      s += (0x80 | ((wc >> 12) & 0x3f));
-      s += (0x80 | ((wc >> 6) & 0x3f));
-      s += (0x80 | (wc & 0x3f));
-    }
-    return s;
-  };
-
-  string dest;
-  dest.reserve(src.length());
-
-  const char* p = src.c_str();
-  while (*p)
-  {
-    if (*p == '\\')
-    {
-      p++;
-      if (!*p)
-        break;
-
-      switch (*p)
-      {
-      case 'a':
-        dest += '\a';
-        p++;
-        continue;
-      case 'b':
-        dest += '\b';
-        p++;
-        continue;
-      case 'e':
-        dest += '\e';
-        p++;
-        continue;
-      case 'f':
-        dest += '\f';
-        p++;
-        continue;
-      case 'n':
-        dest += '\n';
-        p++;
-        continue;
-      case 'r':
-        dest += '\r';
-        p++;
-        continue;
-      case 't':
-        dest += '\t';
-        p++;
-        continue;
-      case 'v':
-        dest += '\v';
-        p++;
-        continue;
-
-      // hex escape
-      case 'x':
-        p++;
-        if (!std::isxdigit(*p))
-          dest += 'x';
-        else
-        {
-          wchar_t wch = to_hex(*p++);
-          if (std::isxdigit(*p))
-            wch = (wch * 16) + to_hex(*p++);
-          if (std::isxdigit(*p))
-            wch = (wch * 16) + to_hex(*p++);
-          if (std::isxdigit(*p))
-            wch = (wch * 16) + to_hex(*p++);
-          dest += wchar_to_utf8(wch);
-        }
-        continue;
-
-      // octal escape
-      case '0':
-      case '1':
-      case '2':
-      case '3':
-      case '4':
-      case '5':
-      case '6':
-      case '7':
-      {
-        wchar_t wch = *p++ - '0';
-        if (*p >= '0' && *p <= '7')
-          wch = (wch * 8) + (*p++ - '0');
-        if (*p >= '0' && *p <= '7')
-          wch = (wch * 8) + (*p++ - '0');
-        dest += wchar_to_utf8(wch);
-        continue;
-      }
-      }
-      // unrecognized escape: fall through to normal char handling
-    }
-
-    dest += *p++;
-  }
-  return dest;
-}
-
-/**
- * Convert string (chars) to hex
- * \param[in] str Source string
- * \param[in] capital Captical hex values? (default: false, so lower cases)
- * \return Hex numbers of the string
- */
-string Helper::string2hex(const string& str, bool capital)
-{
-  string hexstr;
-  hexstr.resize(str.size() * 2);
-  const size_t a = capital ? 'A' - 1 : 'a' - 1;
-  for (size_t i = 0, c = str[0] & 0xFF; i < hexstr.size(); c = str[i / 2] & 0xFF)
-  {
-    hexstr[i++] = c > 0x9F ? (c / 16 - 9) | a : c / 16 | '0';
-    hexstr[i++] = (c & 0xF) > 9 ? (c % 16 - 9) | a : c % 16 | '0';
-  }
-  return hexstr;
-}
-
-/**
- * \brief Convert hex to string (chars)
- * \return string (chars) of the hex string
- */
-string Helper::hex2string(const string& hexstr)
-{
-  string str;
-  str.resize((hexstr.size() + 1) / 2);
-  for (size_t i = 0, j = 0; i < str.size(); i++, j++)
-  {
-    str[i] = ((hexstr[j] & '@') ? hexstr[j] + 9 : hexstr[j]) << 4, j++;
-    str[i] |= ((hexstr[j] & '@') ? hexstr[j] + 9 : hexstr[j]) & 0xF;
-  }
-  return str;
-}
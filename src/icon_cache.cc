@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    icon_cache.cc
+ * \brief   Process-wide cache of decoded application icons
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "icon_cache.h"
+#include <iostream>
+
+static const int PlaceholderSize = 32; /*!< Size in pixels of the (transparent) placeholder icon, same as the built-in app icons */
+
+/**
+ * \brief Get singleton instance
+ * \return IconCache reference (singleton)
+ */
+IconCache& IconCache::get_instance()
+{
+  static IconCache instance;
+  return instance;
+}
+
+/**
+ * \brief Constructor, the loader thread is started on the first request
+ */
+IconCache::IconCache() : is_stopped_(false)
+{
+  loaded_dispatcher_.connect(sigc::mem_fun(*this, &IconCache::on_loaded));
+}
+
+/**
+ * \brief Destructor, stops the loader thread (pending requests are dropped)
+ */
+IconCache::~IconCache()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopped_ = true;
+  }
+  queue_condition_.notify_one();
+  if (loader_thread_.joinable())
+    loader_thread_.join();
+}
+
+/**
+ * \brief Look-up a decoded icon in the cache
+ * \param[in] file_path Full path to the icon file
+ * \param[out] icon Decoded icon, empty pointer when the icon could not be decoded
+ * \return true if the icon file is already decoded (successful or not), false if it's not (yet) in the cache
+ */
+bool IconCache::lookup(const std::string& file_path, Glib::RefPtr<Gdk::Pixbuf>& icon)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = icons_.find(file_path);
+  if (it == icons_.end())
+    return false;
+  icon = it->second;
+  return true;
+}
+
+/**
+ * \brief Request decoding of an icon file on the background thread.
+ * The icon_loaded signal is emitted (in the GUI thread) once the icon is in the cache.
+ * \param[in] file_path Full path to the icon file
+ */
+void IconCache::request(const std::string& file_path)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (icons_.contains(file_path) || !pending_.insert(file_path).second)
+      return;
+    queue_.push_back(file_path);
+    if (!loader_thread_.joinable())
+      loader_thread_ = std::thread(&IconCache::loader_loop, this);
+  }
+  queue_condition_.notify_one();
+}
+
+/**
+ * \brief Get the placeholder icon, shown while the actual icon is not yet decoded
+ * \return Transparent icon
+ */
+const Glib::RefPtr<Gdk::Pixbuf>& IconCache::get_placeholder()
+{
+  if (!placeholder_)
+  {
+    placeholder_ = Gdk::Pixbuf::create(Gdk::COLORSPACE_RGB, true, 8, PlaceholderSize, PlaceholderSize);
+    placeholder_->fill(0x00000000);
+  }
+  return placeholder_;
+}
+
+/**
+ * \brief Loader thread, decodes the requested icon files one by one
+ */
+void IconCache::loader_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    queue_condition_.wait(lock, [this] { return is_stopped_ || !queue_.empty(); });
+    if (is_stopped_)
+      break;
+    std::string file_path = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+
+    Glib::RefPtr<Gdk::Pixbuf> icon;
+    try
+    {
+      icon = Gdk::Pixbuf::create_from_file(file_path);
+    }
+    catch (const Glib::Error& error)
+    {
+      std::cerr << "ERROR: Could not load icon " << file_path << ": " << error.what() << std::endl;
+    }
+
+    lock.lock();
+    icons_[file_path] = icon;
+    pending_.erase(file_path);
+    bool is_first = loaded_.empty();
+    loaded_.push_back(file_path);
+    // A single dispatch handles all icons loaded in the meantime
+    if (is_first)
+      loaded_dispatcher_.emit();
+  }
+}
+
+/**
+ * \brief Signal handler in the GUI thread, informs about the icons decoded since the last call
+ */
+void IconCache::on_loaded()
+{
+  std::vector<std::string> loaded;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loaded.swap(loaded_);
+  }
+  for (const std::string& file_path : loaded)
+  {
+    icon_loaded.emit(file_path);
+  }
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    log_writer.cc
+ * \brief   Append program output to a log file via a bounded ring buffer
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "log_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+static const std::size_t RingBufferSize = 1024 * 1024; /*!< Maximum amount of data (in bytes) waiting to be written to disk */
+
+/**
+ * \brief Open (or create) the log file for appending and start the writer thread
+ * \param[in] file_path Log file path
+ */
+LogWriter::LogWriter(const std::string& file_path)
+    : buffer_(RingBufferSize),
+      head_(0),
+      size_(0),
+      is_closed_(false),
+      last_char_('\n'),
+      fd_(open(file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644))
+{
+  if (fd_ < 0)
+  {
+    // Keep draining the data, even when we can't write it
+    std::cerr << "Error: Couldn't open log file " << file_path << " for writing: " << std::strerror(errno) << std::endl;
+  }
+  writer_thread_ = std::thread(&LogWriter::writer_loop, this);
+}
+
+/**
+ * \brief Flush the remaining data and close the log file
+ */
+LogWriter::~LogWriter()
+{
+  close();
+}
+
+/**
+ * \brief Queue data to be written to the log file, blocks while the ring buffer is full
+ * \param[in] data Data to append
+ */
+void LogWriter::write(std::string_view data)
+{
+  while (!data.empty())
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return size_ < buffer_.size(); });
+    std::size_t tail = (head_ + size_) % buffer_.size();
+    // Copy until the end of the free space, or until the end of the buffer (wrap around in the next iteration)
+    std::size_t count = std::min({data.size(), buffer_.size() - size_, buffer_.size() - tail});
+    std::memcpy(buffer_.data() + tail, data.data(), count);
+    size_ += count;
+    data.remove_prefix(count);
+    not_empty_.notify_one();
+  }
+}
+
+/**
+ * \brief Write the remaining data to disk, end the log with a new line and close the log file
+ */
+void LogWriter::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_closed_)
+      return;
+    is_closed_ = true;
+  }
+  not_empty_.notify_one();
+  writer_thread_.join();
+  if (fd_ >= 0)
+  {
+    if (last_char_ != '\n')
+      write_to_file("\n", 1);
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+/**
+ * \brief Writer thread, writes the ring buffer contents to disk until the log writer is closed
+ */
+void LogWriter::writer_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    not_empty_.wait(lock, [this] { return size_ > 0 || is_closed_; });
+    if (size_ == 0)
+      break; // Closed and everything is written
+    // Only the contiguous part, the producer only writes into the free space so no need to hold the lock during the write
+    std::size_t count = std::min(size_, buffer_.size() - head_);
+    const char* data = buffer_.data() + head_;
+    lock.unlock();
+    write_to_file(data, count);
+    last_char_ = data[count - 1];
+    lock.lock();
+    head_ = (head_ + count) % buffer_.size();
+    size_ -= count;
+    not_full_.notify_one();
+  }
+}
+
+/**
+ * \brief Write all data to the log file (handles partial writes)
+ * \param[in] data Data to write
+ * \param[in] size Number of bytes
+ */
+void LogWriter::write_to_file(const char* data, std::size_t size)
+{
+  while (fd_ >= 0 && size > 0)
+  {
+    ssize_t written = ::write(fd_, data, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "Error: Couldn't write debug logging to log file. Error " << std::strerror(errno) << std::endl;
+      // Stop writing, the remaining data will be drained
+      ::close(fd_);
+      fd_ = -1;
+      return;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+}
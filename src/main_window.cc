@@ -20,13 +20,17 @@
  */
 #include "main_window.h"
 #include "helper.h"
+#include "icon_cache.h"
 #include "project_config.h"
 #include <algorithm>
 #include <cctype>
+#include <iterator>
 #include <locale>
 #include <set>
 #include <utility>
 
+static const std::size_t AppListBatchSize = 32; /*!< Number of application list items handed over to the GUI thread at once */
+
 /************************
  * Public methods       *
  ************************/
@@ -38,6 +42,7 @@ MainWindow::MainWindow(Menu& menu)
     : window_settings(),
       vbox(Gtk::Orientation::ORIENTATION_VERTICAL),
       paned(Gtk::Orientation::ORIENTATION_HORIZONTAL),
+      left_vbox(Gtk::Orientation::ORIENTATION_VERTICAL),
       right_vbox(Gtk::Orientation::ORIENTATION_VERTICAL),
       app_list_vbox(Gtk::Orientation::ORIENTATION_VERTICAL),
       app_list_top_hbox(Gtk::Orientation::ORIENTATION_HORIZONTAL),
@@ -46,7 +51,9 @@ MainWindow::MainWindow(Menu& menu)
       busy_dialog_(*this),
       unknown_menu_item_name_("- Unknown menu item -"),
       unknown_desktop_item_name_("- Unknown desktop item -"),
-      thread_check_version_(nullptr)
+      thread_check_version_(nullptr),
+      active_bottle_item_(nullptr),
+      app_list_generation_(0)
 {
   // Set some Window properties
   set_title("WineGUI - WINE Manager");
@@ -87,6 +94,9 @@ MainWindow::MainWindow(Menu& menu)
 
   // Left side (listbox)
   listbox.signal_row_selected().connect(sigc::mem_fun(*this, &MainWindow::on_bottle_row_clicked));
+  listbox.signal_selected_rows_changed().connect(sigc::mem_fun(*this, &MainWindow::on_bottle_selection_changed));
+  // Cancel of a batch operation (busy dialog)
+  busy_dialog_.cancel.connect(cancel_busy_task.make_slot());
   // Disabled right-click menu for now, since it doesn't activate the right-clicked bottle as active
   // listbox.signal_button_press_event().connect(right_click_menu);
 
@@ -101,6 +111,12 @@ MainWindow::MainWindow(Menu& menu)
   // Application search
   app_list_search_entry.signal_changed().connect(sigc::mem_fun(*this, &MainWindow::on_app_list_changed));
 
+  // Application list items collected in the background
+  app_list_items_dispatcher_.connect(sigc::mem_fun(*this, &MainWindow::on_application_list_items));
+  app_list_finished_dispatcher_.connect(sigc::mem_fun(*this, &MainWindow::cleanup_app_list_threads));
+  // Application icons decoded in the background
+  IconCache::get_instance().icon_loaded.connect(sigc::mem_fun(*this, &MainWindow::on_icon_loaded));
+
   // Trigger row activated signal on a single click
   application_list_treeview.set_activate_on_single_click(true);
   application_list_treeview.signal_row_activated().connect(sigc::mem_fun(*this, &MainWindow::on_application_row_activated));
@@ -143,6 +159,12 @@ MainWindow::~MainWindow()
 {
   // Avoid zombies
   this->cleanup_check_version_thread();
+  app_list_generation_++;
+  for (auto& [_, thread] : app_list_threads_)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
 }
 
 /**
@@ -151,6 +173,7 @@ MainWindow::~MainWindow()
  */
 void MainWindow::set_wine_bottles(std::list<BottleItem>& bottles)
 {
+  active_bottle_item_ = nullptr;
   // Clear whole listbox
   std::vector<Gtk::Widget*> children = listbox.get_children();
   for (Gtk::Widget* el : children)
@@ -167,6 +190,42 @@ void MainWindow::set_wine_bottles(std::list<BottleItem>& bottles)
   listbox.show_all();
 }
 
+/**
+ * \brief Show skeleton placeholder rows in the left panel, while the bottles are still being loaded
+ */
+void MainWindow::show_bottle_placeholders()
+{
+  active_bottle_item_ = nullptr;
+  // Clear whole listbox
+  std::vector<Gtk::Widget*> children = listbox.get_children();
+  for (Gtk::Widget* el : children)
+  {
+    listbox.remove(*el);
+  }
+
+  for (int i = 0; i < 3; i++)
+  {
+    Gtk::ListBoxRow* row = Gtk::manage(new Gtk::ListBoxRow());
+    row->set_selectable(false);
+    row->set_activatable(false);
+    Gtk::Box* hbox = Gtk::manage(new Gtk::Box(Gtk::Orientation::ORIENTATION_HORIZONTAL, 8));
+    Gtk::Box* vbox_text = Gtk::manage(new Gtk::Box(Gtk::Orientation::ORIENTATION_VERTICAL, 6));
+    hbox->set_margin_top(8);
+    hbox->set_margin_end(8);
+    hbox->set_margin_bottom(8);
+    hbox->set_margin_start(8);
+    vbox_text->set_valign(Gtk::Align::ALIGN_CENTER);
+    vbox_text->pack_start(*create_placeholder_block(140, 14), false, false);
+    vbox_text->pack_start(*create_placeholder_block(90, 10), false, false);
+    hbox->pack_start(*create_placeholder_block(48, 48), false, false);
+    hbox->pack_start(*vbox_text, false, false);
+    row->add(*hbox);
+    listbox.add(*row);
+  }
+  set_sensitive_toolbar_buttons(false);
+  listbox.show_all();
+}
+
 /**
  * \brief Set provided bottle as current selected row (if nothing was selected yet)
  * \param[in] bottle - Wine Bottle item object
@@ -177,6 +236,19 @@ void MainWindow::select_row_bottle(BottleItem& bottle)
     this->listbox.select_row(bottle);
 }
 
+/**
+ * \brief Refresh the detailed info panel and application list, when the provided (patched) bottle is the selected row
+ * \param[in] bottle - Wine Bottle item object
+ */
+void MainWindow::refresh_bottle(BottleItem& bottle)
+{
+  if (bottle.is_selected())
+  {
+    set_detailed_info(bottle);
+    set_application_list(bottle.wine_location(), bottle.app_list());
+  }
+}
+
 /**
  * \brief Reset the detailed info panel
  */
@@ -275,6 +347,37 @@ bool MainWindow::show_confirm_dialog(const Glib::ustring& message, bool markup)
   return return_value;
 }
 
+/**
+ * \brief Show busy indicator with a custom heading
+ * \param[in] heading_text Heading text
+ * \param[in] message Given the user more information what is going on
+ */
+void MainWindow::show_busy_dialog(const Glib::ustring& heading_text, const Glib::ustring& message)
+{
+  busy_dialog_.set_message(heading_text, message);
+  busy_dialog_.show();
+}
+
+/**
+ * \brief Show the progress of the bottles being removed in the background
+ * \param[in] text Progress text
+ * \param[in] fraction Progress between 0.0 and 1.0
+ */
+void MainWindow::show_remove_progress(const Glib::ustring& text, double fraction)
+{
+  remove_progress_bar.set_text(text);
+  remove_progress_bar.set_fraction(fraction);
+  remove_progress_bar.show();
+}
+
+/**
+ * \brief Hide the removal progress again
+ */
+void MainWindow::hide_remove_progress()
+{
+  remove_progress_bar.hide();
+}
+
 /**
  * \brief Show busy indicator (like busy installing corefonts in Wine bottle)
  * \param[in] message Given the user more information what is going on
@@ -297,11 +400,36 @@ void MainWindow::show_busy_install_dialog(Gtk::Window& parent, const Glib::ustri
   busy_dialog_.show();
 }
 
+/**
+ * \brief Show busy indicator with progress and a cancel button (like busy updating multiple Wine bottles)
+ * \param[in] parent Parent GTK Window (set to be the GTK transient for)
+ * \param[in] heading_text Heading text
+ * \param[in] message Given the user more information what is going on
+ */
+void MainWindow::show_busy_progress_dialog(Gtk::Window& parent, const Glib::ustring& heading_text, const Glib::ustring& message)
+{
+  busy_dialog_.set_message(heading_text, message);
+  busy_dialog_.set_transient_for(parent);
+  busy_dialog_.set_cancellable(true);
+  busy_dialog_.show();
+  busy_dialog_.set_progress(0.0);
+}
+
+/**
+ * \brief Update the progress of the busy dialog
+ * \param[in] fraction Progress between 0.0 and 1.0
+ */
+void MainWindow::set_busy_dialog_progress(double fraction)
+{
+  busy_dialog_.set_progress(fraction);
+}
+
 /**
  * \brief Close the busy dialog again
  */
 void MainWindow::close_busy_dialog()
 {
+  busy_dialog_.set_cancellable(false);
   busy_dialog_.hide();
 }
 
@@ -395,6 +523,9 @@ void MainWindow::on_run_button_clicked()
 void MainWindow::on_refresh_app_list_button_clicked()
 {
   Gtk::ListBoxRow* selected_row = listbox.get_selected_row();
+  // With multiple selected bottles, take the first one
+  if (selected_row == nullptr && !listbox.get_selected_rows().empty())
+    selected_row = listbox.get_selected_rows().front();
   if (selected_row)
   {
     // Refresh the current app list
@@ -462,9 +593,10 @@ void MainWindow::on_exec_failure()
  */
 void MainWindow::on_bottle_row_clicked(Gtk::ListBoxRow* row)
 {
-  if (row != nullptr)
+  auto current_bottle = dynamic_cast<BottleItem*>(row);
+  // Placeholder rows are no bottle items
+  if (current_bottle != nullptr)
   {
-    auto current_bottle = dynamic_cast<BottleItem*>(row);
     // Set bottle details
     set_detailed_info(*current_bottle);
     // Set application list
@@ -474,10 +606,29 @@ void MainWindow::on_bottle_row_clicked(Gtk::ListBoxRow* row)
 
     // Signal activate Bottle with current BottleItem as parameter to the dispatcher
     // Which updates the connected modules accordingly.
+    active_bottle_item_ = current_bottle;
     active_bottle.emit(current_bottle);
   }
 }
 
+/**
+ * \brief Signal all the selected bottles (Ctrl/Shift + click selects multiple bottles), used for batch operations
+ */
+void MainWindow::on_bottle_selection_changed()
+{
+  std::vector<BottleItem*> bottles;
+  for (Gtk::ListBoxRow* row : listbox.get_selected_rows())
+  {
+    auto bottle = dynamic_cast<BottleItem*>(row);
+    if (bottle != nullptr)
+      bottles.push_back(bottle);
+  }
+  // Ctrl + click can deselect the active bottle, the first selected bottle becomes the active bottle instead
+  if (!bottles.empty() && std::find(bottles.begin(), bottles.end(), active_bottle_item_) == bottles.end())
+    on_bottle_row_clicked(bottles.front());
+  selected_bottles.emit(bottles);
+}
+
 void MainWindow::on_app_list_changed()
 {
   // Refilter
@@ -618,12 +769,22 @@ void MainWindow::set_detailed_info(const BottleItem& bottle)
 }
 
 /**
- * \brief Set application list
+ * \brief Set application list. The custom applications are added directly, the start menu/desktop items (which require
+ * reading the registry, desktop and shortcut files) are collected by a thread and added in batches.
  * \param prefix_path Wine bottle prefix
  * \param app_List Custom application list for this bottle
  */
 void MainWindow::set_application_list(const string& prefix_path, const std::map<int, ApplicationData>& app_list)
 {
+  // Let a running application list thread (of the previously selected bottle) stop, without waiting for it.
+  // The thread is joined once it signals it's finished (see cleanup_app_list_threads).
+  std::size_t generation;
+  {
+    std::lock_guard<std::mutex> lock(app_list_mutex_);
+    generation = ++app_list_generation_;
+    pending_app_list_items_.clear();
+  }
+
   // First clear list + clear search entry
   reset_application_list();
 
@@ -635,6 +796,28 @@ void MainWindow::set_application_list(const string& prefix_path, const std::map<
     add_application(app_data.name, app_data.description, command, icon);
   }
 
+  // Start the application list thread
+  std::thread thread_app_list(
+      [this, generation, prefix_path]
+      {
+        load_application_list(generation, prefix_path);
+        {
+          std::lock_guard<std::mutex> lock(app_list_mutex_);
+          finished_app_list_threads_.push_back(generation);
+        }
+        app_list_finished_dispatcher_.emit();
+      });
+  app_list_threads_.emplace(generation, std::move(thread_app_list));
+}
+
+/**
+ * \brief Collect the start menu items, desktop items and the additional programs (runs in thread)
+ * \param[in] generation Application list generation of this thread, stops when a newer application list is set
+ * \param[in] prefix_path Wine bottle prefix
+ */
+void MainWindow::load_application_list(std::size_t generation, const string& prefix_path)
+{
+  std::vector<ApplicationListItem> batch;
   // Temporally store the list of menu item names,
   // used for checking for duplicates when adding desktop items
   std::set<std::string> menu_item_names;
@@ -708,7 +891,8 @@ void MainWindow::set_application_list(const string& prefix_path, const std::map<
         icon = Helper::string_to_icon(item);
         is_icon_full_path = false;
       }
-      add_application(name, comment, item, icon, is_icon_full_path);
+      if (!add_to_application_batch(generation, batch, {name, comment, item, icon, is_icon_full_path}))
+        return;
       // Also add the name to your list, used for finding duplicates when adding desktop files
       if (name != unknown_menu_item_name_)
         menu_item_names.insert(name);
@@ -787,7 +971,8 @@ void MainWindow::set_application_list(const string& prefix_path, const std::map<
           icon = Helper::string_to_icon(value_name);
           is_icon_full_path = false;
         }
-        add_application(name, "", value_data, icon, is_icon_full_path);
+        if (!add_to_application_batch(generation, batch, {name, "", value_data, icon, is_icon_full_path}))
+          return;
       }
     }
   }
@@ -797,20 +982,71 @@ void MainWindow::set_application_list(const string& prefix_path, const std::map<
   }
 
   // Lastly, the additional programs
-  add_application("Wine Config", "Wine configuration program", "winecfg", "winecfg");
-  add_application("Uninstaller", "Remove programs", "uninstaller", "uninstaller");
-  add_application("Control Panel", "Wine control panel", "control", "winecontrol");
-  add_application("WineMine", "Wine Minesweeper single-player game", "winemine", "minesweeper");
-  add_application("Winetricks", "Wine helper script to download and install various libraries", Helper::get_winetricks_location() + " --gui -q",
-                  "winetricks");
-  add_application("Notepad", "Text editor", "notepad", "notepad");
-  add_application("File Manager", "Wine File manager", "winefile", "winefile");
-  add_application("Internet Explorer", "Wine Internet Explorer", "iexplore", "internet_explorer");
-  add_application("Task Manager", "Task Manager", "taskmgr", "task_manager");
-  add_application("File Explorer", "File explorer", "explorer", "file_explorer");
-  add_application("Command Prompt", "Command-line interpreter", "wineconsole", "command_prompt");
-  add_application("Registry editor", "Windows registry editor", "regedit", "regedit");
-  add_application("Wine OLE View", "Windows OLE object viewer", "oleview", "oleview");
+  batch.push_back({"Wine Config", "Wine configuration program", "winecfg", "winecfg", false});
+  batch.push_back({"Uninstaller", "Remove programs", "uninstaller", "uninstaller", false});
+  batch.push_back({"Control Panel", "Wine control panel", "control", "winecontrol", false});
+  batch.push_back({"WineMine", "Wine Minesweeper single-player game", "winemine", "minesweeper", false});
+  batch.push_back({"Winetricks", "Wine helper script to download and install various libraries", Helper::get_winetricks_location() + " --gui -q",
+                   "winetricks", false});
+  batch.push_back({"Notepad", "Text editor", "notepad", "notepad", false});
+  batch.push_back({"File Manager", "Wine File manager", "winefile", "winefile", false});
+  batch.push_back({"Internet Explorer", "Wine Internet Explorer", "iexplore", "internet_explorer", false});
+  batch.push_back({"Task Manager", "Task Manager", "taskmgr", "task_manager", false});
+  batch.push_back({"File Explorer", "File explorer", "explorer", "file_explorer", false});
+  batch.push_back({"Command Prompt", "Command-line interpreter", "wineconsole", "command_prompt", false});
+  batch.push_back({"Registry editor", "Windows registry editor", "regedit", "regedit", false});
+  batch.push_back({"Wine OLE View", "Windows OLE object viewer", "oleview", "oleview", false});
+  flush_application_batch(generation, batch);
+}
+
+/**
+ * \brief Add an item to the batch, the batch is handed over to the GUI thread when full (runs in thread)
+ * \param[in] generation Application list generation of the calling thread
+ * \param[in,out] batch Items not yet handed over
+ * \param[in] item Application item
+ * \return false if the application list is outdated (the thread should stop), otherwise true
+ */
+bool MainWindow::add_to_application_batch(std::size_t generation, std::vector<ApplicationListItem>& batch, ApplicationListItem item)
+{
+  batch.push_back(std::move(item));
+  if (batch.size() >= AppListBatchSize)
+    return flush_application_batch(generation, batch);
+  return (app_list_generation_ == generation);
+}
+
+/**
+ * \brief Hand over the batch of items to the GUI thread (runs in thread)
+ * \param[in] generation Application list generation of the calling thread
+ * \param[in,out] batch Items to hand over, cleared afterwards
+ * \return false if the application list is outdated (the items are dropped), otherwise true
+ */
+bool MainWindow::flush_application_batch(std::size_t generation, std::vector<ApplicationListItem>& batch)
+{
+  {
+    std::lock_guard<std::mutex> lock(app_list_mutex_);
+    if (app_list_generation_ != generation)
+      return false;
+    pending_app_list_items_.insert(pending_app_list_items_.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+  }
+  batch.clear();
+  app_list_items_dispatcher_.emit();
+  return true;
+}
+
+/**
+ * \brief Signal handler when the application list thread handed over a batch of items
+ */
+void MainWindow::on_application_list_items()
+{
+  std::vector<ApplicationListItem> items;
+  {
+    std::lock_guard<std::mutex> lock(app_list_mutex_);
+    items.swap(pending_app_list_items_);
+  }
+  for (const ApplicationListItem& item : items)
+  {
+    add_application(item.name, item.description, item.command, item.icon, item.is_icon_full_path);
+  }
 }
 
 /**
@@ -827,16 +1063,34 @@ void MainWindow::add_application(const string& name, const string& description,
   row[app_list_columns.name] = Helper::encode_text(name);
   row[app_list_columns.description] = Helper::encode_text(description);
   row[app_list_columns.command] = command;
-  try
+  string icon_path = (is_icon_full_path) ? icon : Helper::get_image_location("apps/" + icon + ".png");
+  row[app_list_columns.icon_path] = icon_path;
+  // Icons are decoded in the background, show a placeholder until the icon is available (see on_icon_loaded)
+  IconCache& icon_cache = IconCache::get_instance();
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+  if (icon_cache.lookup(icon_path, pixbuf))
   {
-    if (!is_icon_full_path)
-      row[app_list_columns.icon] = Gdk::Pixbuf::create_from_file(Helper::get_image_location("apps/" + icon + ".png"));
-    else
-      row[app_list_columns.icon] = Gdk::Pixbuf::create_from_file(icon); // Use icon as full path
+    row[app_list_columns.icon] = pixbuf;
+  }
+  else
+  {
+    row[app_list_columns.icon] = icon_cache.get_placeholder();
+    icon_cache.request(icon_path);
   }
-  catch (const Glib::Error& error)
+}
+
+/**
+ * \brief Signal handler when an icon is decoded, replaces the placeholder icon of the rows using this icon
+ * \param[in] icon_path Full path of the icon file
+ */
+void MainWindow::on_icon_loaded(const string& icon_path)
+{
+  Glib::RefPtr<Gdk::Pixbuf> pixbuf;
+  IconCache::get_instance().lookup(icon_path, pixbuf);
+  for (auto& row : app_list_tree_model->children())
   {
-    std::cerr << "ERROR: Could not find icon (" << icon << ") for app " << name << ": " << error.what() << std::endl;
+    if (row.get_value(app_list_columns.icon_path) == icon_path)
+      row[app_list_columns.icon] = pixbuf;
   }
 }
 
@@ -854,6 +1108,28 @@ void MainWindow::cleanup_check_version_thread()
   }
 }
 
+/**
+ * \brief Helper method for cleaning the finished application list threads (the join doesn't block, the threads are already done).
+ */
+void MainWindow::cleanup_app_list_threads()
+{
+  std::vector<std::size_t> finished_threads;
+  {
+    std::lock_guard<std::mutex> lock(app_list_mutex_);
+    finished_threads.swap(finished_app_list_threads_);
+  }
+  for (std::size_t generation : finished_threads)
+  {
+    auto it = app_list_threads_.find(generation);
+    if (it != app_list_threads_.end())
+    {
+      if (it->second.joinable())
+        it->second.join();
+      app_list_threads_.erase(it);
+    }
+  }
+}
+
 /**
  * \brief Check for WineGUI version, is there an update?
  * \param show_equal_or_error Also show message when the versions matches or an error occurs.
@@ -957,9 +1233,17 @@ void MainWindow::load_stored_window_settings()
  */
 void MainWindow::create_left_panel()
 {
-  // Add scrolled window with listbox to paned
-  paned.pack1(scrolled_window_listbox);
-
+  // Add scrolled window with listbox to paned, with the removal progress below (only visible during a removal)
+  left_vbox.pack_start(scrolled_window_listbox, true, true);
+  left_vbox.pack_end(remove_progress_bar, false, false);
+  remove_progress_bar.set_show_text(true);
+  remove_progress_bar.set_margin_top(4);
+  remove_progress_bar.set_margin_bottom(4);
+  remove_progress_bar.set_no_show_all(true);
+  paned.pack1(left_vbox);
+
+  // Allow selecting multiple bottles (Ctrl/Shift + click), for batch operations
+  listbox.set_selection_mode(Gtk::SelectionMode::SELECTION_MULTIPLE);
   // Set function that will add separators between each item
   listbox.set_header_func(sigc::ptr_fun(&MainWindow::cc_list_box_update_header_func));
 
@@ -967,6 +1251,27 @@ void MainWindow::create_left_panel()
   scrolled_window_listbox.add(listbox);
 }
 
+/**
+ * \brief Create a grey block, used for the skeleton placeholder rows
+ * \param width Width of the block in pixels
+ * \param height Height of the block in pixels
+ * \return Managed box widget
+ */
+Gtk::Box* MainWindow::create_placeholder_block(int width, int height)
+{
+  if (!placeholder_css_provider_)
+  {
+    placeholder_css_provider_ = Gtk::CssProvider::create();
+    placeholder_css_provider_->load_from_data("box.placeholder { background-color: alpha(@theme_fg_color, 0.1); border-radius: 4px; }");
+  }
+  Gtk::Box* block = Gtk::manage(new Gtk::Box());
+  block->set_size_request(width, height);
+  block->set_halign(Gtk::Align::ALIGN_START);
+  block->get_style_context()->add_class("placeholder");
+  block->get_style_context()->add_provider(placeholder_css_provider_, GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+  return block;
+}
+
 /**
  * \brief Create right side of the GUI
  */
@@ -37,6 +37,8 @@ Menu::Menu() : file("_File", true), view("_View", true), machine("_Machine", tru
   preferences_menuitem->signal_activate().connect(preferences);
   auto exit_menuitem = create_image_menu_item("Exit", "application-exit");
   exit_menuitem->signal_activate().connect(quit);
+  auto deduplicate_menuitem = create_image_menu_item("Deduplicate Machines", "edit-find-replace");
+  deduplicate_menuitem->signal_activate().connect(deduplicate);
 
   // View submenu
   auto refresh_menuitem = create_image_menu_item("Refresh List", "view-refresh");
@@ -73,6 +75,7 @@ Menu::Menu() : file("_File", true), view("_View", true), machine("_Machine", tru
   // Add items to sub-menu
   // File menu
   file_submenu.append(*preferences_menuitem);
+  file_submenu.append(*deduplicate_menuitem);
   file_submenu.append(separator1);
   file_submenu.append(*exit_menuitem);
 
@@ -0,0 +1,429 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    overlay_bottle.cc
+ * \brief   Copy-on-write bottles layered on top of a template bottle (fuse-overlayfs)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "overlay_bottle.h"
+#include "bottle_remover.h"
+#include "helper.h"
+#include "process_runner.h"
+#include <cerrno>
+#include <cstring>
+#include <glib/gstdio.h>
+#include <glibmm.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+static const std::string OverlayFileName = "overlay.ini";                               /*!< Overlay definition file, within the overlay directory */
+static const std::string OverlayGroup = "Overlay";                                      /*!< Key file group of the overlay definition */
+static const std::string FuseOverlayProgram = "fuse-overlayfs";                         /*!< Mounts the overlay as normal user */
+static const std::vector<std::string> FuseUnmountPrograms{"fusermount3", "fusermount"}; /*!< FUSE 3 or FUSE 2 */
+
+/**
+ * \brief Escape a path for the fuse-overlayfs mount options (a comma separates the options, a colon the lower directories)
+ * \param[in] path Path
+ * \return Escaped path
+ */
+static std::string escape_option_path(const std::string& path)
+{
+  std::string escaped;
+  for (char c : path)
+  {
+    if (c == ',' || c == ':' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+/**
+ * \brief Remove a directory including its contents
+ * \param[in] path Directory path
+ * \return true on success, otherwise false
+ */
+static bool remove_directory(const std::string& path)
+{
+  try
+  {
+    return BottleRemover::remove(path);
+  }
+  catch (const std::runtime_error&)
+  {
+    return false; // Already logged
+  }
+}
+
+/**
+ * \brief Check if fuse-overlayfs is installed, which is required for overlay bottles
+ * \return true if available, otherwise false
+ */
+bool OverlayBottle::is_available()
+{
+  return !Glib::find_program_in_path(FuseOverlayProgram).empty();
+}
+
+/**
+ * \brief Create a new overlay bottle on top of a template bottle, and mount it.
+ * The template bottle should not be changed afterwards, the changes show up in all its overlay bottles.
+ * \param[in] template_prefix_path Template bottle (read-only lower layer)
+ * \param[in] prefix_path New bottle folder (should not exist yet)
+ * \throws runtime_error when the overlay could not be created or mounted
+ */
+void OverlayBottle::create(const std::string& template_prefix_path, const std::string& prefix_path)
+{
+  Overlay template_overlay;
+  if (!is_available())
+  {
+    std::cerr << "Error: Couldn't create overlay bottle, " << FuseOverlayProgram << " is not installed." << std::endl;
+    throw std::runtime_error("Sharing the files of a machine requires " + FuseOverlayProgram + ", which is not installed.");
+  }
+  if (find_overlay(template_prefix_path, template_overlay))
+  {
+    std::cerr << "Error: Couldn't create overlay bottle, the template is an overlay bottle itself: " << template_prefix_path << std::endl;
+    throw std::runtime_error("The machine " + Helper::get_folder_name(template_prefix_path) +
+                             " already shares the files of another machine.\nOnly a fully copied machine can be used as template.");
+  }
+  if (Glib::file_test(prefix_path, Glib::FileTest::FILE_TEST_EXISTS))
+  {
+    std::cerr << "Error: Couldn't create overlay bottle, folder already exists: " << prefix_path << std::endl;
+    throw std::runtime_error("The folder already exists: " + prefix_path);
+  }
+
+  // The overlay directory is named after the bottle folder (must be unique, also after renaming bottles)
+  std::string name = Glib::path_get_basename(prefix_path);
+  std::string directory = Glib::build_filename(get_overlays_directory(), name);
+  for (int i = 2; Glib::file_test(directory, Glib::FileTest::FILE_TEST_EXISTS); ++i)
+  {
+    directory = Glib::build_filename(get_overlays_directory(), name + "_" + std::to_string(i));
+  }
+  Overlay overlay{directory, template_prefix_path, prefix_path};
+  if (g_mkdir_with_parents(Glib::build_filename(directory, "upper").c_str(), 0700) != 0 ||
+      g_mkdir_with_parents(Glib::build_filename(directory, "work").c_str(), 0700) != 0)
+  {
+    std::cerr << "Error: Couldn't create overlay directory: " << directory << std::endl;
+    remove_directory(directory);
+    throw std::runtime_error("Could not create the overlay directory: " + directory);
+  }
+  if (g_mkdir(prefix_path.c_str(), 0755) != 0)
+  {
+    std::cerr << "Error: Couldn't create the bottle folder: " << prefix_path << std::endl;
+    remove_directory(directory);
+    throw std::runtime_error("Could not create the folder: " + prefix_path);
+  }
+
+  try
+  {
+    write_overlay_file(overlay);
+    mount(overlay);
+  }
+  catch (const std::runtime_error&)
+  {
+    g_rmdir(prefix_path.c_str());
+    remove_directory(directory);
+    throw;
+  }
+}
+
+/**
+ * \brief Mount all overlay bottles which are not mounted yet (eg. after a reboot), stale mounts are mounted again.
+ * Errors are only logged, the bottle will then show up as empty folder.
+ */
+void OverlayBottle::mount_all()
+{
+  if (!is_available())
+    return;
+
+  for (const Overlay& overlay : get_overlays())
+  {
+    struct stat mount_stat;
+    if (stat(overlay.mount_path.c_str(), &mount_stat) != 0)
+    {
+      if (errno != ENOTCONN)
+      {
+        std::cerr << "Error: Overlay bottle folder is missing, not mounting: " << overlay.mount_path << std::endl;
+        continue;
+      }
+      // Stale mount, the fuse-overlayfs process is gone
+      try
+      {
+        unmount(overlay.mount_path);
+      }
+      catch (const std::runtime_error&)
+      {
+        continue; // Already logged
+      }
+    }
+    else if (is_mounted(overlay.mount_path))
+    {
+      continue;
+    }
+
+    try
+    {
+      mount(overlay);
+    }
+    catch (const std::runtime_error&)
+    {
+      // Already logged
+    }
+  }
+}
+
+/**
+ * \brief Check if the bottle is an overlay bottle
+ * \param[in] prefix_path Bottle folder
+ * \return true if overlay bottle, otherwise false
+ */
+bool OverlayBottle::is_overlay(const std::string& prefix_path)
+{
+  Overlay overlay;
+  return find_overlay(prefix_path, overlay);
+}
+
+/**
+ * \brief Get the overlay bottles using the bottle as template
+ * \param[in] template_prefix_path Template bottle folder
+ * \return Bottle folders of the overlay bottles
+ */
+std::vector<std::string> OverlayBottle::get_derived_bottles(const std::string& template_prefix_path)
+{
+  std::vector<std::string> derived_bottles;
+  for (const Overlay& overlay : get_overlays())
+  {
+    if (overlay.lower_path == template_prefix_path)
+      derived_bottles.push_back(overlay.mount_path);
+  }
+  return derived_bottles;
+}
+
+/**
+ * \brief Check if the bottle is the template of a mounted overlay bottle. The files of the template should not be changed
+ * while the overlays are mounted (changes to the lower layer of a mounted overlay are undefined behavior).
+ * \param[in] template_prefix_path Template bottle folder
+ * \return true if at least one of the derived bottles is mounted, otherwise false
+ */
+bool OverlayBottle::is_template_in_use(const std::string& template_prefix_path)
+{
+  for (const std::string& derived_bottle : get_derived_bottles(template_prefix_path))
+  {
+    if (is_mounted(derived_bottle))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * \brief Rename the folder of an overlay bottle (a mount point can't be renamed while mounted)
+ * \param[in] prefix_path Current bottle folder
+ * \param[in] new_prefix_path New bottle folder
+ * \throws runtime_error when the overlay could not be moved or mounted again
+ */
+void OverlayBottle::move(const std::string& prefix_path, const std::string& new_prefix_path)
+{
+  Overlay overlay;
+  if (!find_overlay(prefix_path, overlay))
+  {
+    throw std::runtime_error("Not an overlay machine: " + prefix_path);
+  }
+  if (is_mounted(prefix_path))
+    unmount(prefix_path);
+  Helper::rename_wine_bottle_folder(prefix_path, new_prefix_path);
+  overlay.mount_path = new_prefix_path;
+  write_overlay_file(overlay);
+  mount(overlay);
+}
+
+/**
+ * \brief Unmount an overlay bottle and move its own changes to the trash (the template bottle is untouched).
+ * The trash folder is removed afterwards (in the background) by BottleRemover::remove().
+ * \param[in] prefix_path Bottle folder
+ * \throws runtime_error when the overlay could not be unmounted or removed
+ * \return Trash folder of the overlay directory
+ */
+std::string OverlayBottle::move_to_trash(const std::string& prefix_path)
+{
+  Overlay overlay;
+  if (!find_overlay(prefix_path, overlay))
+  {
+    throw std::runtime_error("Not an overlay machine: " + prefix_path);
+  }
+  // A stale mount (the fuse-overlayfs process is gone) is not detected as mounted, but needs to be unmounted as well
+  struct stat mount_stat;
+  bool is_stale_mount = stat(prefix_path.c_str(), &mount_stat) != 0 && errno == ENOTCONN;
+  if (is_stale_mount || is_mounted(prefix_path))
+    unmount(prefix_path);
+  if (g_rmdir(prefix_path.c_str()) != 0 && errno != ENOENT)
+  {
+    int error = errno;
+    std::cerr << "Error: Couldn't remove the overlay bottle folder " << prefix_path << ": " << std::strerror(error) << std::endl;
+    throw std::runtime_error("Something went wrong when removing the Windows Machine.\n\nFull path location: " + prefix_path + " (" +
+                             std::strerror(error) + ")");
+  }
+  // The upper and work directories are removed together with the definition, so the overlay is not mounted again
+  return BottleRemover::move_to_trash(overlay.directory);
+}
+
+/**
+ * \brief Get the directory containing all overlays
+ * \return Directory path (~/.local/share/winegui/overlays)
+ */
+std::string OverlayBottle::get_overlays_directory()
+{
+  return Glib::build_filename(Glib::get_user_data_dir(), "winegui", "overlays");
+}
+
+/**
+ * \brief Read all overlay definitions
+ * \return Overlays, invalid definitions are skipped
+ */
+std::vector<OverlayBottle::Overlay> OverlayBottle::get_overlays()
+{
+  std::vector<Overlay> overlays;
+  std::string overlays_directory = get_overlays_directory();
+  if (!Glib::file_test(overlays_directory, Glib::FileTest::FILE_TEST_IS_DIR))
+    return overlays;
+
+  try
+  {
+    Glib::Dir dir(overlays_directory);
+    for (const std::string& name : dir)
+    {
+      // Overlays being removed (see move_to_trash())
+      if (BottleRemover::is_trash(name))
+        continue;
+      std::string directory = Glib::build_filename(overlays_directory, name);
+      std::string overlay_file = Glib::build_filename(directory, OverlayFileName);
+      if (!Glib::file_test(overlay_file, Glib::FileTest::FILE_TEST_IS_REGULAR))
+        continue;
+      try
+      {
+        Glib::KeyFile keyfile;
+        keyfile.load_from_file(overlay_file);
+        overlays.push_back({directory, keyfile.get_string(OverlayGroup, "LowerDir"), keyfile.get_string(OverlayGroup, "MountPoint")});
+      }
+      catch (const Glib::Error& ex)
+      {
+        std::cerr << "Error: Invalid overlay definition " << overlay_file << ": " << ex.what() << std::endl;
+      }
+    }
+  }
+  catch (const Glib::FileError& ex)
+  {
+    std::cerr << "Error: Could not read the overlays directory: " << ex.what() << std::endl;
+  }
+  return overlays;
+}
+
+/**
+ * \brief Find the overlay definition of a bottle
+ * \param[in] prefix_path Bottle folder
+ * \param[out] overlay Overlay definition, only set when found
+ * \return true if found, otherwise false
+ */
+bool OverlayBottle::find_overlay(const std::string& prefix_path, Overlay& overlay)
+{
+  for (const Overlay& item : get_overlays())
+  {
+    if (item.mount_path == prefix_path)
+    {
+      overlay = item;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Write the overlay definition file
+ * \param[in] overlay Overlay
+ * \throws runtime_error when the file could not be written
+ */
+void OverlayBottle::write_overlay_file(const Overlay& overlay)
+{
+  std::string overlay_file = Glib::build_filename(overlay.directory, OverlayFileName);
+  try
+  {
+    Glib::KeyFile keyfile;
+    keyfile.set_string(OverlayGroup, "LowerDir", overlay.lower_path);
+    keyfile.set_string(OverlayGroup, "MountPoint", overlay.mount_path);
+    if (keyfile.save_to_file(overlay_file))
+      return;
+  }
+  catch (const Glib::Error& ex)
+  {
+    std::cerr << "Error: Exception while saving key file: " << ex.what() << std::endl;
+  }
+  throw std::runtime_error("Could not write the overlay file: " + overlay_file);
+}
+
+/**
+ * \brief Mount the overlay with fuse-overlayfs (which keeps running in the background)
+ * \param[in] overlay Overlay
+ * \throws runtime_error when the overlay could not be mounted
+ */
+void OverlayBottle::mount(const Overlay& overlay)
+{
+  std::string options = "lowerdir=" + escape_option_path(overlay.lower_path) +
+                        ",upperdir=" + escape_option_path(Glib::build_filename(overlay.directory, "upper")) +
+                        ",workdir=" + escape_option_path(Glib::build_filename(overlay.directory, "work"));
+  const auto& [exit_code, output] = ProcessRunner::run({FuseOverlayProgram, "-o", options, overlay.mount_path});
+  if (exit_code != 0)
+  {
+    std::cerr << "Error: Couldn't mount overlay bottle " << overlay.mount_path << ", output: " << output << std::endl;
+    throw std::runtime_error("Could not mount the machine " + Helper::get_folder_name(overlay.mount_path) + ".\n\n" + output);
+  }
+}
+
+/**
+ * \brief Unmount the overlay (fusermount3 or fusermount)
+ * \param[in] mount_path Bottle folder
+ * \throws runtime_error when the overlay could not be unmounted (eg. when a Wine program is still running)
+ */
+void OverlayBottle::unmount(const std::string& mount_path)
+{
+  for (const std::string& program : FuseUnmountPrograms)
+  {
+    if (Glib::find_program_in_path(program).empty())
+      continue;
+    const auto& [exit_code, output] = ProcessRunner::run({program, "-u", mount_path});
+    if (exit_code != 0)
+    {
+      std::cerr << "Error: Couldn't unmount overlay bottle " << mount_path << ", output: " << output << std::endl;
+      throw std::runtime_error("Could not unmount the machine " + Helper::get_folder_name(mount_path) +
+                               ", is there still a program running?\n\n" + output);
+    }
+    return;
+  }
+  std::cerr << "Error: Couldn't unmount overlay bottle " << mount_path << ", fusermount is not installed." << std::endl;
+  throw std::runtime_error("Could not unmount the machine " + Helper::get_folder_name(mount_path) + ", fusermount is not installed.");
+}
+
+/**
+ * \brief Check if the overlay is mounted, the mount point is then on a different device than its parent folder
+ * \param[in] mount_path Bottle folder
+ * \return true if mounted, otherwise false
+ */
+bool OverlayBottle::is_mounted(const std::string& mount_path)
+{
+  struct stat mount_stat;
+  struct stat parent_stat;
+  if (stat(mount_path.c_str(), &mount_stat) != 0 || stat(Glib::path_get_dirname(mount_path).c_str(), &parent_stat) != 0)
+    return false;
+  return mount_stat.st_dev != parent_stat.st_dev;
+}
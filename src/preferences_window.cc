@@ -32,6 +32,7 @@ PreferencesWindow::PreferencesWindow(Gtk::Window& parent)
       header_preferences_label("Preferences"),
       default_folder_label("Machine folder location: "),
       display_default_wine_machine_label("Show default Wine machine: "),
+      batch_parallelism_label("Parallel machine operations: "),
       logging_stderr_label("Log standard error:"),
       display_default_wine_machine_check("Display default Wine prefix bottle (at: ~/.wine)"),
       enable_logging_stderr_check("Also log standard error (if logging is enabled)"),
@@ -64,8 +65,13 @@ PreferencesWindow::PreferencesWindow(Gtk::Window& parent)
   logging_label_heading.set_markup("<big><b>Logging</b></big>");
   default_folder_label.set_halign(Gtk::Align::ALIGN_END);
   display_default_wine_machine_label.set_halign(Gtk::Align::ALIGN_END);
+  batch_parallelism_label.set_halign(Gtk::Align::ALIGN_END);
   logging_stderr_label.set_halign(Gtk::Align::ALIGN_END);
   default_folder_entry.set_hexpand(true);
+  batch_parallelism_spin_button.set_range(1, 16);
+  batch_parallelism_spin_button.set_increments(1, 4);
+  batch_parallelism_spin_button.set_halign(Gtk::Align::ALIGN_START);
+  batch_parallelism_spin_button.set_tooltip_text("Maximum number of selected machines updated, rebooted or installed at the same time");
 
   settings_grid.attach(default_folder_label, 0, 0);
   settings_grid.attach(default_folder_entry, 1, 0);
@@ -73,6 +79,8 @@ PreferencesWindow::PreferencesWindow(Gtk::Window& parent)
   settings_grid.attach(*Gtk::manage(new Gtk::Separator(Gtk::ORIENTATION_HORIZONTAL)), 0, 1, 3);
   settings_grid.attach(display_default_wine_machine_label, 0, 2);
   settings_grid.attach(display_default_wine_machine_check, 1, 2, 2);
+  settings_grid.attach(batch_parallelism_label, 0, 3);
+  settings_grid.attach(batch_parallelism_spin_button, 1, 3, 2);
   settings_grid.attach(*Gtk::manage(new Gtk::Separator(Gtk::ORIENTATION_HORIZONTAL)), 0, 4, 3);
   settings_grid.attach(logging_label_heading, 0, 5, 3);
   settings_grid.attach(logging_stderr_label, 0, 6);
@@ -110,6 +118,7 @@ void PreferencesWindow::show()
   default_folder_entry.set_text(general_config.default_folder);
   display_default_wine_machine_check.set_active(general_config.display_default_wine_machine);
   enable_logging_stderr_check.set_active(general_config.enable_logging_stderr);
+  batch_parallelism_spin_button.set_value(general_config.batch_parallelism);
   // Call parent show
   Gtk::Widget::show();
 }
@@ -170,10 +179,12 @@ void PreferencesWindow::on_cancel_button_clicked()
 void PreferencesWindow::on_save_button_clicked()
 {
   // Save preferences to disk
-  GeneralConfigData general_config;
+  // Keep the settings that are not part of this window (like the runner directories)
+  GeneralConfigData general_config = GeneralConfigFile::read_config_file();
   general_config.default_folder = default_folder_entry.get_text();
   general_config.display_default_wine_machine = display_default_wine_machine_check.get_active();
   general_config.enable_logging_stderr = enable_logging_stderr_check.get_active();
+  general_config.batch_parallelism = batch_parallelism_spin_button.get_value_as_int();
   if (!GeneralConfigFile::write_config_file(general_config))
   {
     Gtk::MessageDialog dialog(*this, "Error occurred during saving generic config file.", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_OK);
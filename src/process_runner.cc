@@ -0,0 +1,292 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    process_runner.cc
+ * \brief   Run external programs without a shell (posix_spawn)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "process_runner.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <optional>
+#include <poll.h>
+#include <spawn.h>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+static const std::size_t ReadBufferSize = 64 * 1024; /*!< Read the program output in large chunks */
+
+/**
+ * \brief Run a program and wait until it is finished. Returns both the exit code as well as the output.
+ * The program is searched in PATH (like a shell would do), but no shell is involved: each argument is passed as-is.
+ * \param[in] argv Program followed by its arguments
+ * \param[in] env_vars Environment variables to set/override, on top of the current environment
+ * \param[in] working_directory Working directory of the program (empty is the current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout), otherwise stderr is inherited
+ * \param[in] stop_token Stop waiting for the program when a stop is requested (see stream())
+ * \example const auto& [exit_code, output] = ProcessRunner::run({"wine", "--version"});
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code (127 if the program could not be started, 128 + signal number when killed) and the output as a pair
+ */
+std::pair<int, std::string> ProcessRunner::run(const std::vector<std::string>& argv,
+                                               const std::vector<std::pair<std::string, std::string>>& env_vars,
+                                               const std::string& working_directory,
+                                               bool stderr_output,
+                                               std::stop_token stop_token)
+{
+  std::string output;
+  int exit_code = stream(
+      argv, [&output](std::string_view chunk) { output.append(chunk); }, env_vars, working_directory, stderr_output, std::move(stop_token));
+  return std::make_pair(exit_code, output);
+}
+
+/**
+ * \brief Run a program and wait until it is finished, the output is passed chunk by chunk to the output callback (while the program runs).
+ * Nothing is buffered, so the memory usage doesn't depend on the amount of output.
+ * \param[in] argv Program followed by its arguments
+ * \param[in] on_output Called (in the calling thread) for each chunk of output, may be empty to discard the output
+ * \param[in] env_vars Environment variables to set/override, on top of the current environment
+ * \param[in] working_directory Working directory of the program (empty is the current working directory)
+ * \param[in] stderr_output Also capture stderr (together with stdout), otherwise stderr is inherited
+ * \param[in] stop_token When a stop is requested, the output is no longer read and the program is no longer waited for.
+ * The program itself is not killed: it keeps running (like a program started from a terminal that got closed).
+ * \throws runtime_error when the output pipe could not be created
+ * \return Exit code (127 if the program could not be started, 128 + signal number when killed, -1 when stopped)
+ */
+int ProcessRunner::stream(const std::vector<std::string>& argv,
+                          const std::function<void(std::string_view)>& on_output,
+                          const std::vector<std::pair<std::string, std::string>>& env_vars,
+                          const std::string& working_directory,
+                          bool stderr_output,
+                          std::stop_token stop_token)
+{
+  if (argv.empty())
+  {
+    throw std::runtime_error("No program given to run!");
+  }
+
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC) != 0)
+  {
+    throw std::runtime_error("Could not create output pipe: " + std::string(std::strerror(errno)));
+  }
+
+  pid_t pid = 0;
+  int spawn_error = start_process(argv, env_vars, working_directory, pipe_fds[1], stderr_output, pid);
+  close(pipe_fds[1]);
+  if (spawn_error != 0)
+  {
+    close(pipe_fds[0]);
+    // Same exit code as a shell would return
+    if (on_output)
+      on_output(argv.at(0) + ": " + std::strerror(spawn_error) + "\n");
+    return 127;
+  }
+
+  // Wake up the poll() below when a stop is requested (from another thread)
+  int wake_fds[2] = {-1, -1};
+  std::optional<std::stop_callback<std::function<void()>>> stop_callback;
+  if (stop_token.stop_possible() && pipe2(wake_fds, O_CLOEXEC | O_NONBLOCK) == 0)
+  {
+    stop_callback.emplace(stop_token, [&wake_fds]() { [[maybe_unused]] ssize_t written = write(wake_fds[1], "x", 1); });
+  }
+
+  bool is_stopped = false;
+  std::vector<char> buffer(ReadBufferSize);
+  while (true)
+  {
+    if (wake_fds[0] >= 0)
+    {
+      struct pollfd poll_fds[2] = {{pipe_fds[0], POLLIN, 0}, {wake_fds[0], POLLIN, 0}};
+      if (poll(poll_fds, 2, -1) < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        break;
+      }
+      if (poll_fds[1].revents != 0)
+      {
+        is_stopped = true;
+        break;
+      }
+    }
+    ssize_t bytes_read = read(pipe_fds[0], buffer.data(), buffer.size());
+    if (bytes_read > 0)
+    {
+      if (on_output)
+        on_output(std::string_view(buffer.data(), static_cast<std::size_t>(bytes_read)));
+    }
+    else if (bytes_read == 0 || errno != EINTR)
+    {
+      break;
+    }
+  }
+  // Unregister the callback first, it uses the wake pipe
+  stop_callback.reset();
+  if (wake_fds[0] >= 0)
+  {
+    close(wake_fds[0]);
+    close(wake_fds[1]);
+  }
+  close(pipe_fds[0]);
+
+  int status = 0;
+  if (is_stopped)
+  {
+    // Only reap the program if it is already finished, don't wait for it
+    return (waitpid(pid, &status, WNOHANG) == pid) ? (WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status)) : -1;
+  }
+  while (waitpid(pid, &status, 0) < 0)
+  {
+    if (errno != EINTR)
+      return -1;
+  }
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+/**
+ * \brief Start a program without waiting for it, for long running programs (like the Windows programs of the user).
+ * The caller is responsible for reaping the process (eg. using Glib::signal_child_watch()).
+ * \param[in] argv Program followed by its arguments
+ * \param[in] env_vars Environment variables to set/override, on top of the current environment
+ * \param[in] working_directory Working directory of the program (empty is the current working directory)
+ * \param[in] output_path File to append the output to (empty to discard the output)
+ * \param[in] stderr_output Also redirect stderr (together with stdout), otherwise stderr is inherited
+ * \throws runtime_error when the output file could not be opened or the program could not be started
+ * \return Process ID of the program
+ */
+pid_t ProcessRunner::spawn(const std::vector<std::string>& argv,
+                           const std::vector<std::pair<std::string, std::string>>& env_vars,
+                           const std::string& working_directory,
+                           const std::string& output_path,
+                           bool stderr_output)
+{
+  if (argv.empty())
+  {
+    throw std::runtime_error("No program given to run!");
+  }
+
+  std::string file_path = output_path.empty() ? "/dev/null" : output_path;
+  int output_fd = open(file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (output_fd < 0)
+  {
+    throw std::runtime_error("Could not open " + file_path + " for writing: " + std::string(std::strerror(errno)));
+  }
+  pid_t pid = 0;
+  int spawn_error = start_process(argv, env_vars, working_directory, output_fd, stderr_output, pid);
+  close(output_fd);
+  if (spawn_error != 0)
+  {
+    throw std::runtime_error("Could not start " + argv.at(0) + ": " + std::string(std::strerror(spawn_error)));
+  }
+  return pid;
+}
+
+/**
+ * \brief Spawn the program with its output redirected to the given file descriptor, without waiting for it
+ * \param[in] argv Program followed by its arguments (not empty)
+ * \param[in] env_vars Environment variables to set/override, on top of the current environment
+ * \param[in] working_directory Working directory of the program (empty is the current working directory)
+ * \param[in] output_fd File descriptor used as stdout (and stderr)
+ * \param[in] stderr_output Also redirect stderr, otherwise stderr is inherited
+ * \param[out] pid Process ID of the started program
+ * \return 0 on success, otherwise the error number of posix_spawnp()
+ */
+int ProcessRunner::start_process(const std::vector<std::string>& argv,
+                                 const std::vector<std::pair<std::string, std::string>>& env_vars,
+                                 const std::string& working_directory,
+                                 int output_fd,
+                                 bool stderr_output,
+                                 pid_t& pid)
+{
+  std::vector<char*> c_argv;
+  c_argv.reserve(argv.size() + 1);
+  for (const std::string& arg : argv)
+  {
+    c_argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  c_argv.push_back(nullptr);
+  std::vector<std::string> environment = build_environment(env_vars);
+  std::vector<char*> c_env;
+  c_env.reserve(environment.size() + 1);
+  for (const std::string& env : environment)
+  {
+    c_env.push_back(const_cast<char*>(env.c_str()));
+  }
+  c_env.push_back(nullptr);
+
+  posix_spawn_file_actions_t file_actions;
+  posix_spawn_file_actions_init(&file_actions);
+  // The duplicated descriptors are not close-on-exec, the original descriptors are
+  posix_spawn_file_actions_adddup2(&file_actions, output_fd, STDOUT_FILENO);
+  if (stderr_output)
+    posix_spawn_file_actions_adddup2(&file_actions, output_fd, STDERR_FILENO);
+  if (!working_directory.empty())
+    posix_spawn_file_actions_addchdir_np(&file_actions, working_directory.c_str());
+
+  // Don't let the child inherit a blocked signal mask (of the calling thread) or an ignored SIGPIPE
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  sigset_t signal_mask;
+  sigemptyset(&signal_mask);
+  posix_spawnattr_setsigmask(&attr, &signal_mask);
+  sigset_t default_signals;
+  sigemptyset(&default_signals);
+  sigaddset(&default_signals, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attr, &default_signals);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+  int spawn_error = posix_spawnp(&pid, c_argv[0], &file_actions, &attr, c_argv.data(), c_env.data());
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&file_actions);
+  return spawn_error;
+}
+
+/**
+ * \brief Build the environment of the child process: the current environment with the given variables set/overridden
+ * \param[in] env_vars Environment variables to set/override
+ * \return List of "NAME=value" strings
+ */
+std::vector<std::string> ProcessRunner::build_environment(const std::vector<std::pair<std::string, std::string>>& env_vars)
+{
+  std::vector<std::string> environment;
+  for (char** env = environ; env != nullptr && *env != nullptr; env++)
+  {
+    std::string entry(*env);
+    std::string name = entry.substr(0, entry.find('='));
+    bool is_overridden = false;
+    for (const auto& [key, value] : env_vars)
+    {
+      if (key == name)
+      {
+        is_overridden = true;
+        break;
+      }
+    }
+    if (!is_overridden)
+      environment.push_back(std::move(entry));
+  }
+  for (const auto& [key, value] : env_vars)
+  {
+    environment.push_back(key + "=" + value);
+  }
+  return environment;
+}
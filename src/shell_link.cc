@@ -0,0 +1,336 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    shell_link.cc
+ * \brief   Parser for Windows shortcut files (.lnk, MS-SHLLINK format)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "shell_link.h"
+#include <stdexcept>
+
+// See the [MS-SHLLINK] specification for all the structures below
+static const std::uint32_t HeaderSize = 0x4C;
+static const std::string_view LinkClsid("\x01\x14\x02\x00\x00\x00\x00\x00\xC0\x00\x00\x00\x00\x00\x00\x46", 16);
+static const std::uint32_t HasLinkTargetIdList = 0x01;
+static const std::uint32_t HasLinkInfo = 0x02;
+static const std::uint32_t HasName = 0x04;
+static const std::uint32_t HasRelativePath = 0x08;
+static const std::uint32_t HasWorkingDir = 0x10;
+static const std::uint32_t HasArguments = 0x20;
+static const std::uint32_t HasIconLocation = 0x40;
+static const std::uint32_t IsUnicode = 0x80;
+static const std::uint32_t ForceNoLinkInfo = 0x100;
+static const std::uint32_t VolumeIdAndLocalBasePath = 0x01;
+static const std::uint32_t CommonNetworkRelativeLinkAndPathSuffix = 0x02;
+static const std::uint32_t FileEntryExtensionSignature = 0xBEEF0004;
+
+/**
+ * \brief Get the string until the first NUL character (or until the end of the data)
+ * \param[in] data Data
+ * \param[in] offset Start of the string
+ * \return String view into the data
+ */
+static std::string_view get_c_string(std::string_view data, std::size_t offset)
+{
+  if (offset >= data.size())
+    return {};
+  std::string_view str = data.substr(offset);
+  return str.substr(0, str.find('\0'));
+}
+
+/**
+ * \brief Get the UTF-16 string until the first NUL character (or until the end of the data)
+ * \param[in] data Data
+ * \param[in] offset Start of the string
+ * \return String view into the data (UTF-16LE encoded, without the terminating NUL character)
+ */
+static std::string_view get_utf16_c_string(std::string_view data, std::size_t offset)
+{
+  std::size_t end = offset;
+  while (end + 1 < data.size() && (data[end] != '\0' || data[end + 1] != '\0'))
+    end += 2;
+  return (end > offset && end <= data.size()) ? data.substr(offset, end - offset) : std::string_view();
+}
+
+/**
+ * \brief Parse the Windows shortcut file data
+ * \param[in] data Content of the .lnk file
+ * \throws std::runtime_error when the data is not a valid shortcut file
+ * \return Shortcut data
+ */
+ShellLinkData ShellLink::parse(std::string_view data)
+{
+  if (data.size() < HeaderSize || read_u32(data, 0) != HeaderSize || data.substr(4, LinkClsid.size()) != LinkClsid)
+  {
+    throw std::runtime_error("Not a Windows shortcut file (invalid shell link header)");
+  }
+  ShellLinkData link;
+  std::uint32_t flags = read_u32(data, 0x14);
+  link.icon_index = static_cast<std::int32_t>(read_u32(data, 0x38));
+  bool is_unicode = (flags & IsUnicode) != 0;
+
+  std::size_t offset = HeaderSize;
+  std::string id_list_path;
+  if (flags & HasLinkTargetIdList)
+  {
+    std::uint16_t id_list_size = read_u16(data, offset);
+    offset += 2;
+    if (offset + id_list_size > data.size())
+      throw std::runtime_error("Invalid shortcut file (LinkTargetIDList exceeds the file)");
+    id_list_path = get_id_list_path(data.substr(offset, id_list_size));
+    offset += id_list_size;
+  }
+  if (flags & HasLinkInfo)
+  {
+    std::uint32_t link_info_size = read_u32(data, offset);
+    if (link_info_size < 4 || offset + link_info_size > data.size())
+      throw std::runtime_error("Invalid shortcut file (LinkInfo exceeds the file)");
+    if (!(flags & ForceNoLinkInfo))
+      link.target_path = get_link_info_path(data.substr(offset, link_info_size));
+    offset += link_info_size;
+  }
+  // The LinkInfo path is always the full path, the item ID list could hold short (8.3) names
+  if (link.target_path.empty())
+    link.target_path = std::move(id_list_path);
+
+  // StringData structures, in this order
+  if (flags & HasName)
+    read_string_data(data, offset, is_unicode);
+  if (flags & HasRelativePath)
+    read_string_data(data, offset, is_unicode);
+  if (flags & HasWorkingDir)
+    link.working_directory = read_string_data(data, offset, is_unicode);
+  if (flags & HasArguments)
+    link.arguments = read_string_data(data, offset, is_unicode);
+  if (flags & HasIconLocation)
+    link.icon_location = read_string_data(data, offset, is_unicode);
+  return link;
+}
+
+/**
+ * \brief Get the file system path from the LinkTargetIDList, by joining the drive and file entry items
+ * \param[in] id_list Item ID list (without the size field)
+ * \return Windows path, empty when the items don't represent a file system path (eg. a network location or a control panel item)
+ */
+std::string ShellLink::get_id_list_path(std::string_view id_list)
+{
+  std::string path;
+  std::size_t offset = 0;
+  while (offset + 2 <= id_list.size())
+  {
+    std::uint16_t item_size = read_u16(id_list, offset);
+    if (item_size == 0) // Terminal ID
+      break;
+    if (item_size < 3 || offset + item_size > id_list.size())
+      return {};
+    std::string_view item = id_list.substr(offset, item_size);
+    offset += item_size;
+
+    std::uint8_t type = static_cast<std::uint8_t>(item[2]);
+    if (type == 0x1F) // Root folder (like My Computer)
+      continue;
+    switch (type & 0x70)
+    {
+    case 0x20: // Volume item, holds the drive (eg. "D:\")
+      path = get_c_string(item, 3);
+      break;
+    case 0x30: // File entry item: 2 bytes size + type + unknown + file size (4) + date/time (4) + attributes (2), then the name
+    {
+      if (path.empty() || item.size() < 14)
+        return {};
+      // The file entry extension block (if present) holds the long Unicode name, the offset is stored in the last 2 bytes
+      std::string_view long_name;
+      std::uint16_t extension_offset = read_u16(item, item.size() - 2);
+      if (extension_offset >= 14 && extension_offset + 20u <= item.size() - 2 && read_u32(item, extension_offset + 4) == FileEntryExtensionSignature)
+      {
+        std::uint16_t version = read_u16(item, extension_offset + 2);
+        std::size_t name_offset = extension_offset + 18;
+        if (version >= 7)
+          name_offset += 18; // Unknown + NTFS file reference + unknown
+        if (version >= 3)
+          name_offset += 2; // Long string size
+        if (version >= 9)
+          name_offset += 4;
+        if (version >= 8)
+          name_offset += 4;
+        if (version >= 3)
+          long_name = get_utf16_c_string(item.substr(0, item.size() - 2), name_offset);
+      }
+      if (!long_name.empty())
+        append_path(path, long_name, true);
+      else if (type & 0x04) // Unicode primary name
+        append_path(path, get_utf16_c_string(item, 14), true);
+      else
+        append_path(path, get_c_string(item, 14), false);
+      break;
+    }
+    default: // No file system location
+      return {};
+    }
+  }
+  return path;
+}
+
+/**
+ * \brief Get the target path from the LinkInfo structure (local base path or network share, followed by the common path suffix)
+ * \param[in] link_info LinkInfo structure
+ * \return Windows path, empty when not present
+ */
+std::string ShellLink::get_link_info_path(std::string_view link_info)
+{
+  std::uint32_t header_size = read_u32(link_info, 4);
+  std::uint32_t link_info_flags = read_u32(link_info, 8);
+  std::string path;
+  bool is_unicode = header_size >= 0x24;
+  if (link_info_flags & VolumeIdAndLocalBasePath)
+  {
+    std::uint32_t local_base_path_offset = is_unicode ? read_u32(link_info, 28) : 0;
+    if (local_base_path_offset != 0)
+      append_utf16(path, get_utf16_c_string(link_info, local_base_path_offset));
+    else
+      path = get_c_string(link_info, read_u32(link_info, 16));
+  }
+  else if (link_info_flags & CommonNetworkRelativeLinkAndPathSuffix)
+  {
+    // The network share name (eg. \\server\share) is part of the CommonNetworkRelativeLink structure
+    std::uint32_t network_link_offset = read_u32(link_info, 20);
+    std::uint32_t net_name_offset = read_u32(link_info, network_link_offset + 8);
+    path = get_c_string(link_info, network_link_offset + net_name_offset);
+  }
+  if (path.empty())
+    return path;
+  std::uint32_t suffix_offset = is_unicode ? read_u32(link_info, 32) : 0;
+  if (suffix_offset != 0)
+    append_path(path, get_utf16_c_string(link_info, suffix_offset), true);
+  else
+    append_path(path, get_c_string(link_info, read_u32(link_info, 24)), false);
+  return path;
+}
+
+/**
+ * \brief Append a path component, separated by a backslash
+ * \param[in,out] path Windows path
+ * \param[in] component Path component to add
+ * \param[in] is_utf16 Component is UTF-16LE encoded (converted to UTF-8), otherwise it's added as-is
+ */
+void ShellLink::append_path(std::string& path, std::string_view component, bool is_utf16)
+{
+  if (component.empty())
+    return;
+  if (!path.empty() && path.back() != '\\')
+    path += '\\';
+  if (is_utf16)
+    append_utf16(path, component);
+  else
+    path.append(component);
+}
+
+/**
+ * \brief Read a StringData structure (character count followed by the characters, not NUL-terminated)
+ * \param[in] data Shortcut file data
+ * \param[in,out] offset Offset of the structure, moved to the next structure
+ * \param[in] is_unicode The characters are UTF-16, otherwise single bytes (system code page)
+ * \throws std::runtime_error when the string exceeds the data
+ * \return String (UTF-16 is converted to UTF-8)
+ */
+std::string ShellLink::read_string_data(std::string_view data, std::size_t& offset, bool is_unicode)
+{
+  std::size_t count = read_u16(data, offset);
+  std::size_t size = is_unicode ? count * 2 : count;
+  offset += 2;
+  if (offset + size > data.size())
+    throw std::runtime_error("Invalid shortcut file (StringData exceeds the file)");
+  std::string_view chars = data.substr(offset, size);
+  offset += size;
+  std::string str;
+  if (is_unicode)
+    append_utf16(str, chars);
+  else
+    str.assign(chars);
+  return str;
+}
+
+/**
+ * \brief Convert UTF-16LE data to UTF-8 and append it to the output
+ * \param[in,out] output Output string
+ * \param[in] data UTF-16LE encoded data
+ */
+void ShellLink::append_utf16(std::string& output, std::string_view data)
+{
+  for (std::size_t i = 0; i + 1 < data.size(); i += 2)
+  {
+    std::uint32_t code_point = read_u16(data, i);
+    if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 3 < data.size())
+    {
+      std::uint32_t low = read_u16(data, i + 2);
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        i += 2;
+      }
+    }
+    if (code_point >= 0xD800 && code_point <= 0xDFFF)
+      code_point = 0xFFFD; // Unpaired surrogate
+    if (code_point < 0x80)
+    {
+      output += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+      output += static_cast<char>(0xC0 | (code_point >> 6));
+      output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+      output += static_cast<char>(0xE0 | (code_point >> 12));
+      output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+      output += static_cast<char>(0xF0 | (code_point >> 18));
+      output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      output += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+  }
+}
+
+/**
+ * \brief Read a little-endian 16-bit value
+ * \param[in] data Data
+ * \param[in] offset Offset of the value
+ * \throws std::runtime_error when the value exceeds the data
+ * \return Value
+ */
+std::uint16_t ShellLink::read_u16(std::string_view data, std::size_t offset)
+{
+  if (offset + 2 > data.size())
+    throw std::runtime_error("Invalid shortcut file (unexpected end of data)");
+  return static_cast<std::uint16_t>(static_cast<std::uint8_t>(data[offset]) | (static_cast<std::uint8_t>(data[offset + 1]) << 8));
+}
+
+/**
+ * \brief Read a little-endian 32-bit value
+ * \param[in] data Data
+ * \param[in] offset Offset of the value
+ * \throws std::runtime_error when the value exceeds the data
+ * \return Value
+ */
+std::uint32_t ShellLink::read_u32(std::string_view data, std::size_t offset)
+{
+  return static_cast<std::uint32_t>(read_u16(data, offset)) | (static_cast<std::uint32_t>(read_u16(data, offset + 2)) << 16);
+}
@@ -57,7 +57,8 @@ SignalController::SignalController(BottleManager& manager,
       configure_env_var_window_(configure_env_var_window),
       configure_window_(configure_window),
       add_app_window_(add_app_window),
-      remove_app_window_(remove_app_window)
+      remove_app_window_(remove_app_window),
+      clone_progress_(0.0)
 {
   // Nothing
 }
@@ -67,6 +68,8 @@ SignalController::SignalController(BottleManager& manager,
  */
 SignalController::~SignalController()
 {
+  // Stop a running clone, to avoid waiting for the whole copy
+  clone_stop_source_.request_stop();
   // To avoid zombie threads
   this->cleanup_bottle_manager_thread();
 }
@@ -95,6 +98,7 @@ void SignalController::dispatch_signals()
   menu_.preferences.connect(sigc::mem_fun(preferences_window_, &PreferencesWindow::show));
   menu_.quit.connect(
       sigc::mem_fun(*main_window_, &MainWindow::on_hide_window)); /*!< When quit button is pressed, hide main window and therefore closes the app */
+  menu_.deduplicate.connect(sigc::mem_fun(manager_, &BottleManager::deduplicate_bottles));
   menu_.refresh_view.connect(sigc::bind(sigc::mem_fun(manager_, &BottleManager::update_config_and_bottles), "", false));
   menu_.new_bottle.connect(sigc::mem_fun(*main_window_, &MainWindow::on_new_bottle_button_clicked));
   menu_.run.connect(sigc::mem_fun(*main_window_, &MainWindow::on_run_button_clicked));
@@ -118,6 +122,7 @@ void SignalController::dispatch_signals()
   main_window_->active_bottle.connect(sigc::mem_fun(configure_window_, &BottleConfigureWindow::set_active_bottle));
   main_window_->active_bottle.connect(sigc::mem_fun(add_app_window_, &AddAppWindow::set_active_bottle));
   main_window_->active_bottle.connect(sigc::mem_fun(remove_app_window_, &RemoveAppWindow::set_active_bottle));
+  main_window_->selected_bottles.connect(sigc::mem_fun(manager_, &BottleManager::set_selected_bottles));
   // Distribute the reset bottle signal from the manager
   manager_.reset_active_bottle.connect(sigc::mem_fun(edit_window_, &BottleEditWindow::reset_active_bottle));
   manager_.reset_active_bottle.connect(sigc::mem_fun(clone_window_, &BottleCloneWindow::reset_active_bottle));
@@ -146,6 +151,7 @@ void SignalController::dispatch_signals()
   main_window_->update_bottle.connect(sigc::mem_fun(manager_, &BottleManager::update));
   main_window_->open_log_file.connect(sigc::mem_fun(manager_, &BottleManager::open_log_file));
   main_window_->kill_running_processes.connect(sigc::mem_fun(manager_, &BottleManager::kill_processes));
+  main_window_->cancel_busy_task.connect(sigc::mem_fun(manager_, &BottleManager::cancel_batch));
   // App list
   main_window_->show_add_app_window.connect(sigc::mem_fun(add_app_window_, &AddAppWindow::show));
   main_window_->show_remove_app_window.connect(sigc::mem_fun(remove_app_window_, &RemoveAppWindow::show));
@@ -157,6 +163,7 @@ void SignalController::dispatch_signals()
 
   // Clone Window
   clone_window_.clone_bottle.connect(sigc::mem_fun(this, &SignalController::on_clone_bottle));
+  clone_window_.cancel_clone.connect(sigc::mem_fun(this, &SignalController::on_cancel_clone));
 
   // Right click menu in listbox
   main_window_->right_click_menu.connect(sigc::mem_fun(this, &SignalController::on_mouse_button_pressed));
@@ -165,9 +172,11 @@ void SignalController::dispatch_signals()
   bottle_created_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_new_bottle_created));
   bottle_updated_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_bottle_updated));
   bottle_cloned_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_bottle_cloned));
+  clone_cancelled_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_clone_cancelled));
   error_message_created_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_error_message_created));
   error_message_updated_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_error_message_updated));
   error_message_cloned_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_error_message_cloned));
+  clone_progress_dispatcher_.connect(sigc::mem_fun(this, &SignalController::on_clone_progress));
 
   // When the WineExec() results into a non-zero exit code the failure_on_exec it triggered
   Helper& helper = Helper::get_instance();
@@ -185,13 +194,13 @@ void SignalController::dispatch_signals()
   configure_window_.visual_cpp_package.connect(sigc::mem_fun(manager_, &BottleManager::install_visual_cpp_package));
 
   // Add new application Window
-  add_app_window_.config_saved.connect(sigc::bind(sigc::mem_fun(manager_, &BottleManager::update_config_and_bottles), "", false));
+  add_app_window_.config_saved.connect(sigc::mem_fun(manager_, &BottleManager::refresh_active_bottle));
 
   // Configure environment variables Window
-  configure_env_var_window_.config_saved.connect(sigc::bind(sigc::mem_fun(manager_, &BottleManager::update_config_and_bottles), "", false));
+  configure_env_var_window_.config_saved.connect(sigc::mem_fun(manager_, &BottleManager::refresh_active_bottle));
 
   // Remove application Window
-  remove_app_window_.config_saved.connect(sigc::bind(sigc::mem_fun(manager_, &BottleManager::update_config_and_bottles), "", false));
+  remove_app_window_.config_saved.connect(sigc::mem_fun(manager_, &BottleManager::refresh_active_bottle));
 
   // WineGUI Preference Window
   preferences_window_.config_saved.connect(sigc::bind(sigc::mem_fun(manager_, &BottleManager::update_config_and_bottles), "", false));
@@ -227,6 +236,27 @@ void SignalController::signal_bottle_cloned()
   bottle_cloned_dispatcher_.emit();
 }
 
+/**
+ * \brief Signal bottle clone is cancelled by the user (the partial copy is already removed), called from the thread.
+ */
+void SignalController::signal_clone_cancelled()
+{
+  clone_cancelled_dispatcher_.emit();
+}
+
+/**
+ * \brief Signal the clone progress, called from the thread.
+ * \param[in] fraction Progress of the bottle copy (0.0 - 1.0)
+ */
+void SignalController::signal_clone_progress(double fraction)
+{
+  {
+    std::lock_guard<std::mutex> lock(clone_progress_mutex_);
+    clone_progress_ = fraction;
+  }
+  clone_progress_dispatcher_.emit();
+}
+
 /**
  * \brief Signal error message during bottle creation,
  * called from the thread.
@@ -352,13 +382,25 @@ void SignalController::on_clone_bottle(const CloneBottleStruct& clone_bottle_str
   }
   else
   {
-    // Start a new manager thread
+    // Start a new manager thread, which can be cancelled from the clone window
+    clone_stop_source_ = std::stop_source();
     thread_bottle_manager_ = std::make_unique<std::thread>(
-        [this, clone_bottle_struct]
-        { manager_.clone_bottle(this, clone_bottle_struct.name, clone_bottle_struct.folder_name, clone_bottle_struct.description); });
+        [this, clone_bottle_struct, stop_token = clone_stop_source_.get_token()]
+        {
+          manager_.clone_bottle(this, clone_bottle_struct.name, clone_bottle_struct.folder_name, clone_bottle_struct.description,
+                                clone_bottle_struct.is_overlay, stop_token);
+        });
   }
 }
 
+/**
+ * \brief Cancel the running bottle clone (the manager thread signals back when the partial copy is removed)
+ */
+void SignalController::on_cancel_clone()
+{
+  clone_stop_source_.request_stop();
+}
+
 /******************************************
  * Dispatch events from dispatcher itself *
  * (indirectly from other classes)        *
@@ -403,6 +445,30 @@ void SignalController::on_bottle_cloned()
   manager_.update_config_and_bottles(new_cloned_bottle_name, false);
 }
 
+/**
+ * \brief Signal handler when the bottle clone is cancelled by the user, dispatched from the manager thread
+ */
+void SignalController::on_clone_cancelled()
+{
+  this->cleanup_bottle_manager_thread();
+
+  // No error message, the user requested the cancel
+  clone_window_.on_clone_cancelled();
+}
+
+/**
+ * \brief Signal handler when the clone progress is changed, dispatched from the manager thread
+ */
+void SignalController::on_clone_progress()
+{
+  double fraction;
+  {
+    std::lock_guard<std::mutex> lock(clone_progress_mutex_);
+    fraction = clone_progress_;
+  }
+  clone_window_.set_clone_progress(fraction);
+}
+
 /**
  * \brief Fetch the error message from the manager during bottle creation (in a thread-safe manner),
  * and report it to the main window (runs on the GUI thread).
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    task_executor.cc
+ * \brief   Bounded pool of worker threads to run background tasks
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "task_executor.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+/**
+ * \brief Create the executor, no worker threads are started until tasks are submitted
+ * \param[in] max_workers Maximum number of worker threads (tasks are queued when all workers are busy)
+ */
+TaskExecutor::TaskExecutor(unsigned int max_workers) : max_workers_(std::max(max_workers, 1U)), idle_workers_(0), is_shutdown_(false)
+{
+}
+
+/**
+ * \brief Cancel all tasks and join the worker threads
+ */
+TaskExecutor::~TaskExecutor()
+{
+  shutdown();
+}
+
+/**
+ * \brief Queue a task to be run by a worker thread
+ * \param[in] work Work to run, the stop token is triggered when the executor shuts down
+ * \throws std::runtime_error when the executor is already shut down
+ */
+void TaskExecutor::submit(std::function<void(std::stop_token)> work)
+{
+  auto task = std::make_shared<Task>();
+  task->work = std::move(work);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_shutdown_)
+    {
+      std::cerr << "Error: Task submitted after the task executor is shut down" << std::endl;
+      throw std::runtime_error("Task executor is already shut down.");
+    }
+    queue_.push_back(task);
+    // Only start an additional worker when all existing workers are busy
+    if (idle_workers_ < queue_.size() && workers_.size() < max_workers_)
+    {
+      workers_.emplace_back(&TaskExecutor::worker_loop, this);
+    }
+  }
+  queue_condition_.notify_one();
+}
+
+/**
+ * \brief Cancel the queued and running tasks and join all worker threads.
+ * Running tasks are expected to return soon after their stop token is triggered.
+ */
+void TaskExecutor::shutdown()
+{
+  std::deque<std::shared_ptr<Task>> skipped_tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_shutdown_)
+      return;
+    is_shutdown_ = true;
+    // The queued tasks are not started anymore, they are released after unlocking
+    skipped_tasks.swap(queue_);
+    for (const auto& task : running_tasks_)
+    {
+      task->stop_source.request_stop();
+    }
+  }
+  queue_condition_.notify_all();
+  for (std::thread& worker : workers_)
+  {
+    if (worker.joinable())
+      worker.join();
+  }
+}
+
+/**
+ * \brief Check if all the workers are busy, the next submitted task has to wait in the queue
+ * \return true if a new task is queued, otherwise false
+ */
+bool TaskExecutor::is_busy()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_workers_ <= queue_.size() && workers_.size() >= max_workers_;
+}
+
+/**
+ * \brief Worker thread, runs tasks from the queue until the executor shuts down
+ */
+void TaskExecutor::worker_loop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true)
+  {
+    ++idle_workers_;
+    queue_condition_.wait(lock, [this] { return is_shutdown_ || !queue_.empty(); });
+    --idle_workers_;
+    if (is_shutdown_)
+      break;
+    std::shared_ptr<Task> task = queue_.front();
+    queue_.pop_front();
+    running_tasks_.push_back(task);
+    lock.unlock();
+    try
+    {
+      task->work(task->stop_source.get_token());
+    }
+    catch (const std::exception& error)
+    {
+      std::cerr << "Error: Task failed: " << error.what() << std::endl;
+    }
+    // Release the captured data of the work function outside the lock
+    task->work = nullptr;
+    lock.lock();
+    running_tasks_.erase(std::find(running_tasks_.begin(), running_tasks_.end(), task));
+  }
+}
@@ -0,0 +1,520 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_registry.cc
+ * \brief   Indexed read-only view of a Wine registry hive file (.reg)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wine_registry.h"
+#include <algorithm>
+#include <cctype>
+#include <fcntl.h>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  /**
+   * \struct CacheEntry
+   * \brief Parsed registry hive together with the file state it was parsed from
+   */
+  struct CacheEntry
+  {
+    std::string file_path;
+    struct timespec mtime;
+    off_t size;
+    std::shared_ptr<const WineRegistry> registry;
+  };
+
+  constexpr std::size_t MaxCacheEntries = 16; /*!< Maximum number of parsed hives kept in memory */
+  std::mutex cache_mutex;
+  std::list<CacheEntry> cache; /*!< Most recently used entry is in front */
+  const std::vector<WineRegistry::Value> NoValues;
+}
+
+/**
+ * \brief Memory-map the registry file from disk and index it.
+ * Wine server saves a hive by writing a new file and renaming it, so the mapping stays valid for the lifetime of this object.
+ * \param[in] file_path File path of the registry hive
+ * \throws runtime_error when the registry file could not be opened
+ */
+WineRegistry::WineRegistry(const std::string& file_path) : data_(nullptr), size_(0)
+{
+  int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0)
+  {
+    if (fd >= 0)
+      close(fd);
+    std::cerr << "Error: Couldn't open registry file: " << file_path << std::endl;
+    throw std::runtime_error("Could not open registry file!");
+  }
+  if (file_stat.st_size > 0)
+  {
+    void* mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+      close(fd);
+      std::cerr << "Error: Couldn't map registry file into memory: " << file_path << std::endl;
+      throw std::runtime_error("Could not open registry file!");
+    }
+    data_ = static_cast<const char*>(mapping);
+    size_ = file_stat.st_size;
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  parse();
+}
+
+WineRegistry::~WineRegistry()
+{
+  if (data_ != nullptr)
+    munmap(const_cast<char*>(data_), size_);
+}
+
+/**
+ * \brief Get the parsed registry hive, the hive is only parsed again when the file is changed on disk.
+ * The returned registry is immutable and can be shared between threads.
+ * \param[in] file_path File path of the registry hive
+ * \throws runtime_error when the registry file could not be opened
+ * \return Shared pointer to the parsed registry
+ */
+std::shared_ptr<const WineRegistry> WineRegistry::open(const std::string& file_path)
+{
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0)
+  {
+    std::cerr << "Error: Couldn't open registry file: " << file_path << std::endl;
+    throw std::runtime_error("Could not open registry file!");
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = std::find_if(cache.begin(), cache.end(), [&file_path](const CacheEntry& entry) { return entry.file_path == file_path; });
+    if (it != cache.end())
+    {
+      if (it->mtime.tv_sec == file_stat.st_mtim.tv_sec && it->mtime.tv_nsec == file_stat.st_mtim.tv_nsec && it->size == file_stat.st_size)
+      {
+        cache.splice(cache.begin(), cache, it);
+        return it->registry;
+      }
+      cache.erase(it);
+    }
+  }
+
+  // Parse outside the lock, so other hives can be retrieved in parallel
+  auto registry = std::make_shared<const WineRegistry>(file_path);
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache.push_front(CacheEntry{file_path, file_stat.st_mtim, file_stat.st_size, registry});
+  // Another thread could have parsed the same file in the meantime
+  auto duplicate = std::find_if(std::next(cache.begin()), cache.end(),
+                                [&file_path](const CacheEntry& entry) { return entry.file_path == file_path; });
+  if (duplicate != cache.end())
+    cache.erase(duplicate);
+  if (cache.size() > MaxCacheEntries)
+    cache.pop_back();
+  return registry;
+}
+
+/**
+ * \brief Strip the surrounding quotes of string value data and unescape it
+ * \param[in] data Raw value data (eg. "C:\\\\windows")
+ * \return UTF-8 string, non-string data (like dword:00000001) is returned as-is
+ */
+std::string WineRegistry::unquote(std::string_view data)
+{
+  if (data.size() >= 2 && data.front() == '"')
+  {
+    std::size_t end = data.rfind('"');
+    if (end > 0)
+      return unescape(data.substr(1, end - 1));
+  }
+  return std::string(data);
+}
+
+/**
+ * \brief Get a specific value from the registry, without copying or unescaping
+ * \param[in] key_name   Full or part of the path of the key, always starting with '[' (eg. [Software\\\\Wine\\\\Explorer])
+ * \param[in] value_name Specifies the (escaped) registry value name (eg. Desktop)
+ * \return Raw data of value name as slice of the hive (including quotes), or empty view if not found
+ */
+std::string_view WineRegistry::get_raw_value(std::string_view key_name, std::string_view value_name) const
+{
+  for (const auto& [name, data] : get_values(key_name))
+  {
+    if (name == value_name)
+      return data;
+  }
+  return {};
+}
+
+/**
+ * \brief Get a specific value from the registry
+ * \param[in] key_name   Full or part of the path of the key, always starting with '[' (eg. [Software\\\\Wine\\\\Explorer])
+ * \param[in] value_name Specifies the (escaped) registry value name (eg. Desktop)
+ * \return Unescaped data of value name (without quotes), or empty string if not found
+ */
+std::string WineRegistry::get_value(std::string_view key_name, std::string_view value_name) const
+{
+  return unquote(get_raw_value(key_name, value_name));
+}
+
+/**
+ * \brief Get multiple values from the registry at once. Full key names are looked up in the index,
+ * all the partial key names are resolved together in a single pass over the keys.
+ * \param[in] queries Key name (full or part of the path, starting with '[') + (escaped) value name pairs
+ * \return Unescaped data of each query in the same order (empty string if not found)
+ */
+std::vector<std::string> WineRegistry::get_values(const std::vector<ValueQuery>& queries) const
+{
+  std::vector<std::string> results(queries.size());
+  std::vector<const Key*> found_keys(queries.size(), nullptr);
+  std::size_t partial_count = 0;
+  for (std::size_t i = 0; i < queries.size(); i++)
+  {
+    if (queries[i].first.ends_with(']'))
+      found_keys[i] = find_key(queries[i].first);
+    else
+      partial_count++;
+  }
+  // Partial key names, the first key in file order that starts with the given name
+  for (auto it = key_order_.begin(); it != key_order_.end() && partial_count > 0; ++it)
+  {
+    for (std::size_t i = 0; i < queries.size(); i++)
+    {
+      if (found_keys[i] == nullptr && !queries[i].first.ends_with(']') && it->starts_with(queries[i].first))
+      {
+        found_keys[i] = &keys_.at(*it);
+        partial_count--;
+      }
+    }
+  }
+  for (std::size_t i = 0; i < queries.size(); i++)
+  {
+    if (found_keys[i] == nullptr)
+      continue;
+    for (const auto& [name, data] : found_keys[i]->values)
+    {
+      if (name == queries[i].second)
+      {
+        results[i] = unquote(data);
+        break;
+      }
+    }
+  }
+  return results;
+}
+
+/**
+ * \brief Get all the (still escaped) data lines of a specific key, meta data lines are excluded
+ * \param[in] key_name Full or part of the path of the key, always starting with '[' (eg. [Software\\\\Wine\\\\Explorer])
+ * \return Data lines of the key, or empty list if the key is not found
+ */
+std::vector<std::string_view> WineRegistry::get_key_lines(std::string_view key_name) const
+{
+  const Key* key = find_key(key_name);
+  if (key != nullptr)
+    return key->lines;
+  return {};
+}
+
+/**
+ * \brief Get the direct subkeys of a specific key (in file order)
+ * \param[in] key_name Full path of the key, including brackets (eg. [Software\\\\Wine])
+ * \return Full key names of the subkeys, including brackets (eg. [Software\\\\Wine\\\\Explorer])
+ */
+std::vector<std::string_view> WineRegistry::get_subkeys(std::string_view key_name) const
+{
+  std::vector<std::string_view> subkeys;
+  if (!key_name.ends_with(']'))
+    return subkeys;
+  // Subkeys start with the key name (without closing bracket) followed by an escaped backslash
+  std::string prefix = std::string(key_name.substr(0, key_name.size() - 1)) + "\\\\";
+  for (std::string_view name : key_order_)
+  {
+    if (name.size() > prefix.size() + 1 && name.starts_with(prefix) && name.ends_with(']') &&
+        name.substr(prefix.size()).find("\\\\") == std::string_view::npos)
+      subkeys.push_back(name);
+  }
+  return subkeys;
+}
+
+/**
+ * \brief Get all the values of a specific key
+ * \param[in] key_name Full or part of the path of the key, always starting with '[' (eg. [Software\\\\Wine\\\\Explorer])
+ * \return Raw value name + data pairs in file order, or empty list if the key is not found
+ */
+const std::vector<WineRegistry::Value>& WineRegistry::get_values(std::string_view key_name) const
+{
+  const Key* key = find_key(key_name);
+  if (key != nullptr)
+    return key->values;
+  return NoValues;
+}
+
+/**
+ * \brief Get a meta value from the header of the registry
+ * \param[in] meta_value_name Specifies the registry meta value name (eg. arch)
+ * \return Data of the meta value name, or empty string if not found
+ */
+std::string WineRegistry::get_meta_data(std::string_view meta_value_name) const
+{
+  std::string output;
+  auto it = meta_.find(meta_value_name);
+  if (it != meta_.end())
+  {
+    output = it->second;
+    // Remove quotes
+    output.erase(std::remove(output.begin(), output.end(), '\"'), output.end());
+  }
+  return output;
+}
+
+/**
+ * \brief Index all the keys and values of the mapped registry in a single pass
+ */
+void WineRegistry::parse()
+{
+  std::string_view content(data_ != nullptr ? data_ : "", size_);
+  Key* current_key = nullptr;
+  std::size_t start = 0;
+  while (start < content.size())
+  {
+    std::size_t end = content.find('\n', start);
+    if (end == std::string_view::npos)
+      end = content.size();
+    std::string_view line = content.substr(start, end - start);
+    start = end + 1;
+    if (line.ends_with('\r'))
+      line.remove_suffix(1);
+
+    if (line.starts_with('['))
+    {
+      // Key line, eg: [Software\\Wine\\Explorer] 1700000000
+      std::size_t key_end = line.rfind(']');
+      std::string_view key_name = (key_end != std::string_view::npos) ? line.substr(0, key_end + 1) : line;
+      auto [it, inserted] = keys_.try_emplace(key_name);
+      if (inserted)
+        key_order_.emplace_back(key_name);
+      current_key = &it->second;
+    }
+    else if (line.empty())
+    {
+      current_key = nullptr; // End of key section in registry
+    }
+    else if (line.starts_with('#'))
+    {
+      // Only the meta data in the header of the hive is global (eg. #arch=win64)
+      std::size_t pos = line.find('=');
+      if (current_key == nullptr && key_order_.empty() && pos != std::string_view::npos)
+        meta_.try_emplace(line.substr(1, pos - 1), line.substr(pos + 1));
+    }
+    else if (current_key != nullptr)
+    {
+      if (line.starts_with('"'))
+      {
+        // Find the closing quote of the value name, skipping escaped characters
+        std::size_t pos = 1;
+        while (pos < line.size() && line[pos] != '"')
+        {
+          if (line[pos] == '\\')
+            pos++;
+          pos++;
+        }
+        if (pos + 1 < line.size() && line[pos + 1] == '=')
+          current_key->values.emplace_back(line.substr(1, pos - 1), line.substr(pos + 2));
+      }
+      else if (line.starts_with("@="))
+      {
+        current_key->values.emplace_back("@", line.substr(2));
+      }
+      current_key->lines.emplace_back(line);
+    }
+  }
+}
+
+/**
+ * \brief Find a key by name, a key name without the closing bracket is matched as prefix
+ * \param[in] key_name Full or part of the path of the key, always starting with '['
+ * \return Pointer to the key or nullptr if not found
+ */
+const WineRegistry::Key* WineRegistry::find_key(std::string_view key_name) const
+{
+  if (key_name.ends_with(']'))
+  {
+    auto it = keys_.find(key_name);
+    return (it != keys_.end()) ? &it->second : nullptr;
+  }
+  // Partial key name, return the first key in file order that starts with the given name
+  auto it = std::find_if(key_order_.begin(), key_order_.end(), [&key_name](std::string_view name) { return name.starts_with(key_name); });
+  return (it != key_order_.end()) ? &keys_.at(*it) : nullptr;
+}
+
+/**
+ * \brief Parse an escaped Wine registry key data back into an UTF-8 string
+ * The code is adopted from the parse_strW() method:
+ * https://source.winehq.org/git/wine.git/blob/refs/heads/master:/server/unicode.c#l101
+ *
+ * \param[in] src Escaped key data (slice of the hive)
+ * \return UTF-8 string
+ */
+std::string WineRegistry::unescape(std::string_view src)
+{
+  auto to_hex = [](char ch) -> char { return std::isdigit(ch) ? ch - '0' : std::tolower(ch) - 'a' + 10; };
+
+  auto wchar_to_utf8 = [](wchar_t wc) -> std::string
+  {
+    std::string s;
+    if (0 <= wc && wc <= 0x7f)
+    {
+      s += (char)wc;
+    }
+    else if (0x80 <= wc && wc <= 0x7ff)
+    {
+      s += (0xc0 | (wc >> 6));
+      s += (0x80 | (wc & 0x3f));
+    }
+    else if (0x800 <= wc && wc <= 0xffff)
+    {
+      s += (0xe0 | (wc >> 12));
+      s += (0x80 | ((wc >> 6) & 0x3f));
+      s += (0x80 | (wc & 0x3f));
+    }
+    else if (0x10000 <= wc && wc <= 0x1fffff)
+    {
+      s += (0xf0 | (wc >> 18));
+      s += (0x80 | ((wc >> 12) & 0x3f));
+      s += (0x80 | ((wc >> 6) & 0x3f));
+      s += (0x80 | (wc & 0x3f));
+    }
+    else if (0x200000 <= wc && wc <= 0x3ffffff)
+    {
+      s += (0xf8 | (wc >> 24));
+      s += (0x80 | ((wc >> 18) & 0x3f));
+      s += (0x80 | ((wc >> 12) & 0x3f));
+      s += (0x80 | ((wc >> 6) & 0x3f));
+      s += (0x80 | (wc & 0x3f));
+    }
+    else if (0x4000000 <= wc && wc <= 0x7fffffff)
+    {
+      s += (0xfc | (wc >> 30));
+      s += (0x80 | ((wc >> 24) & 0x3f));
+      s += (0x80 | ((wc >> 18) & 0x3f));
+      s += (0x80 | ((wc >> 12) & 0x3f));
+      s += (0x80 | ((wc >> 6) & 0x3f));
+      s += (0x80 | (wc & 0x3f));
+    }
+    return s;
+  };
+
+  std::string dest;
+  dest.reserve(src.length());
+
+  const char* p = src.data();
+  const char* end = p + src.size();
+  while (p < end)
+  {
+    if (*p == '\\')
+    {
+      p++;
+      if (p == end)
+        break;
+
+      switch (*p)
+      {
+      case 'a':
+        dest += '\a';
+        p++;
+        continue;
+      case 'b':
+        dest += '\b';
+        p++;
+        continue;
+      case 'e':
+        dest += '\e';
+        p++;
+        continue;
+      case 'f':
+        dest += '\f';
+        p++;
+        continue;
+      case 'n':
+        dest += '\n';
+        p++;
+        continue;
+      case 'r':
+        dest += '\r';
+        p++;
+        continue;
+      case 't':
+        dest += '\t';
+        p++;
+        continue;
+      case 'v':
+        dest += '\v';
+        p++;
+        continue;
+
+      // hex escape
+      case 'x':
+        p++;
+        if (p == end || !std::isxdigit(*p))
+          dest += 'x';
+        else
+        {
+          wchar_t wch = to_hex(*p++);
+          if (p < end && std::isxdigit(*p))
+            wch = (wch * 16) + to_hex(*p++);
+          if (p < end && std::isxdigit(*p))
+            wch = (wch * 16) + to_hex(*p++);
+          if (p < end && std::isxdigit(*p))
+            wch = (wch * 16) + to_hex(*p++);
+          dest += wchar_to_utf8(wch);
+        }
+        continue;
+
+      // octal escape
+      case '0':
+      case '1':
+      case '2':
+      case '3':
+      case '4':
+      case '5':
+      case '6':
+      case '7':
+      {
+        wchar_t wch = *p++ - '0';
+        if (p < end && *p >= '0' && *p <= '7')
+          wch = (wch * 8) + (*p++ - '0');
+        if (p < end && *p >= '0' && *p <= '7')
+          wch = (wch * 8) + (*p++ - '0');
+        dest += wchar_to_utf8(wch);
+        continue;
+      }
+      }
+      // unrecognized escape: fall through to normal char handling
+    }
+
+    dest += *p++;
+  }
+  return dest;
+}
@@ -0,0 +1,360 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_registry_writer.cc
+ * \brief   Batched changes to the Wine registry hives of a bottle (.reg)
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wine_registry_writer.h"
+#include "helper.h"
+#include "process_runner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const std::string UserRegFile = "user.reg";                     /*!< HKEY_CURRENT_USER hive file in the bottle */
+static const std::string SystemRegFile = "system.reg";                 /*!< HKEY_LOCAL_MACHINE hive file in the bottle */
+static const std::uint64_t UnixEpochInFileTime = 116444736000000000ULL; /*!< 1970-01-01 in Windows FILETIME (100ns intervals since 1601) */
+
+/**
+ * \brief Constructor
+ * \param[in] prefix_path Bottle prefix
+ */
+WineRegistryWriter::WineRegistryWriter(const std::string& prefix_path) : prefix_path_(prefix_path)
+{
+}
+
+/**
+ * \brief Get the bottle prefix the changes are made for
+ * \return Bottle prefix
+ */
+const std::string& WineRegistryWriter::get_prefix_path() const
+{
+  return prefix_path_;
+}
+
+/**
+ * \brief Set a string value (REG_SZ), the key is created when missing
+ * \param[in] hive Registry hive
+ * \param[in] key_path Key path relative to the hive root (eg. Software\\Wine\\Explorer)
+ * \param[in] value_name Value name (eg. Desktop)
+ * \param[in] data String data (UTF-8)
+ */
+void WineRegistryWriter::set_string(Hive hive, const std::string& key_path, const std::string& value_name, const std::string& data)
+{
+  changes_.push_back({hive, key_path, value_name, Type::string_value, data});
+}
+
+/**
+ * \brief Remove a value, nothing happens if the value doesn't exist
+ * \param[in] hive Registry hive
+ * \param[in] key_path Key path relative to the hive root (eg. Software\\Wine\\Explorer)
+ * \param[in] value_name Value name
+ */
+void WineRegistryWriter::remove_value(Hive hive, const std::string& key_path, const std::string& value_name)
+{
+  changes_.push_back({hive, key_path, value_name, Type::removed, ""});
+}
+
+/**
+ * \brief Apply all the changes, either directly in the hive files or via a single regedit import (when wineserver is running)
+ * \param[in] wine_executable Wine executable, only used when wineserver is running (name in PATH or full path)
+ * \throws runtime_error when the changes could not be applied
+ */
+void WineRegistryWriter::commit(const std::string& wine_executable)
+{
+  if (changes_.empty())
+    return;
+
+  if (Helper::is_wineserver_running(prefix_path_))
+  {
+    import_with_regedit(wine_executable);
+  }
+  else
+  {
+    for (Hive hive : {Hive::user, Hive::system})
+    {
+      if (std::any_of(changes_.begin(), changes_.end(), [hive](const Change& change) { return change.hive == hive; }))
+        write_hive(hive);
+    }
+  }
+  changes_.clear();
+}
+
+/**
+ * \brief Apply the changes of a single hive to its file on disk. The new hive is written to a temporary file first,
+ * which is renamed over the original hive afterwards (like wineserver does), so the hive is never left half written.
+ * \param[in] hive Registry hive
+ * \throws runtime_error when the hive file could not be read or written
+ */
+void WineRegistryWriter::write_hive(Hive hive) const
+{
+  std::string file_path = prefix_path_ + "/" + ((hive == Hive::user) ? UserRegFile : SystemRegFile);
+  std::ifstream input(file_path, std::ios::binary);
+  struct stat file_stat;
+  if (!input || stat(file_path.c_str(), &file_stat) != 0)
+  {
+    std::cerr << "Error: Couldn't open registry file: " << file_path << std::endl;
+    throw std::runtime_error("Could not open registry file!");
+  }
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(input, line))
+    lines.push_back(std::move(line));
+  input.close();
+
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  std::uint64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(now).count();
+  std::uint64_t file_time = UnixEpochInFileTime + std::chrono::duration_cast<std::chrono::microseconds>(now).count() * 10;
+
+  for (const Change& change : changes_)
+  {
+    if (change.hive != hive)
+      continue;
+    // Find the key section, eg: [Software\\Wine\\Explorer] 1700000000
+    std::string key_line = "[" + escape(change.key_path, "[]") + "]";
+    auto is_key_line = [&key_line](const std::string& text)
+    { return starts_with_ignore_case(text, key_line) && (text.size() == key_line.size() || text[key_line.size()] == ' '); };
+    std::size_t key_index = std::find_if(lines.begin(), lines.end(), is_key_line) - lines.begin();
+    if (key_index == lines.size())
+    {
+      if (change.type == Type::removed)
+        continue;
+      // New key at the end of the hive
+      lines.emplace_back("");
+      lines.push_back(key_line + " " + std::to_string(seconds));
+      std::ostringstream time_line;
+      time_line << "#time=" << std::hex << file_time;
+      lines.push_back(time_line.str());
+      key_index = lines.size() - 2;
+    }
+    // The key section ends with an empty line (or the end of the file)
+    std::size_t end_index = key_index + 1;
+    while (end_index < lines.size() && !lines[end_index].empty())
+      end_index++;
+
+    // Replace or remove the existing value, including its continuation lines (long hex data ends with a backslash)
+    std::string value_prefix = "\"" + escape(change.value_name, "\"") + "\"=";
+    std::size_t insert_index = end_index;
+    for (std::size_t i = key_index + 1; i < end_index; i++)
+    {
+      if (starts_with_ignore_case(lines[i], value_prefix))
+      {
+        std::size_t last = i;
+        while (last + 1 < end_index && lines[last].ends_with('\\'))
+          last++;
+        lines.erase(lines.begin() + i, lines.begin() + last + 1);
+        insert_index = i;
+        break;
+      }
+    }
+    if (change.type != Type::removed)
+      lines.insert(lines.begin() + insert_index, value_prefix + get_hive_data(change));
+  }
+
+  std::string temp_file_path = file_path + ".winegui-tmp";
+  {
+    std::ofstream output(temp_file_path, std::ios::binary | std::ios::trunc);
+    for (const std::string& hive_line : lines)
+      output << hive_line << '\n';
+    output.close();
+    if (!output)
+    {
+      std::remove(temp_file_path.c_str());
+      std::cerr << "Error: Couldn't write registry file: " << temp_file_path << std::endl;
+      throw std::runtime_error("Could not write registry file!");
+    }
+  }
+  chmod(temp_file_path.c_str(), file_stat.st_mode & 07777);
+  if (rename(temp_file_path.c_str(), file_path.c_str()) != 0)
+  {
+    std::cerr << "Error: Couldn't replace registry file: " << file_path << ", error: " << std::strerror(errno) << std::endl;
+    std::remove(temp_file_path.c_str());
+    throw std::runtime_error("Could not write registry file!");
+  }
+}
+
+/**
+ * \brief Import all the changes at once using regedit, used when the wineserver of the bottle is running.
+ * The .reg file is placed in the Windows temp folder of the bottle, so it can be opened using a Windows path.
+ * \param[in] wine_executable Wine executable (name in PATH or full path)
+ * \throws runtime_error when the import failed
+ */
+void WineRegistryWriter::import_with_regedit(const std::string& wine_executable) const
+{
+  auto escape_regedit = [](std::string_view text)
+  {
+    std::string output;
+    for (char ch : text)
+    {
+      if (ch == '\\' || ch == '"')
+        output += '\\';
+      output += ch;
+    }
+    return output;
+  };
+
+  std::string content = "Windows Registry Editor Version 5.00\r\n";
+  const Change* previous = nullptr;
+  for (const Change& change : changes_)
+  {
+    if (previous == nullptr || previous->hive != change.hive || previous->key_path != change.key_path)
+    {
+      content += "\r\n[" + std::string((change.hive == Hive::user) ? "HKEY_CURRENT_USER\\" : "HKEY_LOCAL_MACHINE\\") + change.key_path + "]\r\n";
+    }
+    content += "\"" + escape_regedit(change.value_name) + "\"=";
+    if (change.type == Type::string_value)
+      content += "\"" + escape_regedit(change.data) + "\"";
+    else
+      content += "-";
+    content += "\r\n";
+    previous = &change;
+  }
+
+  // Version 5.00 files are UTF-16 (little endian), so non-ASCII data survives the import
+  std::u16string content_utf16 = u"\uFEFF" + to_utf16(content);
+  std::string file_name = "winegui-registry-" + std::to_string(getpid()) + ".reg";
+  std::string file_path = prefix_path_ + "/drive_c/windows/temp/" + file_name;
+  {
+    std::ofstream output(file_path, std::ios::binary | std::ios::trunc);
+    for (char16_t unit : content_utf16)
+    {
+      output.put(static_cast<char>(unit & 0xff));
+      output.put(static_cast<char>(unit >> 8));
+    }
+    output.close();
+    if (!output)
+    {
+      std::remove(file_path.c_str());
+      std::cerr << "Error: Couldn't write registry import file: " << file_path << std::endl;
+      throw std::runtime_error("Could not write registry import file!");
+    }
+  }
+  const auto& [exit_code, output] =
+      ProcessRunner::run({wine_executable, "regedit", "/S", "C:\\windows\\temp\\" + file_name}, {{"WINEPREFIX", prefix_path_}});
+  std::remove(file_path.c_str());
+  if (exit_code != 0)
+  {
+    std::cerr << "Error: Couldn't import registry changes. Wine prefix path: " << prefix_path_ << ", output: " << output << std::endl;
+    throw std::runtime_error("Could not import the registry changes");
+  }
+}
+
+/**
+ * \brief Get the value data in the format of the hive file
+ * \param[in] change Value change
+ * \return Value data (eg. "win10")
+ */
+std::string WineRegistryWriter::get_hive_data(const Change& change)
+{
+  return "\"" + escape(change.data, "\"") + "\"";
+}
+
+/**
+ * \brief Escape text the way wineserver writes it to the hive file (the counterpart of WineRegistry::unescape()).
+ * Non-ASCII characters are written as UTF-16 code units (eg. \\x00e9).
+ * \param[in] text UTF-8 text
+ * \param[in] quote_chars Characters that need a backslash in front, besides the backslash itself (eg. the quote)
+ * \return Escaped text
+ */
+std::string WineRegistryWriter::escape(std::string_view text, std::string_view quote_chars)
+{
+  std::string output;
+  output.reserve(text.size());
+  for (char16_t unit : to_utf16(text))
+  {
+    if (unit == '\\' || (unit < 0x80 && quote_chars.find(static_cast<char>(unit)) != std::string_view::npos))
+    {
+      output += '\\';
+      output += static_cast<char>(unit);
+    }
+    else if (unit == '\n')
+    {
+      output += "\\n";
+    }
+    else if (unit < ' ' || unit >= 0x7f)
+    {
+      char hex[8];
+      std::snprintf(hex, sizeof(hex), "\\x%04x", static_cast<unsigned int>(unit));
+      output += hex;
+    }
+    else
+    {
+      output += static_cast<char>(unit);
+    }
+  }
+  return output;
+}
+
+/**
+ * \brief Convert UTF-8 text to UTF-16 code units (invalid bytes are skipped)
+ * \param[in] text UTF-8 text
+ * \return UTF-16 text
+ */
+std::u16string WineRegistryWriter::to_utf16(std::string_view text)
+{
+  std::u16string output;
+  output.reserve(text.size());
+  std::size_t i = 0;
+  while (i < text.size())
+  {
+    unsigned char ch = text[i];
+    int length = (ch < 0x80) ? 1 : ((ch >> 5) == 0x6) ? 2 : ((ch >> 4) == 0xe) ? 3 : ((ch >> 3) == 0x1e) ? 4 : 0;
+    if (length == 0 || i + length > text.size())
+    {
+      i++;
+      continue;
+    }
+    char32_t code_point = (length == 1) ? ch : (ch & (0x7f >> length));
+    for (int n = 1; n < length; n++)
+      code_point = (code_point << 6) | (static_cast<unsigned char>(text[i + n]) & 0x3f);
+    i += length;
+    if (code_point >= 0x10000)
+    {
+      code_point -= 0x10000;
+      output += static_cast<char16_t>(0xd800 + (code_point >> 10));
+      output += static_cast<char16_t>(0xdc00 + (code_point & 0x3ff));
+    }
+    else
+    {
+      output += static_cast<char16_t>(code_point);
+    }
+  }
+  return output;
+}
+
+/**
+ * \brief Check if the text starts with the prefix, ignoring the case of ASCII letters (registry names are case insensitive)
+ * \param[in] text Text
+ * \param[in] prefix Prefix
+ * \return True if text starts with the prefix
+ */
+bool WineRegistryWriter::starts_with_ignore_case(std::string_view text, std::string_view prefix)
+{
+  return text.size() >= prefix.size() &&
+         std::equal(prefix.begin(), prefix.end(), text.begin(), [](char a, char b) { return std::tolower(a) == std::tolower(b); });
+}
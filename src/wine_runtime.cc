@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    wine_runtime.cc
+ * \brief   Cached detection of the installed Wine runtime
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "wine_runtime.h"
+#include "helper.h"
+#include <algorithm>
+#include <future>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace
+{
+  /**
+   * \struct ProbeResult
+   * \brief Wine version together with the state of the binary it was probed from
+   */
+  struct ProbeResult
+  {
+    dev_t device;
+    ino_t inode;
+    struct timespec mtime;
+    off_t size;
+    std::string version;
+  };
+
+  const std::string SystemRunnerName = "System";                                 /*!< Runner name of the Wine found in PATH */
+  const std::vector<std::string> RunnerBinDirs{"bin", "files/bin", "dist/bin"}; /*!< Wine builds (bin) and Proton builds (files/bin or dist/bin) */
+  std::mutex probe_mutex;
+  std::map<std::string, ProbeResult> probe_results; /*!< Binary path -> last successful probe */
+  std::mutex runners_mutex;
+  std::vector<WineRunner> runners; /*!< Discovered runners */
+}
+
+/**
+ * \brief Get the Wine version of the Wine found in PATH (the system runner),
+ * the wine binary is only executed again when it changed since the last call (eg. after a Wine upgrade)
+ * \param[in] wine_64_bit If true use Wine 64-bit binary, false use 32-bit binary
+ * \throws runtime_error when the version could not be determined (see Helper::get_wine_version())
+ * \return Wine version (eg. 9.0)
+ */
+std::string WineRuntime::get_wine_version(bool wine_64_bit)
+{
+  // Searching in PATH only takes a few stat() calls, no process is spawned
+  std::string wine_executable = Helper::get_wine_executable_location(wine_64_bit);
+  std::string binary_path = Glib::find_program_in_path(wine_executable);
+  if (binary_path.empty())
+  {
+    // Not found, let the probe give the usual error
+    return Helper::get_wine_version(wine_executable);
+  }
+  return probe_version(binary_path);
+}
+
+/**
+ * \brief Discover the installed Wine runners and probe their versions in parallel (run this method async).
+ * The result is kept, so retrieving the runner executable afterwards doesn't have any discovery cost.
+ * \param[in] custom_directories Additional directories, each is either a runner itself or a directory containing runners
+ */
+void WineRuntime::discover_runners(const std::vector<std::string>& custom_directories)
+{
+  std::vector<WineRunner> discovered_runners;
+  WineRunner system_runner{SystemRunnerName, Glib::find_program_in_path(Helper::get_wine_executable_location(false)),
+                           Glib::find_program_in_path(Helper::get_wine_executable_location(true)), ""};
+  if (!system_runner.wine_path.empty() || !system_runner.wine64_path.empty())
+    discovered_runners.push_back(system_runner);
+  add_runners(get_runners_directory(), discovered_runners);
+  for (const std::string& directory : custom_directories)
+  {
+    if (!add_runner(directory, discovered_runners))
+      add_runners(directory, discovered_runners);
+  }
+
+  // Only changed binaries are executed, all at the same time
+  std::vector<std::future<std::string>> probes;
+  for (const WineRunner& runner : discovered_runners)
+  {
+    const std::string& binary_path = runner.wine_path.empty() ? runner.wine64_path : runner.wine_path;
+    probes.push_back(std::async(std::launch::async,
+                                [binary_path]
+                                {
+                                  try
+                                  {
+                                    return probe_version(binary_path);
+                                  }
+                                  catch (const std::runtime_error&)
+                                  {
+                                    return std::string();
+                                  }
+                                }));
+  }
+  for (std::size_t i = 0; i < discovered_runners.size(); i++)
+  {
+    discovered_runners[i].version = probes[i].get();
+  }
+
+  std::lock_guard<std::mutex> lock(runners_mutex);
+  runners = std::move(discovered_runners);
+}
+
+/**
+ * \brief Get the runners found during the last discovery
+ * \return List of runners, the system runner (if Wine is found in PATH) is first
+ */
+std::vector<WineRunner> WineRuntime::get_runners()
+{
+  std::lock_guard<std::mutex> lock(runners_mutex);
+  return runners;
+}
+
+/**
+ * \brief Get the wine executable of a runner (no discovery is done, see discover_runners())
+ * \param[in] runner_name Runner name, empty for the system runner (the Wine found in PATH)
+ * \param[in] wine_64_bit Prefer the Wine 64-bit binary
+ * \return Full path to the wine binary of the runner, or the system wine executable when the runner is not found
+ */
+std::string WineRuntime::get_wine_executable(const std::string& runner_name, bool wine_64_bit)
+{
+  if (!runner_name.empty() && runner_name != SystemRunnerName)
+  {
+    std::lock_guard<std::mutex> lock(runners_mutex);
+    auto it = std::find_if(runners.begin(), runners.end(), [&runner_name](const WineRunner& runner) { return runner.name == runner_name; });
+    if (it != runners.end())
+    {
+      // Recent Wine versions (WoW64 mode) only ship a wine binary
+      if ((wine_64_bit && !it->wine64_path.empty()) || it->wine_path.empty())
+        return it->wine64_path;
+      return it->wine_path;
+    }
+    std::cerr << "Error: Wine runner " << runner_name << " is not found, fall-back to the Wine found in PATH." << std::endl;
+  }
+  return Helper::get_wine_executable_location(wine_64_bit);
+}
+
+/**
+ * \brief Get the wineserver executable of a runner (no discovery is done, see discover_runners()).
+ * Used by programs starting Wine themselves (like winetricks), so they don't mix the runner with the Wine found in PATH.
+ * \param[in] runner_name Runner name, empty for the system runner (the Wine found in PATH)
+ * \return Full path to the wineserver binary next to the wine binary of the runner, or the system wineserver when the runner is not found
+ */
+std::string WineRuntime::get_wineserver_executable(const std::string& runner_name)
+{
+  if (!runner_name.empty() && runner_name != SystemRunnerName)
+  {
+    std::lock_guard<std::mutex> lock(runners_mutex);
+    auto it = std::find_if(runners.begin(), runners.end(), [&runner_name](const WineRunner& runner) { return runner.name == runner_name; });
+    if (it != runners.end())
+      return Glib::build_filename(Glib::path_get_dirname(it->wine_path.empty() ? it->wine64_path : it->wine_path), "wineserver");
+  }
+  return "wineserver";
+}
+
+/**
+ * \brief Get the Wine version of a runner (no discovery is done, see discover_runners())
+ * \param[in] runner_name Runner name
+ * \return Wine version, empty if the runner is not found or the version is unknown
+ */
+std::string WineRuntime::get_runner_version(const std::string& runner_name)
+{
+  std::lock_guard<std::mutex> lock(runners_mutex);
+  auto it = std::find_if(runners.begin(), runners.end(), [&runner_name](const WineRunner& runner) { return runner.name == runner_name; });
+  return (it != runners.end()) ? it->version : "";
+}
+
+/**
+ * \brief Get the directory of the runners installed for WineGUI
+ * \return Directory path (~/.local/share/winegui/runners)
+ */
+std::string WineRuntime::get_runners_directory()
+{
+  return Glib::build_filename(Glib::get_user_data_dir(), "winegui", "runners");
+}
+
+/**
+ * \brief Get the Wine version of a wine binary, the binary is only executed when it changed since the last probe
+ * \param[in] binary_path Full path to the wine binary
+ * \throws runtime_error when the version could not be determined (see Helper::get_wine_version())
+ * \return Wine version (eg. 9.0)
+ */
+std::string WineRuntime::probe_version(const std::string& binary_path)
+{
+  struct stat binary_stat;
+  if (stat(binary_path.c_str(), &binary_stat) != 0)
+    return Helper::get_wine_version(binary_path);
+  {
+    std::lock_guard<std::mutex> lock(probe_mutex);
+    auto it = probe_results.find(binary_path);
+    if (it != probe_results.end())
+    {
+      const ProbeResult& result = it->second;
+      if (result.device == binary_stat.st_dev && result.inode == binary_stat.st_ino && result.mtime.tv_sec == binary_stat.st_mtim.tv_sec &&
+          result.mtime.tv_nsec == binary_stat.st_mtim.tv_nsec && result.size == binary_stat.st_size)
+        return result.version;
+    }
+  }
+  // Only successful probes are stored, probe without holding the lock (other binaries are probed in parallel)
+  std::string version = Helper::get_wine_version(binary_path);
+  std::lock_guard<std::mutex> lock(probe_mutex);
+  probe_results[binary_path] = {binary_stat.st_dev, binary_stat.st_ino, binary_stat.st_mtim, binary_stat.st_size, version};
+  return version;
+}
+
+/**
+ * \brief Add the directory as runner, when it contains a wine (or wine64) binary
+ * \param[in] runner_directory Runner directory
+ * \param[in,out] runners Runners, a runner is not added when there is already a runner with the same name
+ * \return true if the directory is a runner, otherwise false
+ */
+bool WineRuntime::add_runner(const std::string& runner_directory, std::vector<WineRunner>& runners)
+{
+  for (const std::string& bin_dir : RunnerBinDirs)
+  {
+    std::string wine_path = Glib::build_filename(runner_directory, bin_dir, "wine");
+    std::string wine64_path = Glib::build_filename(runner_directory, bin_dir, "wine64");
+    bool has_wine = Glib::file_test(wine_path, Glib::FileTest::FILE_TEST_IS_EXECUTABLE);
+    bool has_wine64 = Glib::file_test(wine64_path, Glib::FileTest::FILE_TEST_IS_EXECUTABLE);
+    if (has_wine || has_wine64)
+    {
+      std::string name = Glib::path_get_basename(runner_directory);
+      if (std::none_of(runners.begin(), runners.end(), [&name](const WineRunner& runner) { return runner.name == name; }))
+        runners.push_back({name, has_wine ? wine_path : "", has_wine64 ? wine64_path : "", ""});
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * \brief Add all the runners found in the sub-directories of the directory (sorted by name)
+ * \param[in] directory Directory containing runners
+ * \param[in,out] runners Runners
+ */
+void WineRuntime::add_runners(const std::string& directory, std::vector<WineRunner>& runners)
+{
+  if (!Glib::file_test(directory, Glib::FileTest::FILE_TEST_IS_DIR))
+    return;
+  std::vector<std::string> runner_directories;
+  try
+  {
+    Glib::Dir dir(directory);
+    for (const std::string& entry : dir)
+    {
+      std::string runner_directory = Glib::build_filename(directory, entry);
+      if (Glib::file_test(runner_directory, Glib::FileTest::FILE_TEST_IS_DIR))
+        runner_directories.push_back(runner_directory);
+    }
+  }
+  catch (const Glib::FileError& error)
+  {
+    std::cerr << "Error: Could not read the runners directory " << directory << ": " << error.what() << std::endl;
+  }
+  std::sort(runner_directories.begin(), runner_directories.end());
+  for (const std::string& runner_directory : runner_directories)
+  {
+    add_runner(runner_directory, runners);
+  }
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) 2025 WineGUI
+ *
+ * \file    winetricks_log.cc
+ * \brief   Parsed view of the winetricks.log file of a bottle
+ * \author  Melroy van den Berg <melroy@melroy.org>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "winetricks_log.h"
+#include "bottle_types.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace
+{
+  /**
+   * \struct CacheEntry
+   * \brief Parsed winetricks log together with the file state it was parsed from
+   */
+  struct CacheEntry
+  {
+    std::string file_path;
+    struct timespec mtime;
+    off_t size;
+    std::shared_ptr<const WinetricksLog> log;
+  };
+
+  constexpr std::size_t MaxCacheEntries = 16; /*!< Maximum number of parsed logs kept in memory */
+  const std::string LogFileName = "winetricks.log";
+  std::mutex cache_mutex;
+  std::list<CacheEntry> cache; /*!< Most recently used entry is in front */
+}
+
+/**
+ * \brief Read and parse the winetricks log file
+ * \param[in] file_path File path of the winetricks.log file
+ * \throws runtime_error when the log file could not be opened
+ */
+WinetricksLog::WinetricksLog(const std::string& file_path)
+{
+  std::ifstream input(file_path);
+  if (!input)
+  {
+    std::cerr << "Error: Couldn't open Winetricks log file: " << file_path << std::endl;
+    throw std::runtime_error("Could not open Winetricks log file!");
+  }
+  std::string line;
+  while (std::getline(input, line))
+  {
+    // Trim whitespace (incl. carriage return)
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    line.erase(0, line.find_first_not_of(" \t"));
+    if (line.empty() || is_setting_verb(line))
+      continue;
+    if (verb_index_.insert(line).second)
+      verbs_.push_back(line);
+  }
+}
+
+/**
+ * \brief Get the parsed winetricks log of a bottle, the log is only read again when the file changed on disk.
+ * The returned log is immutable and can be shared between threads.
+ * \param[in] prefix_path Bottle prefix
+ * \throws runtime_error when the log file exists, but could not be read
+ * \return Shared pointer to the parsed log, or nullptr when Winetricks was never used in the bottle
+ */
+std::shared_ptr<const WinetricksLog> WinetricksLog::open(const std::string& prefix_path)
+{
+  std::string file_path = prefix_path + "/" + LogFileName;
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0)
+    return nullptr;
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto it = std::find_if(cache.begin(), cache.end(), [&file_path](const CacheEntry& entry) { return entry.file_path == file_path; });
+  if (it != cache.end())
+  {
+    if (it->mtime.tv_sec == file_stat.st_mtim.tv_sec && it->mtime.tv_nsec == file_stat.st_mtim.tv_nsec && it->size == file_stat.st_size)
+    {
+      cache.splice(cache.begin(), cache, it);
+      return it->log;
+    }
+    cache.erase(it);
+  }
+  // The log is small, no need to parse outside the lock
+  auto log = std::make_shared<const WinetricksLog>(file_path);
+  cache.push_front(CacheEntry{file_path, file_stat.st_mtim, file_stat.st_size, log});
+  if (cache.size() > MaxCacheEntries)
+    cache.pop_back();
+  return log;
+}
+
+/**
+ * \brief Check if the verb is installed
+ * \param[in] verb Winetricks verb (eg. corefonts)
+ * \return True if installed
+ */
+bool WinetricksLog::has_verb(std::string_view verb) const
+{
+  return verb_index_.find(verb) != verb_index_.end();
+}
+
+/**
+ * \brief Check if the verb is installed, with or without a version number (eg. dxvk, dxvk2030 or dxvk1103, but not dxvk_nvapi)
+ * \param[in] verb Winetricks verb without version number
+ * \return True if installed
+ */
+bool WinetricksLog::has_verb_with_version(std::string_view verb) const
+{
+  for (auto it = verb_index_.lower_bound(verb); it != verb_index_.end() && it->starts_with(verb); ++it)
+  {
+    std::string_view version = std::string_view(*it).substr(verb.size());
+    if (std::all_of(version.begin(), version.end(), [](unsigned char c) { return std::isdigit(c); }))
+      return true;
+  }
+  return false;
+}
+
+/**
+ * \brief Get all the installed verbs
+ * \return Verbs in install order
+ */
+const std::vector<std::string>& WinetricksLog::get_verbs() const
+{
+  return verbs_;
+}
+
+/**
+ * \brief Check if the verb only changes a setting, instead of installing a package
+ * \param[in] verb Winetricks verb
+ * \return True if it's a setting (eg. vd=1024x768, sound=alsa or win10)
+ */
+bool WinetricksLog::is_setting_verb(std::string_view verb)
+{
+  if (verb.find('=') != std::string_view::npos)
+    return true;
+  return std::any_of(BottleTypes::SupportedWindowsVersions.begin(), BottleTypes::SupportedWindowsVersions.end(),
+                     [verb](const BottleTypes::WindowsAndBit& windows) { return BottleTypes::get_winetricks_string(windows.first) == verb; });
+}